@@ -0,0 +1,70 @@
+#include <json.h>
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+// Serializes a generated document with the pretty JsonStreamWriter and the compact
+// writers, reporting output size and throughput of each.
+namespace {
+    using namespace JSONCpp;
+    using Clock = std::chrono::steady_clock;
+
+    template<class Function>
+    void Measure(const char* Name, size_t Rounds, Function&& Serialize)
+    {
+        size_t Size = 0;
+        auto Start = Clock::now();
+        for (size_t Round = 0; Round < Rounds; ++Round)
+            Size = Serialize();
+        const double Seconds = std::chrono::duration<double>(Clock::now() - Start).count() / Rounds;
+
+        std::printf("%-24s %12zu bytes %9.1f MB/s\n", Name, Size, Size / Seconds / 1e6);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const size_t Count = argc > 1 ? std::stoul(argv[1]) : 200000;
+    const size_t Rounds = argc > 2 ? std::stoul(argv[2]) : 5;
+
+    std::string Text = "[";
+    for (size_t Index = 0; Index < Count; ++Index)
+    {
+        if (Index > 0)
+            Text += ',';
+        Text += R"({"id":)" + std::to_string(Index);
+        Text += R"(,"name":"user )" + std::to_string(Index % 9973);
+        Text += R"(","active":)" + std::string(Index % 3 ? "true" : "false");
+        Text += R"(,"scores":[)" + std::to_string(Index % 101) + "," + std::to_string(Index % 37) + R"(,0.5],"address":{"city":"Springfield","zip":")";
+        Text += std::to_string(10000 + Index % 89999) + R"("}})";
+    }
+    Text += "]";
+
+    JsonDocument Document;
+    JsonStringReader::Create(Text)->Deserialize(Document);
+    const auto& Root = Document.GetRoot();
+
+    Measure("JsonStreamWriter pretty", Rounds, [&Root]() {
+        std::ostringstream Stream;
+        JsonStreamWriter::Create(&Stream)->Serialize(Root);
+        return Stream.str().size();
+    });
+    Measure("JsonStreamWriter compact", Rounds, [&Root]() {
+        std::ostringstream Stream;
+        JsonStreamWriter::Create<JsonCompactFormat>(&Stream)->Serialize(Root);
+        return Stream.str().size();
+    });
+    Measure("JsonStringWriter pretty", Rounds, [&Root]() {
+        std::string Output;
+        JsonStringWriter::Create(&Output)->Serialize(Root);
+        return Output.size();
+    });
+    Measure("JsonStringWriter compact", Rounds, [&Root]() {
+        std::string Output;
+        JsonStringWriter::Create<JsonCompactFormat>(&Output)->Serialize(Root);
+        return Output.size();
+    });
+
+    return EXIT_SUCCESS;
+}
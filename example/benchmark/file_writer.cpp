@@ -0,0 +1,78 @@
+#include <json.h>
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <string>
+
+#if defined(_WIN32)
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
+
+// Streams a generated multi-GB document through JsonEmitter into /dev/null and into a
+// file on tmpfs, writing from the serializing thread and from a background thread.
+namespace {
+    using namespace JSONCpp;
+    using Clock = std::chrono::steady_clock;
+
+    void EmitRecord(JsonEmitter& Emitter, size_t Index)
+    {
+        Emitter.BeginObject()
+            .Key("id").Value(Index)
+            .Key("name").Value("user " + std::to_string(Index % 9973))
+            .Key("active").Value(Index % 3 != 0)
+            .Key("scores").BeginArray().Value(Index % 101).Value(Index % 37).Value(0.5).EndArray()
+            .Key("address").BeginObject().Key("city").Value("Springfield").Key("zip").Value(std::to_string(10000 + Index % 89999)).EndObject()
+            .EndObject();
+    }
+
+    void Measure(const char* Name, const char* Path, size_t Count, bool Background)
+    {
+        const int Descriptor = ::open(Path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (Descriptor < 0)
+        {
+            std::printf("%-36s cannot open %s\n", Name, Path);
+            return;
+        }
+
+        auto Start = Clock::now();
+        {
+            auto Emitter = JsonEmitter::Create(Descriptor, 2, 4 * 1024 * 1024, Background);
+            Emitter->BeginArray();
+            for (size_t Index = 0; Index < Count; ++Index)
+                EmitRecord(*Emitter, Index);
+            Emitter->EndArray();
+        }
+        const double Seconds = std::chrono::duration<double>(Clock::now() - Start).count();
+        ::close(Descriptor);
+
+        std::printf("%-36s %8.2f s\n", Name, Seconds);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const double Gigabytes = argc > 1 ? std::stod(argv[1]) : 2.0;
+    const char* TmpfsPath = argc > 2 ? argv[2] : "/dev/shm/file_writer.json";
+
+    // Size of one record as the emitter writes it inside the array
+    std::string Sample;
+    {
+        auto Emitter = JsonEmitter::Create(&Sample);
+        Emitter->BeginArray();
+        EmitRecord(*Emitter, 0);
+        EmitRecord(*Emitter, 1);
+        Emitter->EndArray();
+    }
+    const size_t Count = static_cast<size_t>(Gigabytes * 1e9) / (Sample.size() / 2);
+    std::printf("%zu records, about %.2f GB\n", Count, Count * (Sample.size() / 2) / 1e9);
+
+    Measure("/dev/null synchronous", "/dev/null", Count, false);
+    Measure("/dev/null background", "/dev/null", Count, true);
+    Measure("tmpfs synchronous", TmpfsPath, Count, false);
+    Measure("tmpfs background", TmpfsPath, Count, true);
+    std::remove(TmpfsPath);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,95 @@
+#include <json.h>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+// Serializes a generated tree after changing one number per round, with and without the
+// fragment cache, reporting the time per serialization and whether the outputs match.
+namespace {
+    using namespace JSONCpp;
+    using Clock = std::chrono::steady_clock;
+
+    std::shared_ptr<JsonObject> Generate(size_t Count)
+    {
+        // Groups of 100 records under one array, as a paged listing would hold them
+        auto Groups = std::make_shared<JsonArray>();
+        for (size_t Index = 0; Index < Count; ++Index)
+        {
+            if (Index % 100 == 0)
+            {
+                auto Group = std::make_shared<JsonObject>();
+                Group->Insert("page", std::make_shared<JsonNumber>(Index / 100));
+                Group->Insert("records", std::make_shared<JsonArray>());
+                Groups->PushBack(Group);
+            }
+
+            auto Scores = std::make_shared<JsonArray>();
+            Scores->PushBack(std::make_shared<JsonNumber>(Index % 101));
+            Scores->PushBack(std::make_shared<JsonNumber>(0.5));
+            auto Address = std::make_shared<JsonObject>();
+            Address->Insert("city", std::make_shared<JsonString>("Springfield"));
+            Address->Insert("zip", std::make_shared<JsonString>(std::to_string(10000 + Index % 89999)));
+
+            auto Record = std::make_shared<JsonObject>();
+            Record->Insert("id", std::make_shared<JsonNumber>(Index));
+            Record->Insert("name", std::make_shared<JsonString>("user " + std::to_string(Index % 9973)));
+            Record->Insert("active", std::make_shared<JsonBoolean>(Index % 3 != 0));
+            Record->Insert("scores", Scores);
+            Record->Insert("address", Address);
+            Groups->Back()->AsObject().find("records")->second->AsArray().push_back(Record);
+        }
+
+        auto Root = std::make_shared<JsonObject>();
+        Root->Insert("version", std::make_shared<JsonNumber>(3));
+        Root->Insert("groups", Groups);
+        return Root;
+    }
+
+    // One record's id, found through const accessors that leave the cache alone
+    std::shared_ptr<JsonNumber> Pick(const JsonObject& Root, size_t Index)
+    {
+        const auto Groups = Root.GetValueAs<JsonArray>("groups");
+        const auto Records = Groups->GetValueAs<JsonObject>(static_cast<uint32_t>(Index / 100 % Groups->Size()))->GetValueAs<JsonArray>("records");
+        return Records->GetValueAs<JsonObject>(static_cast<uint32_t>(Index % Records->Size()))->GetValueAs<JsonNumber>("id");
+    }
+
+    template<class Format>
+    void Measure(const char* Name, size_t Count, size_t Rounds, bool Cache)
+    {
+        const auto Root = Generate(Count);
+        std::string Output;
+        auto Writer = JsonStringWriter::Create<Format>(&Output);
+        Writer->SetFragmentCache(Cache);
+
+        auto Start = Clock::now();
+        Writer->Serialize(Root.get());
+        const double First = std::chrono::duration<double>(Clock::now() - Start).count();
+
+        Start = Clock::now();
+        for (size_t Round = 0; Round < Rounds; ++Round)
+        {
+            Pick(*Root, Round * 7919)->SetNumber(Round);
+            Writer->Serialize(Root.get());
+        }
+        const double Seconds = std::chrono::duration<double>(Clock::now() - Start).count() / Rounds;
+
+        std::string Reference;
+        JsonStringWriter::Create<Format>(&Reference)->Serialize(Root.get());
+        std::printf("%-8s %-9s %12zu bytes  first %8.2f ms  changed %8.2f ms %s\n", Name, Cache ? "cached" : "uncached",
+            Output.size(), First * 1e3, Seconds * 1e3, Output == Reference ? "identical" : "MISMATCH");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const size_t Count = argc > 1 ? std::stoul(argv[1]) : 200000;
+    const size_t Rounds = argc > 2 ? std::stoul(argv[2]) : 20;
+
+    Measure<JsonPrettyFormat>("pretty", Count, Rounds, false);
+    Measure<JsonPrettyFormat>("pretty", Count, Rounds, true);
+    Measure<JsonCompactFormat>("compact", Count, Rounds, false);
+    Measure<JsonCompactFormat>("compact", Count, Rounds, true);
+
+    return EXIT_SUCCESS;
+}
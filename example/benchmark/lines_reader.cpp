@@ -0,0 +1,48 @@
+#include <json.h>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+// Parses a generated NDJSON buffer with an increasing number of workers, in order
+// and unordered, to show how JsonLinesReader scales with cores.
+int main(int argc, char** argv)
+{
+    using namespace JSONCpp;
+    using Clock = std::chrono::steady_clock;
+
+    const size_t Count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    const uint32_t MaxThreads = argc > 2 ? static_cast<uint32_t>(std::stoul(argv[2])) : std::max(1U, std::thread::hardware_concurrency());
+
+    std::string Text;
+    for (size_t Index = 0; Index < Count; ++Index)
+    {
+        Text += R"({"id":)" + std::to_string(Index);
+        Text += R"(,"level":"info","message":"request served in )" + std::to_string(Index % 977);
+        Text += R"( ms","tags":["http","api"],"latency":)" + std::to_string((Index % 977) * 0.125) + "}\n";
+    }
+
+    for (auto Delivery : { JsonLinesOrder::Ordered, JsonLinesOrder::Unordered })
+    {
+        for (uint32_t Threads = 1; Threads <= MaxThreads; Threads *= 2)
+        {
+            JsonLinesOptions Options;
+            Options.Threads = Threads;
+            Options.Delivery = Delivery;
+
+            double Latency = 0.0;
+            auto Reader = JsonLinesReader::Create(Text.data(), Text.size(), Options);
+            auto Start = Clock::now();
+            auto Records = Reader->Read([&Latency](const JsonNode& Record) {
+                Latency += Record.At("latency").GetNumber<double>();
+            });
+            const double Seconds = std::chrono::duration<double>(Clock::now() - Start).count();
+
+            std::printf("%-9s %3u threads %10zu records %9.1f MB/s %8.2f M records/s\n",
+                Delivery == JsonLinesOrder::Ordered ? "ordered" : "unordered", Threads, Records,
+                Text.size() / Seconds / 1e6, Records / Seconds / 1e6);
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,89 @@
+#include <json.h>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Compares number formatting throughput of the previous std::to_string path
+// against NumberConverter::Format, standalone and through JsonStreamWriter.
+int main(int argc, char** argv)
+{
+    using namespace JSONCpp;
+    using Clock = std::chrono::steady_clock;
+
+    const size_t Count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+
+    std::mt19937_64 Random(42);
+    std::uniform_real_distribution<double> Real(-1e6, 1e6);
+    std::vector<double> Doubles(Count);
+    std::vector<int64_t> Integers(Count);
+    for (size_t Index = 0; Index < Count; ++Index)
+    {
+        Doubles[Index] = Real(Random);
+        Integers[Index] = static_cast<int64_t>(Random()) >> (Random() % 64);
+    }
+
+    auto Report = [Count](const char* Name, Clock::time_point Start, size_t Bytes) {
+        const double Seconds = std::chrono::duration<double>(Clock::now() - Start).count();
+        std::printf("%-36s %8.1f ns/number %9.1f MB/s\n", Name, Seconds * 1e9 / Count, Bytes / Seconds / 1e6);
+    };
+
+    size_t Bytes = 0;
+    auto Start = Clock::now();
+    for (double Value : Doubles)
+        Bytes += std::to_string(Value).size();
+    Report("double  std::to_string", Start, Bytes);
+
+    Bytes = 0;
+    Start = Clock::now();
+    for (double Value : Doubles)
+    {
+        char Buffer[NumberConverter::BufferSize];
+        Bytes += NumberConverter::Format(Value, Buffer) - Buffer;
+    }
+    Report("double  NumberConverter::Format", Start, Bytes);
+
+    Bytes = 0;
+    Start = Clock::now();
+    for (int64_t Value : Integers)
+        Bytes += std::to_string(Value).size();
+    Report("int64   std::to_string", Start, Bytes);
+
+    Bytes = 0;
+    Start = Clock::now();
+    for (int64_t Value : Integers)
+    {
+        char Buffer[NumberConverter::BufferSize];
+        Bytes += NumberConverter::Format(Value, Buffer) - Buffer;
+    }
+    Report("int64   NumberConverter::Format", Start, Bytes);
+
+    // Writer - previous path formatted through AsString() and operator<<
+    JsonArray Array;
+    Array.Reserve(static_cast<uint32_t>(Count));
+    for (double Value : Doubles)
+        Array.PushBack(std::make_shared<JsonNumber>(Value));
+
+    std::ostringstream Legacy;
+    Start = Clock::now();
+    Legacy << '[';
+    for (size_t Index = 0; Index < Count; ++Index)
+    {
+        Legacy << std::to_string(Doubles[Index]).c_str();
+        if (Index + 1 != Count)
+            Legacy << ',' << ' ';
+    }
+    Legacy << ']';
+    Report("writer  to_string + operator<<", Start, Legacy.str().size());
+
+    std::ostringstream Output;
+    auto Writer = JsonWriterFactory::Create(&Output);
+    Start = Clock::now();
+    Serializer()(Array, *Writer);
+    Report("writer  JsonStreamWriter", Start, Output.str().size());
+
+    return EXIT_SUCCESS;
+}
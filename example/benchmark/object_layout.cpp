@@ -0,0 +1,89 @@
+#include <json.h>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+// Builds objects of growing size in every layout, then times lookups by name, lookups
+// through pre-hashed JsonKey handles and a full walk over the members, next to a std::map
+// holding the same members.
+namespace {
+    using namespace JSONCpp;
+    using Clock = std::chrono::steady_clock;
+    using Members = std::map<std::string, std::shared_ptr<JsonValue>>;
+
+    template<class Container, class Key>
+    double Lookup(const Container& Object, const std::vector<Key>& Keys, size_t Rounds, size_t& Hits)
+    {
+        auto Start = Clock::now();
+        for (size_t Round = 0; Round < Rounds; ++Round)
+        {
+            for (const auto& Name : Keys)
+                Hits += Object.find(Name) != Object.end() ? 1 : 0;
+        }
+        return std::chrono::duration<double, std::nano>(Clock::now() - Start).count() / (Rounds * Keys.size());
+    }
+
+    // std::map has no use for the hash, the name is copied into a key like callers had to
+    double Lookup(const Members& Object, const std::vector<JsonKey>& Keys, size_t Rounds, size_t& Hits)
+    {
+        auto Start = Clock::now();
+        for (size_t Round = 0; Round < Rounds; ++Round)
+        {
+            for (const auto& Name : Keys)
+                Hits += Object.find(std::string(Name.Data(), Name.Size())) != Object.end() ? 1 : 0;
+        }
+        return std::chrono::duration<double, std::nano>(Clock::now() - Start).count() / (Rounds * Keys.size());
+    }
+
+    template<class Container>
+    void Measure(const char* Name, const Container& Object, const std::vector<std::string>& Names, const std::vector<JsonKey>& Keys, size_t Rounds)
+    {
+        size_t Hits = 0;
+        const double ByName = Lookup(Object, Names, Rounds, Hits);
+        const double ByKey = Lookup(Object, Keys, Rounds, Hits);
+
+        size_t Length = 0;
+        auto Start = Clock::now();
+        for (size_t Round = 0; Round < Rounds; ++Round)
+        {
+            for (const auto& Member : Object)
+                Length += Member.first.size();
+        }
+        const double Walk = std::chrono::duration<double, std::nano>(Clock::now() - Start).count() / (Rounds * Names.size());
+
+        std::printf("%-8s %6zu members %8.2f ns/lookup %8.2f ns/key lookup %8.2f ns/member (%zu %zu)\n", Name, Names.size(), ByName, ByKey, Walk, Hits, Length);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const size_t Work = argc > 1 ? std::stoul(argv[1]) : 4000000;
+
+    for (size_t Size : { 4, 8, 16, 64, 256, 4096 })
+    {
+        std::vector<std::string> Names;
+        for (size_t Index = 0; Index < Size; ++Index)
+            Names.push_back("member_" + std::to_string(Index * 7919 % 100003));
+        std::vector<JsonKey> Keys(Names.begin(), Names.end());
+
+        auto Value = std::make_shared<JsonNull>();
+        Members Map;
+        for (const auto& Key : Names)
+            Map.emplace(Key, Value);
+        const size_t Rounds = std::max<size_t>(Work / Size, 1);
+        Measure("map", Map, Names, Keys, Rounds);
+
+        for (auto Layout : { JsonObjectLayout::Sorted, JsonObjectLayout::Hashed, JsonObjectLayout::Ordered })
+        {
+            JsonObjectStorage Object(Layout);
+            for (const auto& Key : Names)
+                Object.emplace(Key, Value);
+            Measure(Layout == JsonObjectLayout::Sorted ? "sorted" : Layout == JsonObjectLayout::Hashed ? "hashed" : "ordered", Object, Names, Keys, Rounds);
+        }
+        std::printf("\n");
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,63 @@
+#include <json.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+// Serializes a generated document on an increasing number of threads, reporting
+// throughput and whether the output matches the serial writer byte for byte.
+namespace {
+    using namespace JSONCpp;
+    using Clock = std::chrono::steady_clock;
+
+    template<class Format>
+    void Measure(const char* Name, const JsonNode& Root, size_t Rounds, uint32_t MaxThreads)
+    {
+        std::string Serial;
+        JsonStringWriter::Create<Format>(&Serial)->Serialize(Root);
+
+        for (uint32_t Threads = 1; Threads <= MaxThreads; Threads *= 2)
+        {
+            std::string Output;
+            auto Writer = JsonStringWriter::Create<Format>(&Output);
+            Writer->SetThreads(Threads);
+
+            auto Start = Clock::now();
+            for (size_t Round = 0; Round < Rounds; ++Round)
+                Writer->Serialize(Root);
+            const double Seconds = std::chrono::duration<double>(Clock::now() - Start).count() / Rounds;
+
+            std::printf("%-8s %3u threads %9.1f MB/s %s\n", Name, Threads, Output.size() / Seconds / 1e6, Output == Serial ? "identical" : "MISMATCH");
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const size_t Count = argc > 1 ? std::stoul(argv[1]) : 500000;
+    const size_t Rounds = argc > 2 ? std::stoul(argv[2]) : 3;
+    const uint32_t MaxThreads = argc > 3 ? std::stoul(argv[3]) : std::max(1U, std::thread::hardware_concurrency());
+
+    // A small header object around one large array, the array is what gets split
+    std::string Text = R"({"version":3,"records":[)";
+    for (size_t Index = 0; Index < Count; ++Index)
+    {
+        if (Index > 0)
+            Text += ',';
+        Text += R"({"id":)" + std::to_string(Index);
+        Text += R"(,"name":"user )" + std::to_string(Index % 9973);
+        Text += R"(","active":)" + std::string(Index % 3 ? "true" : "false");
+        Text += R"(,"scores":[)" + std::to_string(Index % 101) + "," + std::to_string(Index % 37) + R"(,0.5],"address":{"city":"Springfield","zip":")";
+        Text += std::to_string(10000 + Index % 89999) + R"("}})";
+    }
+    Text += "]}";
+
+    JsonDocument Document;
+    JsonStringReader::Create(Text)->Deserialize(Document);
+
+    Measure<JsonPrettyFormat>("pretty", Document.GetRoot(), Rounds, MaxThreads);
+    Measure<JsonCompactFormat>("compact", Document.GetRoot(), Rounds, MaxThreads);
+
+    return EXIT_SUCCESS;
+}
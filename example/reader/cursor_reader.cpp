@@ -0,0 +1,41 @@
+#include <json.h>
+#include <iostream>
+#include <string>
+
+int main(int argc, char** argv)
+{
+    using namespace JSONCpp;
+
+    try
+    {
+        const std::string Request = R"(
+            {
+                "route": "/students/lookup",
+                "trace": { "id": "4bf92f3577b34da6", "sampled": true },
+                "user": {
+                    "id": 1,
+                    "first_name": "Jamie",
+                    "roles": ["reader", "editor"]
+                }
+            }
+        )";
+
+        // Read three fields, everything else is skipped without being parsed into values
+        JsonCursor Cursor(Request);
+        auto Route = Cursor.FindField("route").GetString();
+        auto Id = Cursor.FindField("user").FindField("id").GetInt64();
+
+        std::cout << Route << " for user " << Id << ", roles:";
+        Cursor.FindField("roles").EnterArray();
+        while (Cursor.NextElement())
+            std::cout << ' ' << Cursor.GetString();
+        std::cout << '\n';
+    }
+    catch(const std::exception& error)
+    {
+        std::cerr << error.what() << '\n';
+        return EXIT_FAILURE;
+    }
+    
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,40 @@
+#include <json.h>
+#include <iostream>
+#include <string>
+
+// Numbers no binary type holds exactly are written back as they were read
+int main(int argc, char** argv)
+{
+    using namespace JSONCpp;
+
+    try
+    {
+        const std::string Numbers = "[123456789012345678901234567890,-9223372036854775809,3.14159265358979323846,1e400,"
+            "0.30000000000000004,18446744073709551615,-9223372036854775808,0.1,2.5e-8]";
+
+        std::shared_ptr<JsonValue> Tree;
+        JsonStringReader::Create(Numbers)->Deserialize(Tree);
+        std::string Written;
+        JsonStringWriter::Create<JsonCompactFormat>(&Written)->Serialize(Tree.get());
+
+        JsonDocument Document;
+        JsonStringReader::Create(Numbers)->Deserialize(Document);
+        std::string WrittenDocument;
+        JsonStringWriter::Create<JsonCompactFormat>(&WrittenDocument)->Serialize(Document.GetRoot());
+
+        const auto Big = Tree->AsArray().front();
+        std::cout << Written << '\n' << Big->AsString() << " ~ " << Big->AsNumber() << '\n';
+        if (Written != Numbers || WrittenDocument != Numbers)
+        {
+            std::cerr << "Numbers changed on the way through.\n";
+            return EXIT_FAILURE;
+        }
+    }
+    catch(const std::exception& error)
+    {
+        std::cerr << error.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,55 @@
+#include <json.h>
+#include <iostream>
+#include <string>
+
+// Sums every "amount" member without building a tree
+struct AmountSummer : JSONCpp::JsonHandler
+{
+    void Key(JSONCpp::JsonStringRef Name)               {   IsAmount = (Name == "amount");                          }
+    void Number(const JSONCpp::JsonNumeric& Value)
+    {
+        if (IsAmount)
+        {
+            Total += Value.Get<double>();
+            ++Count;
+        }
+        IsAmount = false;
+    }
+    void String(JSONCpp::JsonStringRef)                 {   IsAmount = false;                                       }
+    void StartObject()                                  {   IsAmount = false;                                       }
+    void StartArray()                                   {   IsAmount = false;                                       }
+
+    bool    IsAmount    = false;
+    double  Total       = 0.0;
+    int     Count       = 0;
+};
+
+int main(int argc, char** argv)
+{
+    using namespace JSONCpp;
+
+    try
+    {
+        const std::string Orders = R"(
+            {
+                "orders": [
+                    { "id": 1, "customer": "Jamie", "amount": 12.5 },
+                    { "id": 2, "customer": "Laura", "amount": 7, "note": "\"gift\"" },
+                    { "id": 3, "customer": "Alex", "amount": 30.25 }
+                ]
+            }
+        )";
+
+        AmountSummer Summer;
+        auto Reader = JsonReaderFactory::Create(Orders.data(), Orders.size());
+        Reader->Parse(Summer);
+        std::cout << Summer.Count << " orders, total " << Summer.Total << '\n';
+    }
+    catch(const std::exception& error)
+    {
+        std::cerr << error.what() << '\n';
+        return EXIT_FAILURE;
+    }
+    
+    return EXIT_SUCCESS;
+}
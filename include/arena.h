@@ -0,0 +1,71 @@
+#pragma once
+#include "config.h"
+#include <cstddef>
+#include <cstdint>
+
+JSONCPP_NAMESPACE_BEGIN
+
+// Class JsonArena
+//
+// Monotonic allocator. Memory is carved out of chunks that grow geometrically and is
+// never returned piecemeal - Release frees every chunk at once. Objects placed in the
+// arena must be trivially destructible, no destructor is ever run.
+class JSON_API JsonArena
+{
+public:
+    static constexpr size_t DefaultChunkSize    = 64 * 1024;
+    static constexpr size_t MaxChunkSize        = 64 * 1024 * 1024;
+
+    explicit            JsonArena(size_t ChunkSize = DefaultChunkSize) noexcept : m_ChunkSize(ChunkSize)   {}
+                        JsonArena(JsonArena&& Other) noexcept;
+                        JsonArena(const JsonArena&) = delete;
+                        ~JsonArena()                                                                        {   Release();  }
+
+    JsonArena&          operator=(JsonArena&& Other) noexcept;
+    JsonArena&          operator=(const JsonArena&) = delete;
+
+    void*               Allocate(size_t Size, size_t Alignment = alignof(std::max_align_t))
+    {
+        auto Address = reinterpret_cast<uintptr_t>(m_Cursor);
+        auto Aligned = (Address + Alignment - 1) & ~static_cast<uintptr_t>(Alignment - 1);
+        if (m_Cursor == nullptr || Aligned + Size > reinterpret_cast<uintptr_t>(m_End))
+            return AllocateChunk(Size, Alignment);
+        m_Cursor = reinterpret_cast<char*>(Aligned + Size);
+        return reinterpret_cast<void*>(Aligned);
+    }
+
+    template<class T>
+    T*                  Allocate(size_t Count)                                                              {   return static_cast<T*>(Allocate(sizeof(T) * Count, alignof(T)));    }
+
+    const char*         CopyString(const char* Src, size_t Length);
+
+    // Free every chunk in one go
+    void                Release() noexcept;
+
+    // Drop all allocations but keep the newest, largest chunk for reuse
+    void                Reset() noexcept;
+
+    // Take over the chunks of Other, its allocations now live as long as this arena
+    void                Adopt(JsonArena& Other) noexcept;
+
+    size_t              Reserved() const noexcept                                                           {   return m_Reserved;  }
+
+private:
+    struct Chunk
+    {
+        Chunk*  Next;
+        size_t  Size;
+    };
+
+    void*               AllocateChunk(size_t Size, size_t Alignment);
+
+private:
+    Chunk*  m_Head      = nullptr;
+    char*   m_Cursor    = nullptr;
+    char*   m_End       = nullptr;
+    size_t  m_ChunkSize = DefaultChunkSize;
+    size_t  m_NextSize  = 0;
+    size_t  m_Reserved  = 0;
+};
+
+JSONCPP_NAMESPACE_END
@@ -0,0 +1,72 @@
+#pragma once
+#include "number.h"
+#include "stringref.h"
+#include "structural.h"
+#include <string>
+#include <vector>
+
+JSONCPP_NAMESPACE_BEGIN
+
+// Class JsonCursor
+//
+// Forward-only, on-demand access to a caller-owned buffer:
+//
+//     JsonCursor Cursor(Body);
+//     auto Id = Cursor.FindField("user").FindField("id").GetInt64();
+//
+// The cursor stands either on a value or behind one. FindField enters an object the
+// cursor stands on, otherwise it keeps searching the remaining members of the current
+// object. Values that are passed over are skipped structurally, strings are unescaped
+// only when read with GetString. Skipped values are only checked for balanced brackets.
+class JSON_API JsonCursor
+{
+public:
+                        JsonCursor(const char* Data, size_t Length);
+    explicit            JsonCursor(const std::string& Content) : JsonCursor(Content.data(), Content.size())    {}
+    explicit            JsonCursor(std::string&& Content) = delete;    // the buffer must outlive the cursor
+
+    // Type of the value the cursor stands on
+    JsonType            GetType() const;
+    bool                IsNull() const                                  {   return GetType() == JsonType::Null;     }
+
+    // Object access
+    JsonCursor&         FindField(JsonStringRef Name);
+    bool                TryFindField(JsonStringRef Name);
+
+    // Array access - EnterArray, then NextElement until it returns false
+    JsonCursor&         EnterArray();
+    bool                NextElement();
+
+    // Read the current value and move behind it
+    bool                GetBoolean();
+    JsonNumeric         GetNumeric();
+    int64_t             GetInt64();
+    uint64_t            GetUInt64();
+    double              GetDouble()                                     {   return GetNumeric().Get<double>();      }
+    std::string         GetString();
+    JsonStringRef       GetRawString();
+
+    // Move behind the current value, or out of the current container
+    JsonCursor&         Skip();
+    JsonCursor&         Leave();
+
+private:
+    char                Peek() const;
+    const char*         CurrentValue() const;
+    void                Advance()                                       {   m_Token = m_Scanner.Next();             }
+    void                EndScalar(const char* Last);
+    void                CloseScope();
+    const char*         FindStringEnd(const char* First, bool& OutEscaped) const;
+    bool                MatchKey(JsonStringRef Name);
+
+private:
+    JsonStructuralScanner   m_Scanner;
+    const char*             m_Last          = nullptr;
+    const char*             m_Token         = nullptr;
+    std::vector<JsonType>   m_Scopes;
+    std::string             m_StringBuffer;
+    bool                    m_ValuePending  = true;     // cursor stands on a value
+    bool                    m_ScopeStart    = false;    // no element read in the current container yet
+};
+
+JSONCPP_NAMESPACE_END
@@ -0,0 +1,174 @@
+#pragma once
+#include "arena.h"
+#include "error.h"
+#include "keytable.h"
+#include "number.h"
+#include "stringref.h"
+#include <memory>
+#include <vector>
+
+JSONCPP_NAMESPACE_BEGIN
+
+class JsonValue;
+struct JSON_API JsonMember;
+
+// Class JsonNode
+//
+// 16 byte tagged value stored in a JsonDocument. Scalars are held inline, strings and
+// Text numbers are a length plus pointer and containers a count plus pointer to their
+// children, all of which live in the arena of the owning document and exactly as long
+// as it does.
+class JSON_API JsonNode
+{
+public:
+    using SizeType = uint32_t;
+
+                        JsonNode() noexcept                                 {   m_Value.UInt64 = 0;                             }
+
+    static JsonNode     MakeNull() noexcept;
+    static JsonNode     MakeBoolean(bool Value) noexcept;
+    static JsonNode     MakeNumber(const JsonNumeric& Value) noexcept;
+    static JsonNode     MakeString(const char* Data, SizeType Length) noexcept;
+    static JsonNode     MakeArray(const JsonNode* Elements, SizeType Size) noexcept;
+    static JsonNode     MakeObject(const JsonMember* Members, SizeType Size) noexcept;
+
+    template<JsonType Type>
+    bool                Is() const noexcept                                 {   return GetType() == Type;                       }
+    JsonType            GetType() const noexcept                            {   return static_cast<JsonType>(m_Type);           }
+
+    bool                GetBoolean() const;
+    JsonNumeric         GetNumeric() const;
+    JsonStringRef       GetString() const;
+
+    template<class T>
+    T                   GetNumber() const                                   {   return GetNumeric().Get<T>();                   }
+
+    // Array and object access
+    SizeType            Size() const noexcept;
+    bool                Empty() const noexcept                              {   return Size() == 0;                             }
+
+    const JsonNode&     At(SizeType Index) const;
+    const JsonNode&     operator[](SizeType Index) const                    {   return At(Index);                               }
+    const JsonNode*     Begin() const noexcept;
+    const JsonNode*     End() const noexcept                                {   return Begin() + (Is<JsonType::Array>() ? Size() : 0);          }
+
+    const JsonNode&     At(JsonStringRef Key) const;
+    const JsonNode*     Find(JsonStringRef Key) const noexcept;
+    bool                Has(JsonStringRef Key) const noexcept               {   return Find(Key) != nullptr;                    }
+    const JsonMember*   MemberBegin() const noexcept;
+    const JsonMember*   MemberEnd() const noexcept;
+
+    // Compatibility with the JsonValue classes
+    std::shared_ptr<JsonValue> ToValue() const;
+
+private:
+    union
+    {
+        bool            Boolean;
+        int64_t         Int64;
+        uint64_t        UInt64;
+        double          Double;
+        const void*     Children;       // string bytes, elements or members
+    }                   m_Value;
+    SizeType            m_Size          = 0;
+    uint8_t             m_Type          = static_cast<uint8_t>(JsonType::Unknown);
+    uint8_t             m_NumberType    = static_cast<uint8_t>(JsonNumberType::Int64);
+};
+
+JSON_STATIC_ASSERT(sizeof(JsonNode) == 16);
+
+// Struct JsonMember - object member of a JsonDocument
+struct JSON_API JsonMember
+{
+    JsonStringRef   Key;
+    JsonNode        Value;
+};
+
+// Class JsonDocument
+//
+// Owns a whole parsed tree. Every node, string and child list is carved out of one
+// JsonArena, so building the tree costs no per-node heap allocation and destroying
+// it is a single release of the arena chunks.
+class JSON_API JsonDocument
+{
+public:
+    explicit            JsonDocument(size_t ChunkSize = JsonArena::DefaultChunkSize) : m_Arena(ChunkSize)  {}
+                        JsonDocument(JsonDocument&& Other) noexcept = default;
+                        JsonDocument(const JsonDocument&) = delete;
+
+    JsonDocument&       operator=(JsonDocument&& Other) noexcept = default;
+    JsonDocument&       operator=(const JsonDocument&) = delete;
+
+    const JsonNode&     GetRoot() const noexcept                            {   return m_Root;                                  }
+    bool                Empty() const noexcept                              {   return m_Root.Is<JsonType::Unknown>();          }
+
+    JsonArena&          GetArena() noexcept                                 {   return m_Arena;                                 }
+    const JsonArena&    GetArena() const noexcept                           {   return m_Arena;                                 }
+
+    void                SetRoot(const JsonNode& Root) noexcept              {   m_Root = Root;                                  }
+    void                Clear() noexcept                                    {   m_Arena.Release(); m_Keys.Clear(); m_Root = JsonNode();     }
+    void                Reset() noexcept                                    {   m_Arena.Reset(); m_Keys.Clear(); m_Root = JsonNode();       }
+
+    // Member names - with interning every distinct name is stored once per document,
+    // names found in the shared table are not stored at all
+    void                SetKeyInterning(bool Enable) noexcept               {   m_InternKeys = Enable;                          }
+    bool                IsKeyInterning() const noexcept                     {   return m_InternKeys;                            }
+    void                SetSharedKeys(std::shared_ptr<const JsonKeyTable> Keys) noexcept   {   m_SharedKeys = std::move(Keys);  }
+    const std::shared_ptr<const JsonKeyTable>& GetSharedKeys() const noexcept              {   return m_SharedKeys;             }
+
+    // Storage for a member name of this document
+    JsonStringRef       StoreKey(JsonStringRef Key);
+
+    // Copy a JsonValue tree into the arena, replacing the current content
+    void                Assign(const JsonValue& Root);
+
+private:
+    JsonArena                           m_Arena;
+    JsonNode                            m_Root;
+    JsonKeyTable                        m_Keys          = JsonKeyTable(0);     // names live in m_Arena
+    std::shared_ptr<const JsonKeyTable> m_SharedKeys;
+    bool                                m_InternKeys    = false;
+};
+
+// Class JsonDocumentBuilder
+//
+// Reader handler filling a JsonDocument. Children of open containers are collected on
+// scratch stacks and copied into the arena in one block when the container closes, which
+// is also where a member name given twice is rejected, as the other builders do.
+class JSON_API JsonDocumentBuilder
+{
+public:
+    explicit    JsonDocumentBuilder(JsonDocument& Document) : m_Document(Document)  {}
+
+    void        Null()                                              {   AppendNode(JsonNode::MakeNull());                       }
+    void        Bool(bool Value)                                    {   AppendNode(JsonNode::MakeBoolean(Value));               }
+    void        Number(const JsonNumeric& Value);
+    void        String(JsonStringRef Value);
+    void        Key(JsonStringRef Value);
+    void        StartObject()                                       {   m_Scopes.push_back(Scope{ JsonType::Object, m_Members.size() });    }
+    void        EndObject();
+    void        StartArray()                                        {   m_Scopes.push_back(Scope{ JsonType::Array, m_Elements.size() });    }
+    void        EndArray();
+
+    // Drop any partially built containers
+    void        Reset() noexcept                                    {   m_Scopes.clear(); m_Elements.clear(); m_Members.clear();    }
+
+private:
+    struct Scope
+    {
+        JsonType    Type;
+        size_t      First;
+    };
+
+    void        AppendNode(const JsonNode& Node);
+    void        CheckNames(size_t First);
+
+private:
+    JsonDocument&               m_Document;
+    std::vector<Scope>          m_Scopes;
+    std::vector<JsonNode>       m_Elements;
+    std::vector<JsonMember>     m_Members;
+    std::vector<JsonStringRef>  m_Names;        // scratch of CheckNames
+};
+
+JSONCPP_NAMESPACE_END
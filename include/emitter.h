@@ -0,0 +1,113 @@
+#pragma once
+#include "writer.h"
+#include <array>
+#include <type_traits>
+
+JSONCPP_NAMESPACE_BEGIN
+
+// Class JsonEmitter
+//
+// Streaming writer, the document is produced by a sequence of calls instead of a tree:
+//
+//     Emitter->BeginObject().Key("id").Value(42).Key("tags").BeginArray().Value("a").EndArray().EndObject();
+//
+// Output goes through a fixed size buffer into the destination, memory does not grow with
+// the document. Nesting is checked against a state stack of MaxDepth levels, misplaced calls
+// are errors. Layout and escaping are the ones JsonWriter uses, the same tree emitted or
+// serialized gives the same bytes. Data reaches the destination when the buffer fills, on
+// Flush and when the emitter is destroyed.
+class JSON_API JsonEmitter : public JsonFormatter
+{
+protected:
+    JsonEmitter(std::unique_ptr<JsonOutputSink> Sink, uint32_t Indent, bool Compact, size_t BufferSize);
+
+public:
+    using OStream       = std::basic_ostream<char>;
+    using UniquePointer = std::unique_ptr<JsonEmitter>;
+
+    static constexpr uint32_t MaxDepth = 128;
+
+                    JsonEmitter(const JsonEmitter&) = delete;
+    JsonEmitter&    operator=(const JsonEmitter&) = delete;
+    virtual         ~JsonEmitter();
+
+    // Appends to OutString
+    template<class Format = JsonPrettyFormat>
+    JSON_NODISCARD static UniquePointer Create(std::string* OutString, uint32_t Indent = 2, size_t BufferSize = JsonOutputBuffer::DefaultCapacity)
+    {
+        JSON_ASSERT(OutString != nullptr);
+        return UniquePointer(new JsonEmitter(std::unique_ptr<JsonOutputSink>(new JsonStringSink(*OutString)), Indent, Format::Compact, BufferSize));
+    }
+    template<class Format = JsonPrettyFormat>
+    JSON_NODISCARD static UniquePointer Create(OStream* Stream, uint32_t Indent = 2, size_t BufferSize = JsonOutputBuffer::DefaultCapacity)
+    {
+        JSON_ASSERT(Stream != nullptr);
+        return UniquePointer(new JsonEmitter(std::unique_ptr<JsonOutputSink>(new JsonStreamSink(*Stream)), Indent, Format::Compact, BufferSize));
+    }
+    // The descriptor stays owned by the caller, Background writes it from a separate thread
+    template<class Format = JsonPrettyFormat>
+    JSON_NODISCARD static UniquePointer Create(int Descriptor, uint32_t Indent = 2, size_t BufferSize = 1024 * 1024, bool Background = false)
+    {
+        std::unique_ptr<JsonOutputSink> Sink(Background ? static_cast<JsonOutputSink*>(new JsonAsyncFileSink(Descriptor, BufferSize)) : new JsonFileSink(Descriptor));
+        return UniquePointer(new JsonEmitter(std::move(Sink), Indent, Format::Compact, BufferSize));
+    }
+
+    // Containers
+    JsonEmitter&    BeginObject();
+    JsonEmitter&    EndObject();
+    JsonEmitter&    BeginArray();
+    JsonEmitter&    EndArray();
+
+    // Member name, the next call gives its value
+    JsonEmitter&    Key(JsonStringRef Name);
+
+    // Scalars
+    JsonEmitter&    Null();
+    JsonEmitter&    Value(std::nullptr_t)                                   {   return Null();                                              }
+    JsonEmitter&    Value(bool Boolean);
+    JsonEmitter&    Value(const JsonNumeric& Number);
+    template<class T, class = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+    JsonEmitter&    Value(T Number)
+    {
+        JsonNumeric Numeric;
+        Numeric.Set(Number);
+        return Value(Numeric);
+    }
+    JsonEmitter&    Value(JsonStringRef String);
+    JsonEmitter&    Value(const char* String)                               {   return Value(JsonStringRef(String));                        }
+    JsonEmitter&    Value(const std::string& String)                        {   return Value(JsonStringRef(String));                        }
+
+    // Whole subtrees, written as JsonWriter would at this depth
+    JsonEmitter&    Value(const JsonValue& Root);
+    JsonEmitter&    Value(const JsonNode& Root);
+
+    // Nesting of the next value, 0 at the root
+    uint32_t        GetDepth() const noexcept                               {   return m_Depth;                                             }
+    // A root value has been written and every container closed
+    bool            IsComplete() const noexcept                             {   return m_Complete;                                          }
+
+    // Hand the buffered bytes to the destination
+    void            Flush()                                                 {   m_Out.Flush();                                              }
+
+private:
+    enum Frame : uint8_t
+    {
+        Array       = 0x0,
+        Object      = 0x1,
+        HasItems    = 0x2,
+    };
+
+    void            BeginValue();
+    void            Push(Frame Type);
+    void            EndContainer(Frame Type, char Close);
+
+private:
+    std::unique_ptr<JsonOutputSink>     m_Sink;
+    JsonOutputBuffer                    m_Out;
+    std::array<uint8_t, MaxDepth>       m_Stack;
+    uint32_t                            m_Depth     = 0;
+    bool                                m_AfterKey  = false;
+    bool                                m_Complete  = false;
+};
+
+JSONCPP_NAMESPACE_END
@@ -0,0 +1,84 @@
+#pragma once
+#include "config.h"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+JSONCPP_NAMESPACE_BEGIN
+
+class JsonValue;
+
+// Struct JsonFragment
+//
+// Serialized bytes of one container, for the layout settings and nesting level they were
+// written with. Child containers of at least MinSplicedSize bytes are not copied, their
+// own fragment is spliced in at Offset of Bytes, so a cached tree holds most bytes once.
+struct JsonFragment
+{
+    static constexpr size_t MinSplicedSize = 1024;
+
+    struct Splice
+    {
+        size_t                              Offset;
+        std::shared_ptr<const JsonFragment> Fragment;
+    };
+
+    bool    Matches(uint32_t InIndent, uint32_t InLevel, bool InCompact, bool InEnsureAscii) const noexcept
+    {
+        return Indent == InIndent && Level == InLevel && Compact == InCompact && EnsureAscii == InEnsureAscii;
+    }
+
+    std::string         Bytes;                  // the container without the spliced children
+    std::vector<Splice> Splices;                // by ascending Offset
+    size_t              Size        = 0;        // of the whole output, children included
+    uint32_t            Indent      = 0;
+    uint32_t            Level       = 0;
+    bool                Compact     = false;
+    bool                EnsureAscii = false;
+};
+
+// Struct JsonFragmentCache
+//
+// Cache record of a container. Values under the container refer to it and drop its
+// fragment when they change, Parent leads on to the record of the enclosing container.
+struct JsonFragmentCache
+{
+    explicit JsonFragmentCache(const JsonValue* InOwner) noexcept : Owner(InOwner)  {}
+
+    std::shared_ptr<const JsonFragment> Fragment;
+    std::weak_ptr<JsonFragmentCache>    Parent;
+    const JsonValue*                    Owner;
+};
+
+// Class JsonFragmentTable
+//
+// Records of the serialization cache, kept beside the tree so that values written without
+// the cache pay nothing for it. A value names a 31 bit slot beside its type: a
+// container the slot of the record it owns, any other value the slot of its container.
+// Slots of destroyed containers are reused, a value left pointing at one only costs a
+// needless drop.
+class JSON_API JsonFragmentTable
+{
+public:
+    // Holds the table for a whole serialization, the writer side takes it as a witness
+    class JSON_API Scope
+    {
+    public:
+        Scope();
+
+    private:
+        std::lock_guard<std::mutex> m_Lock;
+    };
+
+    // Writer side - the record of a container, created on first use, and the link of a child
+    static std::shared_ptr<JsonFragmentCache>   Own(const Scope& Locked, const JsonValue* Value);
+    static void     Attach(const Scope& Locked, const JsonValue* Child, const std::shared_ptr<JsonFragmentCache>& Parent, bool Container);
+
+    // Value side - drops the cached bytes the value is part of, up to the root or a
+    // container dropped before, and frees the record of a destroyed container
+    static void     Drop(const JsonValue* Value) noexcept;
+    static void     Forget(const JsonValue* Value) noexcept;
+};
+
+JSONCPP_NAMESPACE_END
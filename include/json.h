@@ -1,5 +1,11 @@
 #include "utf.h"
 #include "value.h"
 #include "reader.h"
+#include "document.h"
+#include "cursor.h"
+#include "lines.h"
+#include "parallel.h"
+#include "lazy.h"
 #include "writer.h"
+#include "emitter.h"
 #include "literal.h"
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+#include "arena.h"
+#include "stringref.h"
+#include <vector>
+
+JSONCPP_NAMESPACE_BEGIN
+
+// Class JsonKeyTable
+//
+// Intern table for object member names. Every distinct name is stored once and handed
+// out as the same JsonStringRef, so members sharing a name share their bytes and name
+// comparisons succeed on pointer equality. The table is an open addressing index over
+// names kept in an arena - its own, or the one of the document being built. A table no
+// longer interned into may be shared read-only between documents and threads.
+//
+// Only JsonDocument interns, see JsonDocument::SetKeyInterning. JsonObject is out of scope:
+// its key_type stays std::string for the std::map interface, so every member of a JsonValue
+// tree owns a copy of its name.
+class JSON_API JsonKeyTable
+{
+public:
+    explicit            JsonKeyTable(size_t ChunkSize = 4 * 1024) : m_Storage(ChunkSize)   {}
+                        JsonKeyTable(JsonKeyTable&& Other) noexcept = default;
+                        JsonKeyTable(const JsonKeyTable&) = delete;
+
+    JsonKeyTable&       operator=(JsonKeyTable&& Other) noexcept = default;
+    JsonKeyTable&       operator=(const JsonKeyTable&) = delete;
+
+    // Stored name equal to Key, copied into the table storage on first use
+    JsonStringRef       Intern(JsonStringRef Key)                           {   return Intern(Key, m_Storage);                                  }
+    // Same, names new to the table are copied into Storage, which must outlive the entry
+    JsonStringRef       Intern(JsonStringRef Key, JsonArena& Storage);
+
+    // Stored name equal to Key, a null reference when there is none
+    JsonStringRef       Find(JsonStringRef Key) const noexcept;
+
+    size_t              Size() const noexcept                               {   return m_Count;                                                 }
+    bool                Empty() const noexcept                              {   return m_Count == 0;                                            }
+
+    // Forget every name, storage handed to Intern is left alone
+    void                Clear() noexcept;
+
+private:
+    struct Slot
+    {
+        const char* Data;
+        uint32_t    Length;
+        uint32_t    Hash;
+    };
+
+    size_t              Probe(JsonStringRef Key, uint32_t KeyHash) const noexcept;
+    void                Grow();
+
+private:
+    JsonArena           m_Storage;
+    std::vector<Slot>   m_Slots;            // power of two, at most half full
+    size_t              m_Count     = 0;
+};
+
+JSONCPP_NAMESPACE_END
@@ -0,0 +1,86 @@
+#pragma once
+#include "reader.h"
+
+JSONCPP_NAMESPACE_BEGIN
+
+// Class JsonLazyTape
+//
+// Index of a lazily parsed document. One pass of the structural scanner records an entry
+// per token: its byte offset and, for an opening bracket, the entry of the matching close.
+// Containers are parsed from the tape one level at a time when they are first accessed -
+// their scalars are converted then, nested containers stay lazy. Errors inside a container
+// surface on that first access. The tape is shared by every container built from it and
+// keeps the input alive when it owns it.
+class JSON_API JsonLazyTape : public std::enable_shared_from_this<JsonLazyTape>
+{
+public:
+                        JsonLazyTape(const char* Data, size_t Length);
+    explicit            JsonLazyTape(std::string&& Content);
+
+    // Lazy root container
+    std::shared_ptr<JsonValue>  GetRoot() const;
+
+    void                LoadArray(uint32_t Index, JsonArray::ContainerType& OutArray) const;
+    void                LoadObject(uint32_t Index, JsonObject::ContainerType& OutObject) const;
+
+    JsonStringRef       Text() const noexcept                               {   return JsonStringRef(m_First, static_cast<size_t>(m_Last - m_First));    }
+    size_t              Size() const noexcept                               {   return m_Tape.size();                                           }
+
+private:
+    void                Build();
+
+    const char*         Token(uint32_t Entry) const noexcept                {   return m_First + static_cast<uint32_t>(m_Tape[Entry]);          }
+    uint32_t            Close(uint32_t Entry) const noexcept                {   return static_cast<uint32_t>(m_Tape[Entry] >> 32);              }
+
+    std::shared_ptr<JsonValue>  LoadValue(uint32_t& Entry) const;
+    void                LoadString(uint32_t Entry, std::string& OutString) const;
+    void                EndScalar(const char* Last, uint32_t& Entry) const;
+
+private:
+    std::string             m_Content;          // owned input, empty when the caller keeps the buffer
+    const char*             m_First;
+    const char*             m_Last;
+    std::vector<uint64_t>   m_Tape;             // offset | matching close entry << 32
+};
+
+// Class JsonLazyReader
+//
+// Reader producing a lazy JsonValue tree. Deserialize only builds the tape, containers are
+// parsed when At, operator[], GetValueAs, Find or iteration first touches them. A lazy tree
+// must not be read from several threads until the parts they share are materialized.
+// JsonDocument targets are parsed eagerly, they are cheap to build in full.
+class JSON_API JsonLazyReader : public JsonReader
+{
+protected:
+    JsonLazyReader(const char* Data, size_t Length) noexcept : m_Data(Data), m_Length(Length)                  {}
+    explicit JsonLazyReader(std::string&& Content) noexcept : m_Content(std::move(Content)), m_Owned(true)     {}
+
+public:
+    using UniquePointer = std::unique_ptr<JsonLazyReader>;
+
+    virtual ~JsonLazyReader() = default;
+
+    // The buffer must outlive the tree and every value taken from it
+    JSON_NODISCARD static UniquePointer Create(const char* Data, size_t Length)
+    {
+        return UniquePointer(new JsonLazyReader(Data, Length));
+    }
+    // The tree keeps its own copy of the text
+    JSON_NODISCARD static UniquePointer Create(std::string Content)
+    {
+        return UniquePointer(new JsonLazyReader(std::move(Content)));
+    }
+
+    // Every call returns a new lazy root over the same tape
+    bool Deserialize(std::shared_ptr<JsonValue>& Root) override;
+    bool Deserialize(JsonDocument& Document) override;
+
+private:
+    const char*                             m_Data      = nullptr;
+    size_t                                  m_Length    = 0;
+    std::string                             m_Content;
+    bool                                    m_Owned     = false;
+    std::shared_ptr<const JsonLazyTape>     m_Tape;     // built by the first Deserialize
+};
+
+JSONCPP_NAMESPACE_END
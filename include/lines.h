@@ -0,0 +1,73 @@
+#pragma once
+#include "reader.h"
+#include <functional>
+#include <istream>
+
+JSONCPP_NAMESPACE_BEGIN
+
+enum class JsonLinesOrder : uint32_t
+{
+    Ordered     = 0,    // records in input order
+    Unordered   = 1,    // records batch by batch as soon as they are parsed
+};
+
+struct JsonLinesOptions
+{
+    uint32_t        Threads     = 0;                // 0 - one per hardware thread
+    size_t          BatchSize   = 1024 * 1024;      // bytes per batch, cut at the next newline
+    JsonLinesOrder  Delivery    = JsonLinesOrder::Ordered;
+    bool            InternKeys  = false;            // store each member name once per batch
+};
+
+// Class JsonLinesReader
+//
+// Reader for newline delimited JSON. The input is cut into batches on line boundaries,
+// batches are parsed in parallel by a pool of workers, each keeping its own reader and
+// reusing the arena of its batch documents. Records are handed to the callback on the
+// calling thread, so the callback needs no synchronisation.
+class JSON_API JsonLinesReader
+{
+    struct Batch;
+
+protected:
+    JsonLinesReader(const char* Data, size_t Length, const JsonLinesOptions& Options);
+    JsonLinesReader(std::basic_istream<char>& IStream, const JsonLinesOptions& Options);
+    JsonLinesReader(const std::string& Path, const JsonLinesOptions& Options);
+
+public:
+    using UniquePointer     = std::unique_ptr<JsonLinesReader>;
+    // A record is valid until the callback returns
+    using RecordCallback    = std::function<void(const JsonNode& Record)>;
+
+    virtual ~JsonLinesReader();
+
+    JSON_NODISCARD static UniquePointer Create(const char* Data, size_t Length, const JsonLinesOptions& Options = JsonLinesOptions())
+    {
+        return UniquePointer(new JsonLinesReader(Data, Length, Options));
+    }
+    JSON_NODISCARD static UniquePointer Create(std::basic_istream<char>& IStream, const JsonLinesOptions& Options = JsonLinesOptions())
+    {
+        return UniquePointer(new JsonLinesReader(IStream, Options));
+    }
+    JSON_NODISCARD static UniquePointer CreateFromFile(const std::string& Path, const JsonLinesOptions& Options = JsonLinesOptions())
+    {
+        return UniquePointer(new JsonLinesReader(Path, Options));
+    }
+
+    // Parse every record, returns the number of records delivered
+    size_t Read(const RecordCallback& Callback);
+
+private:
+    bool NextBatch(Batch& Work);
+    void ParseBatch(JsonReader& Reader, Batch& Work) const;
+
+private:
+    JsonLinesOptions                        m_Options;
+    std::unique_ptr<JsonMappedFileReader>   m_File;
+    std::basic_istream<char>*               m_Stream    = nullptr;
+    std::string                             m_Carry;
+    const char*                             m_Cursor    = nullptr;
+    const char*                             m_Last      = nullptr;
+};
+
+JSONCPP_NAMESPACE_END
@@ -0,0 +1,116 @@
+#pragma once
+#include "type.h"
+#include <string>
+#include <type_traits>
+
+JSONCPP_NAMESPACE_BEGIN
+
+// Struct JsonNumeric - tagged binary representation of a JSON number
+//
+// Numbers no binary type holds exactly - integers beyond 64 bits, decimals a double does
+// not read back as written - keep their lexeme as Text. It is a view: the input while a
+// reader reports the number, the JsonNumber or JsonDocument holding it afterwards.
+struct JsonNumeric
+{
+    JsonNumberType  Type    = JsonNumberType::Int64;
+    uint32_t        Length  = 0;                // of Text
+    union
+    {
+        int64_t     Int64   = 0;
+        uint64_t    UInt64;
+        double      Double;
+        const char* Text;
+    };
+
+    template<class T>
+    void Set(T Value) noexcept
+    {
+        JSON_STATIC_ASSERT(std::is_arithmetic<T>::value);
+        if (std::is_floating_point<T>::value)
+        {
+            Type = JsonNumberType::Double;
+            Double = static_cast<double>(Value);
+        }
+        else if (std::is_signed<T>::value)
+        {
+            Type = JsonNumberType::Int64;
+            Int64 = static_cast<int64_t>(Value);
+        }
+        else
+        {
+            Type = JsonNumberType::UInt64;
+            UInt64 = static_cast<uint64_t>(Value);
+        }
+    }
+
+    template<class T>
+    T Get() const noexcept
+    {
+        JSON_STATIC_ASSERT(std::is_arithmetic<T>::value);
+        switch (Type)
+        {
+        case JsonNumberType::Int64:     return static_cast<T>(Int64);
+        case JsonNumberType::UInt64:    return static_cast<T>(UInt64);
+        case JsonNumberType::Text:      return static_cast<T>(TextToDouble());
+        default:                        return static_cast<T>(Double);
+        }
+    }
+
+    bool IsInteger() const noexcept
+    {
+        if (Type != JsonNumberType::Text)
+            return Type != JsonNumberType::Double;
+        for (uint32_t Index = 0; Index < Length; ++Index)
+        {
+            if (Text[Index] == '.' || Text[Index] == 'e' || Text[Index] == 'E')
+                return false;
+        }
+        return true;
+    }
+
+    // Nearest double of Text, converted on every call
+    JSON_API double TextToDouble() const noexcept;
+
+    static bool Equal(const JsonNumeric& Lhs, const JsonNumeric& Rhs) noexcept
+    {
+        // Two lexemes compare as written, against a binary number by their nearest double
+        if (Lhs.Type == JsonNumberType::Text && Rhs.Type == JsonNumberType::Text)
+            return Lhs.Length == Rhs.Length && std::char_traits<char>::compare(Lhs.Text, Rhs.Text, Lhs.Length) == 0;
+        if (Lhs.Type >= JsonNumberType::Double || Rhs.Type >= JsonNumberType::Double)
+            return Lhs.Get<double>() == Rhs.Get<double>();
+        if (Lhs.Type == Rhs.Type)
+            return Lhs.UInt64 == Rhs.UInt64;
+
+        // Int64 against UInt64
+        const int64_t Signed = (Lhs.Type == JsonNumberType::Int64 ? Lhs.Int64 : Rhs.Int64);
+        const uint64_t Unsigned = (Lhs.Type == JsonNumberType::UInt64 ? Lhs.UInt64 : Rhs.UInt64);
+        return Signed >= 0 && static_cast<uint64_t>(Signed) == Unsigned;
+    }
+};
+
+// Struct NumberConverter - conversion between JSON number lexemes and JsonNumeric
+struct JSON_API NumberConverter
+{
+    // Longest text Format can produce
+    static constexpr size_t BufferSize = 32;
+    // Longest text of a double: sign, 17 digits, point and a three digit exponent
+    static constexpr size_t MaxDoubleLength = 24;
+
+    // Returns the end of the number lexeme, nullptr when [First, Last) does not start with a number.
+    // Integers are kept exact in Int64/UInt64, everything else is rounded to the nearest double
+    // unless that loses digits, then OutNumber views the lexeme as Text.
+    static const char*  Parse(const char* First, const char* Last, JsonNumeric& OutNumber);
+
+    // Write the number to Buffer (at least BufferSize bytes) and return the end of the text.
+    // Doubles use the shortest digits that read back to the same value (Grisu3, with an exact
+    // fallback), NaN and infinity have no JSON representation and are written as null. Text
+    // does not fit the buffer, callers write it themselves, Format gives its nearest double.
+    static char*        Format(const JsonNumeric& Number, char* Buffer) noexcept;
+    static char*        Format(int64_t Value, char* Buffer) noexcept;
+    static char*        Format(uint64_t Value, char* Buffer) noexcept;
+    static char*        Format(double Value, char* Buffer) noexcept;
+
+    static std::string  ToString(const JsonNumeric& Number);
+};
+
+JSONCPP_NAMESPACE_END
@@ -0,0 +1,133 @@
+#pragma once
+#include "stringref.h"
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+JSONCPP_NAMESPACE_BEGIN
+
+class JsonValue;
+
+enum class JsonObjectLayout : uint8_t
+{
+    Sorted      = 0,    // ordered by name, binary search - compact, for small objects
+    Hashed      = 1,    // open addressing index - O(1) lookup for large objects, erase may reorder
+    Ordered     = 2,    // document order, linear search until the object outgrows LinearLimit
+};
+
+// Class JsonObjectStorage
+//
+// Member storage of JsonObject. Members live in one flat vector, which is what iteration
+// walks, the layout decides their order and how a name is looked up. The interface follows
+// std::map so code written against the previous container keeps compiling, but inserting
+// or erasing invalidates references and iterators like it does for std::vector. An insert
+// out of name order moves the Sorted members after it, large objects are better built
+// with Append and Seal or in another layout.
+class JSON_API JsonObjectStorage
+{
+public:
+    using key_type                  = std::string;
+    using mapped_type               = std::shared_ptr<JsonValue>;
+    using value_type                = std::pair<key_type, mapped_type>;
+    using ContainerType             = std::vector<value_type>;
+    using size_type                 = typename ContainerType::size_type;
+    using iterator                  = typename ContainerType::iterator;
+    using const_iterator            = typename ContainerType::const_iterator;
+    using reverse_iterator          = typename ContainerType::reverse_iterator;
+    using const_reverse_iterator    = typename ContainerType::const_reverse_iterator;
+
+    static constexpr size_type LinearLimit = 8;
+
+    explicit                JsonObjectStorage(JsonObjectLayout Layout = GetDefaultLayout()) noexcept : m_Layout(Layout)    {}
+
+    // Layout of objects created without one, Sorted unless changed
+    static JsonObjectLayout GetDefaultLayout() noexcept;
+    static void             SetDefaultLayout(JsonObjectLayout Layout) noexcept;
+
+    JsonObjectLayout        GetLayout() const noexcept                          {   return m_Layout;                                            }
+    void                    SetLayout(JsonObjectLayout Layout);
+
+    // Iterator
+    iterator                begin() noexcept                                    {   return m_Members.begin();                                   }
+    iterator                end() noexcept                                      {   return m_Members.end();                                     }
+    const_iterator          begin() const noexcept                              {   return m_Members.begin();                                   }
+    const_iterator          end() const noexcept                                {   return m_Members.end();                                     }
+    const_iterator          cbegin() const noexcept                             {   return m_Members.cbegin();                                  }
+    const_iterator          cend() const noexcept                               {   return m_Members.cend();                                    }
+    reverse_iterator        rbegin() noexcept                                   {   return m_Members.rbegin();                                  }
+    reverse_iterator        rend() noexcept                                     {   return m_Members.rend();                                    }
+    const_reverse_iterator  crbegin() const noexcept                            {   return m_Members.crbegin();                                 }
+    const_reverse_iterator  crend() const noexcept                              {   return m_Members.crend();                                   }
+
+    // Capacity
+    bool                    empty() const noexcept                              {   return m_Members.empty();                                   }
+    size_type               size() const noexcept                               {   return m_Members.size();                                    }
+    void                    reserve(size_type Count)                            {   m_Members.reserve(Count);                                   }
+
+    // Element access, a missing name is an error
+    mapped_type&            at(JsonStringRef Key);
+    const mapped_type&      at(JsonStringRef Key) const;
+    mapped_type&            at(const JsonKey& Key);
+    const mapped_type&      at(const JsonKey& Key) const;
+
+    // Lookup, a plain name is only hashed when the layout keeps an index, a JsonKey carries its hash
+    iterator                find(JsonStringRef Key)                             {   return Search(Key, m_Index.empty() ? 0 : Key.Hash());       }
+    const_iterator          find(JsonStringRef Key) const                       {   return Search(Key, m_Index.empty() ? 0 : Key.Hash());       }
+    iterator                find(const JsonKey& Key)                            {   return Search(Key, Key.Hash());                             }
+    const_iterator          find(const JsonKey& Key) const                      {   return Search(Key, Key.Hash());                             }
+    size_type               count(JsonStringRef Key) const                      {   return find(Key) != end() ? 1 : 0;                          }
+    size_type               count(const JsonKey& Key) const                     {   return find(Key) != end() ? 1 : 0;                          }
+
+    // Modifiers
+    mapped_type&            operator[](const key_type& Key);
+    mapped_type&            operator[](key_type&& Key);
+
+    std::pair<iterator, bool>   insert(const value_type& Value)                 {   return Emplace(key_type(Value.first), mapped_type(Value.second));   }
+    std::pair<iterator, bool>   insert(value_type&& Value)                      {   return Emplace(std::move(Value.first), std::move(Value.second));    }
+
+    template<class K, class V>
+    std::pair<iterator, bool>   emplace(K&& Key, V&& Value)                     {   return Emplace(key_type(std::forward<K>(Key)), mapped_type(std::forward<V>(Value)));    }
+
+    iterator                erase(const_iterator Where);
+    size_type               erase(JsonStringRef Key);
+    void                    clear() noexcept                                    {   m_Members.clear(); m_Index.clear();                         }
+
+    // Bulk building for readers - Append adds members in any order without a lookup, Seal
+    // then brings them into layout order at O(n log n) once. Returns the first name found
+    // twice, nullptr when the names are unique
+    void                    Append(key_type&& Key, mapped_type&& Value)         {   m_Members.emplace_back(std::move(Key), std::move(Value));   }
+    const key_type*         Seal();
+
+    // Same names mapped to the same values, regardless of the layouts
+    bool                    operator==(const JsonObjectStorage& Rhs) const;
+    bool                    operator!=(const JsonObjectStorage& Rhs) const      {   return !(*this == Rhs);                                     }
+
+private:
+    struct Slot
+    {
+        uint32_t    Hash;
+        uint32_t    Position;       // member index + 1, 0 marks a free slot
+    };
+
+    std::pair<iterator, bool>   Emplace(key_type&& Key, mapped_type&& Value);
+
+    iterator                Search(JsonStringRef Key, uint32_t Hash);
+    const_iterator          Search(JsonStringRef Key, uint32_t Hash) const;
+
+    // Hash is only read when the index exists
+    size_type               Locate(JsonStringRef Key, uint32_t Hash, bool& Found) const;
+    size_type               Locate(JsonStringRef Key, bool& Found) const        {   return Locate(Key, m_Index.empty() ? 0 : Key.Hash(), Found);    }
+    bool                    NeedsIndex() const noexcept;
+    void                    Reindex();
+    // Index slot of the member at Position, and its removal keeping every probe sequence intact
+    size_t                  FindSlot(size_type Position) const;
+    void                    EraseSlot(size_t Index) noexcept;
+
+private:
+    ContainerType           m_Members;
+    std::vector<Slot>       m_Index;        // power of two, at most half full
+    JsonObjectLayout        m_Layout;
+};
+
+JSONCPP_NAMESPACE_END
@@ -0,0 +1,189 @@
+#pragma once
+#include "config.h"
+#include "error.h"
+#include "stringref.h"
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+JSONCPP_NAMESPACE_BEGIN
+
+// Class JsonOutputSink
+//
+// Destination of serialized bytes. JsonOutputBuffer hands its contents over in large
+// blocks, a sink only has to move them on. Sinks that manage their own memory may also
+// lend the buffer the blocks it fills, and take them back full without a copy.
+class JSON_API JsonOutputSink
+{
+public:
+    virtual ~JsonOutputSink() = default;
+
+    virtual void    Write(const char* Data, size_t Length) = 0;
+
+    // Block for the buffer to fill and its Capacity, nullptr lets the buffer allocate its own
+    virtual char*   Acquire(size_t& Capacity)                               {   (void)Capacity; return nullptr;                     }
+    // Takes the Length bytes of a lent block and returns the block to fill next. Capacity is
+    // the room wanted on entry (0 - any) and the room of the returned block on return
+    virtual char*   Submit(char* Data, size_t Length, size_t& Capacity)     {   (void)Capacity; Write(Data, Length); return Data;    }
+    // Gives back a lent block that is not going to be submitted
+    virtual void    Release(char* Block) noexcept                           {   (void)Block;                                        }
+    // Waits until everything submitted has reached the destination
+    virtual void    Sync()                                                  {}
+};
+
+// Class JsonStringSink - appends to a std::string
+class JSON_API JsonStringSink : public JsonOutputSink
+{
+public:
+    explicit        JsonStringSink(std::string& OutString) noexcept : m_OutString(OutString)   {}
+
+    void            Write(const char* Data, size_t Length) override                         {   m_OutString.append(Data, Length);  }
+
+private:
+    std::string&    m_OutString;
+};
+
+// Class JsonStreamSink - unformatted writes to a std::ostream
+class JSON_API JsonStreamSink : public JsonOutputSink
+{
+public:
+    explicit        JsonStreamSink(std::ostream& Stream) noexcept : m_Stream(Stream)           {}
+
+    void            Write(const char* Data, size_t Length) override;
+
+private:
+    std::ostream&   m_Stream;
+};
+
+// Class JsonFileSink - writes to a file descriptor, which stays owned by the caller
+class JSON_API JsonFileSink : public JsonOutputSink
+{
+public:
+    explicit        JsonFileSink(int Descriptor) noexcept : m_Descriptor(Descriptor)          {}
+
+    void            Write(const char* Data, size_t Length) override;
+
+private:
+    int             m_Descriptor;
+};
+
+// Class JsonAsyncFileSink
+//
+// File descriptor sink with a background writer thread. The serializer fills one page aligned
+// block while the thread drains the others, blocks queued up by then go out together in one
+// writev. Write errors are reported on the serializing thread by the next call. The descriptor
+// stays owned by the caller, the destructor waits for the queued blocks to be written.
+class JSON_API JsonAsyncFileSink : public JsonOutputSink
+{
+public:
+    static constexpr size_t BlockAlignment = 4096;
+
+    explicit            JsonAsyncFileSink(int Descriptor, size_t BlockSize = 4 * 1024 * 1024, uint32_t BlockCount = 2);
+                        JsonAsyncFileSink(const JsonAsyncFileSink&) = delete;
+    JsonAsyncFileSink&  operator=(const JsonAsyncFileSink&) = delete;
+                        ~JsonAsyncFileSink();
+
+    void                Write(const char* Data, size_t Length) override;
+    char*               Acquire(size_t& Capacity) override;
+    char*               Submit(char* Data, size_t Length, size_t& Capacity) override;
+    void                Release(char* Block) noexcept override;
+    void                Sync() override;
+
+private:
+    struct Block
+    {
+        char*   Data;
+        size_t  Length;
+    };
+
+    char*               TakeFree(std::unique_lock<std::mutex>& Lock, size_t& Capacity);
+    void                Run();
+
+private:
+    int                         m_Descriptor;
+    size_t                      m_BlockSize;
+    std::unique_ptr<char[]>     m_Storage;
+    std::vector<char*>          m_Free;             // blocks ready to be filled
+    std::deque<Block>           m_Pending;          // full blocks in file order
+    std::mutex                  m_Mutex;
+    std::condition_variable     m_Queued;           // wakes the writer thread
+    std::condition_variable     m_Written;          // wakes the serializer
+    bool                        m_Writing   = false;
+    bool                        m_Stop      = false;
+    int                         m_Error     = 0;
+    std::thread                 m_Thread;
+};
+
+// Class JsonOutputBuffer
+//
+// Contiguous byte buffer the writers append to. With a sink the buffer keeps its size and
+// is drained into the sink whenever it fills up, without one it grows and holds the whole
+// output. Nothing reaches the sink before Flush or an overflow.
+class JSON_API JsonOutputBuffer
+{
+public:
+    static constexpr size_t DefaultCapacity = 64 * 1024;
+
+    explicit            JsonOutputBuffer(JsonOutputSink* Sink = nullptr, size_t Capacity = DefaultCapacity);
+                        JsonOutputBuffer(const JsonOutputBuffer&) = delete;
+    JsonOutputBuffer&   operator=(const JsonOutputBuffer&) = delete;
+                        ~JsonOutputBuffer();
+
+    void                Put(char Char)
+    {
+        if (m_Cursor == m_Last)
+            Overflow(1);
+        *m_Cursor++ = Char;
+    }
+
+    void                Put(const char* Data, size_t Length)
+    {
+        if (Length > static_cast<size_t>(m_Last - m_Cursor))
+            return PutLarge(Data, Length);
+        std::memcpy(m_Cursor, Data, Length);
+        m_Cursor += Length;
+    }
+
+    void                Put(JsonStringRef String)                           {   Put(String.Data(), String.Size());                  }
+    void                Fill(char Char, size_t Count);
+
+    // Room for at least Length bytes at the returned position, Commit the end of what was written
+    char*               Reserve(size_t Length)
+    {
+        if (Length > static_cast<size_t>(m_Last - m_Cursor))
+            Overflow(Length);
+        return m_Cursor;
+    }
+    void                Commit(char* End) noexcept                          {   m_Cursor = End;                                     }
+
+    // Bytes not yet handed to the sink
+    const char*         Data() const noexcept                               {   return m_First;                                     }
+    size_t              Size() const noexcept                               {   return static_cast<size_t>(m_Cursor - m_First);     }
+    size_t              Capacity() const noexcept                           {   return static_cast<size_t>(m_Last - m_First);       }
+
+    // Hand everything buffered to the sink and wait until it has been written
+    void                Flush();
+    void                Clear() noexcept                                    {   m_Cursor = m_First;                                 }
+    // Drops the bytes after the first Length of those not yet handed to the sink
+    void                Truncate(size_t Length) noexcept                    {   m_Cursor = m_First + Length;                        }
+
+private:
+    void                Drain(size_t Wanted);
+    void                Overflow(size_t Length);
+    void                PutLarge(const char* Data, size_t Length);
+
+private:
+    std::unique_ptr<char[]> m_Storage;          // empty while the block is lent by the sink
+    char*                   m_First;
+    char*                   m_Cursor;
+    char*                   m_Last;
+    JsonOutputSink*         m_Sink;
+};
+
+JSONCPP_NAMESPACE_END
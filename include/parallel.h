@@ -0,0 +1,54 @@
+#pragma once
+#include "reader.h"
+#include <functional>
+#include <vector>
+
+JSONCPP_NAMESPACE_BEGIN
+
+// Class JsonParallelReader
+//
+// Buffer reader for documents whose root is one large array. A structural pass finds
+// the top-level commas, the elements are cut into slices of similar byte size and the
+// slices are parsed concurrently, each into a sub-array of its own. The sub-arrays are
+// spliced into the root array in input order. Other documents, and inputs too small to
+// be worth the threads, are parsed on the calling thread like JsonBufferReader does.
+class JSON_API JsonParallelReader : public JsonBufferReader
+{
+    struct Slice
+    {
+        const char* First;
+        const char* Last;
+    };
+
+    using SliceFunction = std::function<void(JsonParallelReader& Reader, size_t Index)>;
+
+protected:
+    JsonParallelReader(const char* Data, size_t Length, uint32_t Threads) noexcept : JsonBufferReader(Data, Length), m_Threads(Threads)   {}
+
+public:
+    using UniquePointer = std::unique_ptr<JsonParallelReader>;
+
+    static constexpr size_t MinParallelSize = 1024 * 1024;      // smaller inputs are parsed on the calling thread
+    static constexpr uint32_t SlicesPerThread = 4;              // more slices than threads balance uneven elements
+
+    virtual ~JsonParallelReader() = default;
+
+    // Threads 0 - one per hardware thread
+    JSON_NODISCARD static UniquePointer Create(const char* Data, size_t Length, uint32_t Threads = 0)
+    {
+        return UniquePointer(new JsonParallelReader(Data, Length, Threads));
+    }
+
+    bool Deserialize(std::shared_ptr<JsonValue>& Root) override;
+    bool Deserialize(JsonDocument& Document) override;
+
+private:
+    uint32_t    ThreadCount() const noexcept;
+    bool        SplitElements(std::vector<Slice>& Slices, uint32_t Count) const;
+    void        ParseSlices(const std::vector<Slice>& Slices, uint32_t Threads, const SliceFunction& Function) const;
+
+private:
+    uint32_t    m_Threads;
+};
+
+JSONCPP_NAMESPACE_END
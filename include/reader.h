@@ -1,12 +1,34 @@
 #pragma once
 #include "value.h"
+#include "structural.h"
+#include "stringref.h"
+#include "document.h"
 #include <stack>
 
 JSONCPP_NAMESPACE_BEGIN
 
-class JSON_API JsonReader
+// Struct JsonHandler
+//
+// Event interface of JsonReader::Parse. Handlers are resolved at compile time, derive
+// from JsonHandler and hide only the events of interest. Strings and keys are views
+// into the input, or into a reader buffer when they contain escapes, valid only for
+// the duration of the call.
+struct JsonHandler
+{
+    void        Null()                                              {}
+    void        Bool(bool)                                          {}
+    void        Number(const JsonNumeric&)                          {}
+    void        String(JsonStringRef)                               {}
+    void        Key(JsonStringRef)                                  {}
+    void        StartObject()                                       {}
+    void        EndObject()                                         {}
+    void        StartArray()                                        {}
+    void        EndArray()                                          {}
+};
+
+// Class JsonValueBuilder - turns reader events into a JsonValue tree
+class JSON_API JsonValueBuilder
 {
-protected:
     struct ParseState
     {
         ParseState() = default;
@@ -15,7 +37,10 @@ protected:
             : Type(JType)
         {
             if (JType == JsonType::Object)
+            {
                 Object = std::make_shared<JsonObject>();
+                Members = &Object->AsObject();
+            }
             else
                 Array = std::make_shared<JsonArray>();
         }
@@ -24,33 +49,82 @@ protected:
         std::string                 Identifier;
         std::shared_ptr<JsonArray>  Array;
         std::shared_ptr<JsonObject> Object;
+        JsonObjectStorage*          Members = nullptr;  // of Object, appended to and sealed at its end
     };
 
+public:
+    void        Null()                                              {   AppendJsonValue(std::make_shared<JsonNull>());                          }
+    void        Bool(bool Value)                                    {   AppendJsonValue(std::make_shared<JsonBoolean>(Value));                  }
+    void        Number(const JsonNumeric& Value)                    {   AppendJsonValue(std::make_shared<JsonNumber>(Value));                   }
+    void        String(JsonStringRef Value)                         {   AppendJsonValue(std::make_shared<JsonString>(Value.Begin(), Value.End()));  }
+    void        Key(JsonStringRef Value);
+    void        StartObject()                                       {   m_ParseProcessState.emplace(JsonType::Object);                          }
+    void        EndObject()                                         {   CloseJsonValue();                                                       }
+    void        StartArray()                                        {   m_ParseProcessState.emplace(JsonType::Array);                           }
+    void        EndArray()                                          {   CloseJsonValue();                                                       }
+
+    std::shared_ptr<JsonValue>  GetRoot() const noexcept            {   return m_Root;                                                          }
+
+private:
+    void        AppendJsonValue(std::shared_ptr<JsonValue> Value);
+    void        CloseJsonValue();
+
+private:
+    std::stack<ParseState>      m_ParseProcessState;
+    std::shared_ptr<JsonValue>  m_Root;
+};
+
+// Class JsonReader
+//
+// Validates the token grammar and reports every value to a handler, which decides
+// what is kept (JsonValueBuilder, JsonDocumentBuilder or any JsonHandler).
+class JSON_API JsonReader
+{
+    friend class JsonCursor;
+    friend class JsonLazyTape;
+
+protected:
                 JsonReader() = default;
     virtual     ~JsonReader() = default;
 
-    void        Parse(const char* First, const char* Last, ParseState& OutState);
+public:
+    template<class Handler>
+    void        Parse(const char* First, const char* Last, Handler& Events);
+
+protected:
+    // Parse one piece of a document, the grammar state carries over between calls. Unless
+    // Final is set, returns the start of a trailing scalar left for the next chunk, else Last.
+    template<class Handler>
+    const char* ParseChunk(const char* First, const char* Last, Handler& Events, bool Final);
+
+    // Parse a run of elements of an already open array, e.g. a slice of a top-level array
+    template<class Handler>
+    void        ParseElements(const char* First, const char* Last, Handler& Events);
+
+    void        BeginParse();
+    void        EndParse();
+
+    bool        ParseValue(const char* First, const char* Last, std::shared_ptr<JsonValue>& Root);
+    bool        ParseDocument(const char* First, const char* Last, JsonDocument& Document);
 
 public:
     virtual bool Deserialize(std::shared_ptr<JsonValue>& Root) = 0;
+    virtual bool Deserialize(JsonDocument& Document) = 0;
 
 private:
-    const char* SkipWhiteSpace(const char* First, const char* Last) const;
-
     const char* ParseColon(const char* First, const char* Last);
     const char* ParseComma(const char* First, const char* Last);
     const char* ParseNull(const char* First, const char* Last);
-    const char* ParseBoolean(const char* First, const char* Last);
-    const char* ParseDigits(const char* First, const char* Last) const;
-    const char* ParseNumber(const char* First, const char* Last);
-    const char* ParseUnicode(const char* First, const char* Last, uint32_t& CodePoint) const;
-    const char* ParseString(const char* First, const char* Last);
-    const char* ParseArray(const char* First, const char* Last, ParseState& OutState);
-    const char* ParseObject(const char* First, const char* Last, ParseState& OutState);
+    const char* ParseBoolean(const char* First, const char* Last, bool& OutBool);
+    const char* ParseNumber(const char* First, const char* Last, JsonNumeric& OutNumber);
+    const char* ParseString(const char* First, const char* Last, JsonStringRef& OutString, bool& OutIdentifier);
+
+    static const char*  ParseUnicode(const char* First, const char* Last, uint32_t& CodePoint);
+    static const char*  UnescapeString(const char* First, const char* Last, std::string& OutString);
+    const char* ParseArray(const char* First, const char* Last);
+    const char* ParseObject(const char* First, const char* Last);
 
     bool        IsProcessedType(JsonType Type) const;
-    void        AppendJsonValue(std::shared_ptr<JsonValue> Value);
-    void        AppendJsonIdentifier(std::string&& String);
 
     bool        MatchExpectedToken(JsonTokenType Token) const noexcept;
 
@@ -66,11 +140,118 @@ private:
     void        AppendExpectedToken(Args&& ...Tokens) noexcept      {   m_ExpectedToken |= MergeTokens(Tokens...);                                  }
     
 private:
-    std::stack<ParseState>  m_ParseProcessState;
+    using ProcessStack = std::stack<JsonType, std::vector<JsonType>>;
+
+    JsonStructuralScanner   m_Scanner;
+    ProcessStack            m_ParseProcessState;
+    std::string             m_StringBuffer;         // unescaped string, reused between tokens
     uint32_t                m_ExpectedToken         = 0;
     uint32_t                m_PrevToken             = 0;
 };
 
+// Class JsonBufferReader
+//
+// Parses a caller-owned buffer in place. The buffer is not copied and must outlive
+// every Deserialize call.
+class JSON_API JsonBufferReader : public JsonReader
+{
+protected:
+    JsonBufferReader(const char* Data, size_t Length) noexcept : m_First(Data), m_Last(Data + Length)  {}
+
+public:
+    using UniquePointer = std::unique_ptr<JsonBufferReader>;
+
+    virtual ~JsonBufferReader() = default;
+
+    JSON_NODISCARD static UniquePointer Create(const char* Data, size_t Length)
+    {
+        return UniquePointer(new JsonBufferReader(Data, Length));
+    }
+
+    bool Deserialize(std::shared_ptr<JsonValue>& Root) override         {   return ParseValue(m_First, m_Last, Root);           }
+    bool Deserialize(JsonDocument& Document) override                   {   return ParseDocument(m_First, m_Last, Document);    }
+
+    // Report the buffer to a handler without building a tree
+    template<class Handler>
+    void Parse(Handler& Events)                                         {   JsonReader::Parse(m_First, m_Last, Events);         }
+
+    const char* Data() const noexcept                                   {   return m_First;                                     }
+    size_t      Size() const noexcept                                   {   return static_cast<size_t>(m_Last - m_First);       }
+
+protected:
+    const char* m_First;
+    const char* m_Last;
+};
+
+// Class JsonMappedFileReader
+//
+// Maps a file read-only and parses the mapping in place, the text is never copied to
+// the heap. Falls back to reading the file into memory where mapping is unavailable.
+class JSON_API JsonMappedFileReader : public JsonBufferReader
+{
+protected:
+    explicit JsonMappedFileReader(const std::string& Path, bool HugePages);
+
+public:
+    using UniquePointer = std::unique_ptr<JsonMappedFileReader>;
+
+                            JsonMappedFileReader(const JsonMappedFileReader&) = delete;
+    JsonMappedFileReader&   operator=(const JsonMappedFileReader&) = delete;
+    virtual                 ~JsonMappedFileReader();
+
+    // HugePages asks the kernel to back the mapping with huge pages where supported
+    JSON_NODISCARD static UniquePointer Create(const std::string& Path, bool HugePages = false)
+    {
+        return UniquePointer(new JsonMappedFileReader(Path, HugePages));
+    }
+
+private:
+    void*               m_Mapping   = nullptr;
+    size_t              m_Length    = 0;
+    std::vector<char>   m_Fallback;
+};
+
+// Class JsonPushReader
+//
+// Incremental reader for input that arrives in pieces. Every Feed parses as much of
+// the chunk as it can and keeps only an unfinished trailing token, the tree is built
+// into a JsonDocument as the values complete.
+class JSON_API JsonPushReader : public JsonReader
+{
+protected:
+    JsonPushReader() : m_Builder(m_Document)                            {}
+
+public:
+    using UniquePointer = std::unique_ptr<JsonPushReader>;
+
+    virtual ~JsonPushReader() = default;
+
+    JSON_NODISCARD static UniquePointer Create()
+    {
+        return UniquePointer(new JsonPushReader());
+    }
+
+    void Feed(const char* Data, size_t Length);
+    void Feed(const std::string& Chunk)                                 {   Feed(Chunk.data(), Chunk.size());   }
+
+    // End of input, the document must be complete
+    void Finish();
+
+    // Discard a partially fed document, e.g. after a parse error
+    void Reset();
+
+    // Valid after Finish, hands the parsed tree over to the caller
+    bool Deserialize(std::shared_ptr<JsonValue>& Root) override;
+    bool Deserialize(JsonDocument& Document) override;
+
+private:
+    JsonDocument        m_Document;
+    JsonDocumentBuilder m_Builder;
+    std::string         m_Pending;
+    bool                m_Started   = false;
+    bool                m_Finished  = false;
+};
+
 class JSON_API JsonStringReader : public JsonReader
 {
 protected:
@@ -93,6 +274,11 @@ public:
     }
 
     bool Deserialize(std::shared_ptr<JsonValue>& Root) override;
+    bool Deserialize(JsonDocument& Document) override;
+
+    // Report the content to a handler without building a tree
+    template<class Handler>
+    void Parse(Handler& Events)                 {   JsonReader::Parse(m_Content.data(), m_Content.data() + m_Content.size(), Events);   }
 
 protected:
     std::string m_Content;
@@ -122,6 +308,8 @@ class JSON_API JsonReaderFactory
 public:
     using StringReaderPointer = std::unique_ptr<JsonStringReader>;
     using StreamReaderPointer = std::unique_ptr<JsonStreamReader>;
+    using BufferReaderPointer = std::unique_ptr<JsonBufferReader>;
+    using FileReaderPointer   = std::unique_ptr<JsonMappedFileReader>;
 
     template<class String, class = EnableIfString<String>>
     JSON_NODISCARD static StringReaderPointer Create(String&& Content)
@@ -132,13 +320,24 @@ public:
     {
         return JsonStreamReader::Create(IStream);
     }
+    JSON_NODISCARD static BufferReaderPointer Create(const char* Data, size_t Length)
+    {
+        return JsonBufferReader::Create(Data, Length);
+    }
+    JSON_NODISCARD static FileReaderPointer CreateFromFile(const std::string& Path, bool HugePages = false)
+    {
+        return JsonMappedFileReader::Create(Path, HugePages);
+    }
 
 };
 
 struct JSON_API Deserializer
 {
     bool operator()(JsonReader& Reader, JsonValue& Root) const;
-    bool operator()(JsonReader& Reader, std::shared_ptr<JsonValue>& Root) const {   return Reader.Deserialize(Root);    }
+    bool operator()(JsonReader& Reader, std::shared_ptr<JsonValue>& Root) const {   return Reader.Deserialize(Root);        }
+    bool operator()(JsonReader& Reader, JsonDocument& Document) const           {   return Reader.Deserialize(Document);    }
 };
 
-JSONCPP_NAMESPACE_END
\ No newline at end of file
+JSONCPP_NAMESPACE_END
+
+#include "reader.inl"
\ No newline at end of file
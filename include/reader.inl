@@ -0,0 +1,102 @@
+#pragma once
+#include "reader.h"
+#include "utils.h"
+
+JSONCPP_NAMESPACE_BEGIN
+
+template<class Handler>
+void JsonReader::Parse(const char* First, const char* Last, Handler& Events)
+{
+    BeginParse();
+    ParseChunk(First, Last, Events, true);
+    EndParse();
+}
+
+template<class Handler>
+void JsonReader::ParseElements(const char* First, const char* Last, Handler& Events)
+{
+    // Grammar state of an open array, the range holds complete comma separated elements
+    BeginParse();
+    m_ParseProcessState.push(JsonType::Array);
+    SetExpectedToken(JsonTokenType::AnyValue);
+    ParseChunk(First, Last, Events, true);
+    JSON_ASSERT_MESSAGE(m_ParseProcessState.size() == 1 && MatchExpectedToken(JsonTokenType::Comma), "Array element expected.");
+}
+
+template<class Handler>
+const char* JsonReader::ParseChunk(const char* First, const char* Last, Handler& Events, bool Final)
+{
+    // Jump from structural to structural, white space is never visited.
+    // A chunk always starts outside of a string, so the scanner starts from a clean state.
+    m_Scanner.Reset(First, Last);
+    auto Token = m_Scanner.Next();
+
+    while (Token != Last)
+    {
+        // A scalar with nothing after it may continue in the next chunk
+        auto NextToken = m_Scanner.Next();
+        if (!Final && NextToken == Last && !IsJsonOperator(*Token))
+            return Token;
+
+        const char* _Last = nullptr;
+        switch (*Token)
+        {
+        case ',': _Last = ParseComma(Token, Last); break;
+        case ':': _Last = ParseColon(Token, Last); break;
+        case 'n':
+            _Last = ParseNull(Token, Last);
+            Events.Null();
+            break;
+        case 't': JSON_FALLTHROUGH;
+        case 'f':
+        {
+            bool Value;
+            _Last = ParseBoolean(Token, Last, Value);
+            Events.Bool(Value);
+            break;
+        }
+        case '"':
+        {
+            JsonStringRef String;
+            bool IsIdentifier;
+            _Last = ParseString(Token, Last, String, IsIdentifier);
+            if (IsIdentifier)
+                Events.Key(String);
+            else
+                Events.String(String);
+            break;
+        }
+        case '[':
+            _Last = ParseArray(Token, Last);
+            Events.StartArray();
+            break;
+        case ']':
+            _Last = ParseArray(Token, Last);
+            Events.EndArray();
+            break;
+        case '{':
+            _Last = ParseObject(Token, Last);
+            Events.StartObject();
+            break;
+        case '}':
+            _Last = ParseObject(Token, Last);
+            Events.EndObject();
+            break;
+        default:
+        {
+            JSON_ASSERT_MESSAGE(IsJsonNumber(*Token), "Invalid json token.");
+            JsonNumeric Number;
+            _Last = ParseNumber(Token, Last, Number);
+            Events.Number(Number);
+        }
+        }
+
+        // Token must be followed by white space or by the next structural
+        JSON_ASSERT_MESSAGE(_Last == NextToken || IsWhiteSpace(*_Last), "Invalid json token.");
+        Token = NextToken;
+    }
+
+    return Last;
+}
+
+JSONCPP_NAMESPACE_END
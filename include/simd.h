@@ -0,0 +1,158 @@
+#pragma once
+#include "config.h"
+#include <cstdint>
+#include <cstring>
+
+#if !defined(JSON_DISABLE_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+	#define JSON_SIMD_SSE2
+	#include <emmintrin.h>
+#endif // SSE2
+
+#if defined(JSON_SIMD_SSE2) && (defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER))
+	#define JSON_SIMD_AVX2
+	#include <immintrin.h>
+#endif // AVX2
+
+#if defined(__GNUC__) || defined(__clang__)
+	#define JSON_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+	#define JSON_TARGET_AVX2
+#endif // JSON_TARGET_AVX2
+
+#ifdef _MSC_VER
+	#include <intrin.h>
+#endif // _MSC_VER
+
+JSONCPP_NAMESPACE_BEGIN
+
+namespace Simd {
+	inline uint32_t CountTrailingZeros(uint64_t Bits) noexcept
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		return static_cast<uint32_t>(__builtin_ctzll(Bits));
+#elif defined(_MSC_VER) && defined(_M_X64)
+		unsigned long Index;
+		_BitScanForward64(&Index, Bits);
+		return static_cast<uint32_t>(Index);
+#else
+		uint32_t Index = 0;
+		while (!(Bits & 1U)) { Bits >>= 1; ++Index; }
+		return Index;
+#endif
+	}
+
+	inline uint32_t CountLeadingZeros(uint64_t Bits) noexcept
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		return static_cast<uint32_t>(__builtin_clzll(Bits));
+#elif defined(_MSC_VER) && defined(_M_X64)
+		unsigned long Index;
+		_BitScanReverse64(&Index, Bits);
+		return static_cast<uint32_t>(63 - Index);
+#else
+		uint32_t Count = 0;
+		while (!(Bits & (uint64_t(1) << 63))) { Bits <<= 1; ++Count; }
+		return Count;
+#endif
+	}
+
+	inline uint32_t CountTrailingZeros(uint32_t Bits) noexcept
+	{
+		return CountTrailingZeros(static_cast<uint64_t>(Bits));
+	}
+
+	// Every bit is the parity of all bits at or below it
+	inline uint64_t PrefixXor(uint64_t Bits) noexcept
+	{
+		Bits ^= Bits << 1;
+		Bits ^= Bits << 2;
+		Bits ^= Bits << 4;
+		Bits ^= Bits << 8;
+		Bits ^= Bits << 16;
+		Bits ^= Bits << 32;
+		return Bits;
+	}
+
+	inline bool AddOverflow(uint64_t Lhs, uint64_t Rhs, uint64_t& Result) noexcept
+	{
+		Result = Lhs + Rhs;
+		return Result < Lhs;
+	}
+
+	// First '"' or '\\' in [First, Last), Last if there is none
+	inline const char* FindQuoteOrBackslash(const char* First, const char* Last) noexcept
+	{
+#ifdef JSON_SIMD_SSE2
+		const __m128i Quote = _mm_set1_epi8('"');
+		const __m128i Backslash = _mm_set1_epi8('\\');
+		for (; Last - First >= 16; First += 16)
+		{
+			const __m128i Chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(First));
+			const __m128i Found = _mm_or_si128(_mm_cmpeq_epi8(Chars, Quote), _mm_cmpeq_epi8(Chars, Backslash));
+			const uint32_t Mask = static_cast<uint32_t>(_mm_movemask_epi8(Found));
+			if (Mask)
+				return First + CountTrailingZeros(Mask);
+		}
+#endif // JSON_SIMD_SSE2
+		while (First != Last && *First != '"' && *First != '\\')
+			++First;
+		return First;
+	}
+
+	// First byte of [First, Last) a JSON string cannot carry as is - '"', '\\' or a control
+	// character, with EnsureAscii also every byte of a multi-byte sequence. Last if there is none
+	template<bool EnsureAscii>
+	inline const char* FindStringEscape(const char* First, const char* Last) noexcept
+	{
+#ifdef JSON_SIMD_SSE2
+		const __m128i Quote = _mm_set1_epi8('"');
+		const __m128i Backslash = _mm_set1_epi8('\\');
+		const __m128i Space = _mm_set1_epi8(0x20);
+		const __m128i ControlMax = _mm_set1_epi8(0x1F);
+		for (; Last - First >= 16; First += 16)
+		{
+			const __m128i Chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(First));
+			__m128i Found = _mm_or_si128(_mm_cmpeq_epi8(Chars, Quote), _mm_cmpeq_epi8(Chars, Backslash));
+			// Signed compare takes bytes from 0x80 up as negative, unsigned min keeps them out
+			if (EnsureAscii)
+				Found = _mm_or_si128(Found, _mm_cmplt_epi8(Chars, Space));
+			else
+				Found = _mm_or_si128(Found, _mm_cmpeq_epi8(_mm_min_epu8(Chars, ControlMax), Chars));
+			const uint32_t Mask = static_cast<uint32_t>(_mm_movemask_epi8(Found));
+			if (Mask)
+				return First + CountTrailingZeros(Mask);
+		}
+#endif // JSON_SIMD_SSE2
+		for (; First != Last; ++First)
+		{
+			const auto Byte = static_cast<uint8_t>(*First);
+			if (Byte < 0x20U || Byte == '"' || Byte == '\\' || (EnsureAscii && Byte >= 0x80U))
+				break;
+		}
+		return First;
+	}
+
+	inline bool CpuSupportsAvx2() noexcept
+	{
+#if defined(JSON_SIMD_AVX2) && (defined(__GNUC__) || defined(__clang__))
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") != 0;
+#elif defined(JSON_SIMD_AVX2) && defined(_MSC_VER)
+		int Info[4];
+		__cpuid(Info, 0);
+		if (Info[0] < 7)
+			return false;
+		__cpuid(Info, 1);
+		const bool OSXSave = (Info[2] & (1 << 27)) != 0;
+		const bool Avx = (Info[2] & (1 << 28)) != 0;
+		if (!OSXSave || !Avx || (_xgetbv(0) & 0x6U) != 0x6U)
+			return false;
+		__cpuidex(Info, 7, 0);
+		return (Info[1] & (1 << 5)) != 0;
+#else
+		return false;
+#endif
+	}
+}
+
+JSONCPP_NAMESPACE_END
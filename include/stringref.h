@@ -0,0 +1,92 @@
+#pragma once
+#include "config.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+JSONCPP_NAMESPACE_BEGIN
+
+// Class JsonStringRef - non-owning view of a character range
+class JsonStringRef
+{
+public:
+    using SizeType      = size_t;
+    using ConstPointer  = const char*;
+
+    constexpr           JsonStringRef() noexcept = default;
+    constexpr           JsonStringRef(const char* Data, SizeType Length) noexcept : m_Data(Data), m_Length(Length)  {}
+                        JsonStringRef(const char* Src) noexcept : m_Data(Src), m_Length(std::strlen(Src))           {}
+                        JsonStringRef(const std::string& Src) noexcept : m_Data(Src.data()), m_Length(Src.size())   {}
+
+    ConstPointer        Data() const noexcept                               {   return m_Data;                                      }
+    SizeType            Size() const noexcept                               {   return m_Length;                                    }
+    SizeType            Length() const noexcept                             {   return m_Length;                                    }
+    bool                Empty() const noexcept                              {   return m_Length == 0;                               }
+
+    ConstPointer        Begin() const noexcept                              {   return m_Data;                                      }
+    ConstPointer        End() const noexcept                                {   return m_Data + m_Length;                           }
+    char                operator[](SizeType Index) const noexcept          {   return m_Data[Index];                               }
+
+    std::string         ToString() const                                    {   return std::string(m_Data, m_Length);               }
+
+    // FNV-1a, used for member names which are short
+    uint32_t            Hash() const noexcept
+    {
+        uint32_t Value = 2166136261U;
+        for (SizeType Index = 0; Index < m_Length; ++Index)
+            Value = (Value ^ static_cast<unsigned char>(m_Data[Index])) * 16777619U;
+        return Value;
+    }
+
+    int                 Compare(const JsonStringRef& Rhs) const noexcept
+    {
+        const SizeType Length = m_Length < Rhs.m_Length ? m_Length : Rhs.m_Length;
+        const int Result = Length ? std::memcmp(m_Data, Rhs.m_Data, Length) : 0;
+        if (Result != 0)
+            return Result;
+        return m_Length < Rhs.m_Length ? -1 : (m_Length > Rhs.m_Length ? 1 : 0);
+    }
+
+    // Comparison
+    bool                operator==(const JsonStringRef& Rhs) const noexcept
+    {
+        return m_Length == Rhs.m_Length && (m_Data == Rhs.m_Data || std::memcmp(m_Data, Rhs.m_Data, m_Length) == 0);
+    }
+    bool                operator!=(const JsonStringRef& Rhs) const noexcept {   return !(*this == Rhs);                             }
+    bool                operator<(const JsonStringRef& Rhs) const noexcept  {   return Compare(Rhs) < 0;                            }
+
+private:
+    const char* m_Data      = nullptr;
+    SizeType    m_Length    = 0;
+};
+
+// Class JsonKey
+//
+// Member name with its hash computed once, for lookups repeated in hot loops. The key
+// references the bytes it was built from, which must outlive it - a literal or a string
+// kept alongside, e.g. static const JsonKey Id("id").
+class JsonKey
+{
+public:
+    using SizeType      = JsonStringRef::SizeType;
+    using ConstPointer  = JsonStringRef::ConstPointer;
+
+    explicit            JsonKey(JsonStringRef Name) noexcept : m_Name(Name), m_Hash(Name.Hash())              {}
+    explicit            JsonKey(const char* Name) noexcept : JsonKey(JsonStringRef(Name))                       {}
+    explicit            JsonKey(const std::string& Name) noexcept : JsonKey(JsonStringRef(Name))                {}
+                        JsonKey(const char* Data, SizeType Length) noexcept : JsonKey(JsonStringRef(Data, Length))  {}
+
+    ConstPointer        Data() const noexcept                               {   return m_Name.Data();                               }
+    SizeType            Size() const noexcept                               {   return m_Name.Size();                               }
+    uint32_t            Hash() const noexcept                               {   return m_Hash;                                      }
+    JsonStringRef       Name() const noexcept                               {   return m_Name;                                      }
+
+                        operator JsonStringRef() const noexcept             {   return m_Name;                                      }
+
+private:
+    JsonStringRef       m_Name;
+    uint32_t            m_Hash;
+};
+
+JSONCPP_NAMESPACE_END
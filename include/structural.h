@@ -0,0 +1,67 @@
+#pragma once
+#include "config.h"
+#include <cstdint>
+#include <cstddef>
+
+JSONCPP_NAMESPACE_BEGIN
+
+// Class JsonStructuralScanner
+//
+// First stage of the reader. Classifies the input 64 bytes at a time and yields
+// the position of every structural character ({ } [ ] : ,) and of the first
+// byte of every scalar (string, number, literal) that lies outside a string.
+// Positions are produced in batches, so the index never holds more than
+// BatchSize blocks at once regardless of the document size.
+class JSON_API JsonStructuralScanner
+{
+public:
+    static constexpr uint32_t BlockSize = 64;
+    static constexpr uint32_t BatchSize = 16;
+
+    struct BlockMasks
+    {
+        uint64_t Quote;
+        uint64_t Backslash;
+        uint64_t Operator;
+        uint64_t WhiteSpace;
+    };
+
+    using ClassifyFunction = void(*)(const char* First, uint32_t Blocks, BlockMasks* OutMasks);
+
+                        JsonStructuralScanner() = default;
+                        JsonStructuralScanner(const char* First, const char* Last) noexcept   {   Reset(First, Last);     }
+
+    void                Reset(const char* First, const char* Last) noexcept;
+
+    // Position of the next structural character, Last when the input is exhausted
+    const char*         Next()
+    {
+        while (m_Index == m_Count)
+        {
+            if (m_Cursor == m_Last)
+                return m_Last;
+            Refill();
+        }
+        return m_Base + m_Offsets[m_Index++];
+    }
+
+    static const char*  KernelName() noexcept;
+
+private:
+    void                Refill();
+    void                IndexBlock(const BlockMasks& Masks, uint32_t Offset) noexcept;
+    uint64_t            FindEscaped(uint64_t Backslash) noexcept;
+
+private:
+    const char* m_Base                              = nullptr;
+    const char* m_Cursor                            = nullptr;
+    const char* m_Last                              = nullptr;
+    uint32_t    m_Index                             = 0;
+    uint32_t    m_Count                             = 0;
+    uint64_t    m_PrevEscaped                       = 0;
+    uint64_t    m_PrevInString                      = 0;
+    uint64_t    m_PrevScalar                        = 0;
+    uint32_t    m_Offsets[BatchSize * BlockSize];
+};
+
+JSONCPP_NAMESPACE_END
@@ -15,6 +15,14 @@ enum class JsonType : uint32_t
     Object	= 6,
 };
 
+enum class JsonNumberType : uint32_t
+{
+    Int64   = 0,
+    UInt64  = 1,
+    Double  = 2,
+    Text    = 3,    // as written, the number does not survive conversion to the others
+};
+
 enum class JsonTokenType : uint32_t
 {
     EndFile     = 0,
@@ -11,6 +11,14 @@ bool IsWhiteSpace(const CharT& Char) noexcept
 		Char == CharT('\n') || Char == CharT('\r'));
 }
 
+template<class CharT = char>
+bool IsJsonOperator(const CharT& Char) noexcept
+{
+	return (Char == CharT(',') || Char == CharT(':') ||
+		Char == CharT('[') || Char == CharT(']') ||
+		Char == CharT('{') || Char == CharT('}'));
+}
+
 template<class CharT = char>
 bool IsSign(const CharT& Char) noexcept
 {
@@ -1,17 +1,21 @@
 #pragma once
 #include "error.h"
 #include "type.h"
+#include "number.h"
+#include "object.h"
+#include "fragment.h"
 #include <memory>
 #include <sstream>
 #include <array>
 #include <vector>
-#include <map>
 
 JSONCPP_NAMESPACE_BEGIN
 
 // Class JsonValue
 class JSON_API JsonValue
 {
+    friend class JsonFragmentTable;
+
 protected:
     template<class T>
     using TSharedPtr            = std::shared_ptr<T>;
@@ -19,7 +23,7 @@ protected:
     using NumberType            = std::basic_string<char>;
     using StringType            = std::basic_string<char>;
     using ArrayContainerType    = std::vector<TSharedPtr<JsonValue>>;
-    using ObjectContainerType   = std::map<StringType, TSharedPtr<JsonValue>>;
+    using ObjectContainerType   = JsonObjectStorage;
 
     using PointerArray          = ArrayContainerType*;
     using CPointerArray         = const ArrayContainerType*;
@@ -31,8 +35,11 @@ protected:
     using ReferenceMap          = ObjectContainerType&;
     using CReferenceMap         = const ObjectContainerType&;
 
-    explicit JsonValue(JsonType Type = JsonType::Unknown) : m_Type(Type) {}
-    virtual ~JsonValue() = default;
+    explicit JsonValue(JsonType Type = JsonType::Unknown) : m_Type(Type), m_Link(0), m_Lazy(0)  {}
+    // Copies start outside the serialization cache, assigning over a value changes it
+    JsonValue(const JsonValue& Other) noexcept : m_Type(Other.m_Type), m_Link(0), m_Lazy(0)    {}
+    JsonValue& operator=(const JsonValue& Rhs) noexcept                 {   Invalidate(); m_Type = Rhs.m_Type; return *this;    }
+    virtual ~JsonValue()                                                {   if (m_Link != 0) JsonFragmentTable::Forget(this);   }
 
 public:
     static constexpr uint32_t NumTypes = static_cast<uint32_t>(JsonType::Object) + 1;
@@ -50,9 +57,9 @@ public:
     virtual bool        GetMap(PointerMap& OutMap)                      {   return false;               }
     virtual bool        GetMap(CPointerMap& OutMap) const               {   return false;               }
 
-    static bool         Equal(const JsonValue& Lhs, const JsonValue& Rhs) noexcept;
-    bool                operator==(const JsonValue& Rhs) const noexcept {   return Equal(*this, Rhs);   }
-    bool                operator!=(const JsonValue& Rhs) const noexcept {   return !Equal(*this, Rhs);  }
+    static bool         Equal(const JsonValue& Lhs, const JsonValue& Rhs);
+    bool                operator==(const JsonValue& Rhs) const          {   return Equal(*this, Rhs);   }
+    bool                operator!=(const JsonValue& Rhs) const          {   return !Equal(*this, Rhs);  }
 
     bool                AsBool() const;
     double              AsNumber() const;
@@ -62,11 +69,18 @@ public:
     ReferenceMap        AsObject();
     CReferenceMap       AsObject() const;
 
+    // Drops the cached bytes of the containers holding the value, see JsonFormatter::SetFragmentCache.
+    // Modifiers and AsArray/AsObject call it, a child replaced through a reference that At,
+    // operator[], Find or an iterator returned is only seen after calling it on the container.
+    void                Invalidate() const noexcept                     {   if (m_Link != 0) JsonFragmentTable::Drop(this); }
+
 protected:
     void                TypeCastErrorMessage(JsonType CastTo) const;
 
 protected:
-    JsonType m_Type;
+    JsonType            m_Type;
+    mutable uint32_t    m_Link : 31;                // record slot in JsonFragmentTable, 0 for none
+    mutable uint32_t    m_Lazy : 1;                 // container still on the tape of a lazy document
 };
 
 // Class JsonNull
@@ -91,7 +105,7 @@ public:
     bool            IsTrue() const noexcept                             {   return m_Boolean == true;                               }
     bool            IsFalse() const noexcept                            {   return !IsTrue();                                       }
 
-    JsonBoolean&    SetBoolean(ValueType Value) noexcept                {   m_Boolean = Value; return *this;                        }
+    JsonBoolean&    SetBoolean(ValueType Value) noexcept                {   Invalidate(); m_Boolean = Value; return *this;          }
 
     bool            GetBoolean() const noexcept                         {   return m_Boolean;                                       }
     bool            GetBoolean(bool& OutBool) const override            {   OutBool = m_Boolean; return true;                       }
@@ -113,37 +127,50 @@ public:
     using ValueType = NumberType;
 
     template<class T, class = typename std::enable_if<std::is_arithmetic<T>::value>::type>
-    explicit    JsonNumber(const T& Value = T(0));
-    explicit    JsonNumber(const ValueType& Value);
-    explicit    JsonNumber(ValueType&& Value) noexcept;
+    explicit        JsonNumber(const T& Value = T(0));
+    explicit        JsonNumber(const JsonNumeric& Value) : JsonValue(JsonType::Number), m_Number(Value)            {   StoreText();    }
+    explicit        JsonNumber(const ValueType& Value);
+                    JsonNumber(const JsonNumber& Other) : JsonValue(Other), m_Number(Other.m_Number)        {   StoreText();    }
+                    ~JsonNumber()                                                                           {   ReleaseText();  }
 
-    JsonNumber& operator=(double Value)                             {   return SetNumber(Value);                        }
-    JsonNumber& operator=(const ValueType& Value);
-    JsonNumber& operator=(ValueType&& Value) noexcept;
+    JsonNumber&     operator=(const JsonNumber& Rhs);
+
+    JsonNumber&     operator=(double Value)                             {   return SetNumber(Value);                        }
+    JsonNumber&     operator=(const ValueType& Value);
 
     template<class T>
-    JsonNumber& SetNumber(const T& Value);
+    JsonNumber&     SetNumber(const T& Value);
 
     template<class T>
-    T           GetNumber() const;
+    T               GetNumber() const                                   {   return m_Number.Get<T>();                       }
 
     template<class T>
-    bool        GetNumber(T& OutNumber) const                       {   OutNumber = GetNumber<T>(); return true;        }
+    bool            GetNumber(T& OutNumber) const                       {   OutNumber = GetNumber<T>(); return true;        }
+
+    JsonNumberType  GetNumberType() const noexcept                      {   return m_Number.Type;                           }
+    bool            IsInteger() const noexcept                          {   return m_Number.IsInteger();                    }
+    // Text numbers view storage of this value, valid until it changes
+    JsonNumeric     GetNumeric() const noexcept                         {   return m_Number;                                }
 
-    bool        GetBoolean(bool& OutBool) const override            {   OutBool = GetNumber<bool>(); return true;       }
-    bool        GetNumber(double& OutNumber) const override         {   OutNumber = GetNumber<double>(); return true;   }
-    bool        GetString(StringType& OutString) const override     {   OutString = m_Number; return true;              }
+    bool            GetBoolean(bool& OutBool) const override            {   OutBool = GetNumber<bool>(); return true;       }
+    bool            GetNumber(double& OutNumber) const override         {   OutNumber = GetNumber<double>(); return true;   }
+    bool            GetString(StringType& OutString) const override;
 
     // Comparison
-    bool        operator==(const JsonNumber& Rhs) const noexcept;
-    bool        operator!=(const JsonNumber& Rhs) const noexcept    {   return !(*this == Rhs);                         }
+    bool            operator==(const JsonNumber& Rhs) const noexcept    {   return JsonNumeric::Equal(m_Number, Rhs.m_Number); }
+    bool            operator!=(const JsonNumber& Rhs) const noexcept    {   return !(*this == Rhs);                         }
 
     // Cast to aithmetical types
     template<class T>
-    operator T() const                                              {   return GetNumber<T>();                          }
+    operator T() const                                                  {   return GetNumber<T>();                          }
 
 private:
-    ValueType   m_Number;
+    // The lexeme of a Text number is owned, a copy replaces the view it was given
+    void            StoreText();
+    void            ReleaseText() noexcept                              {   if (m_Number.Type == JsonNumberType::Text) delete[] m_Number.Text;  }
+
+private:
+    JsonNumeric     m_Number;
 };
 
 // Class JsonString
@@ -202,19 +229,19 @@ public:
     void                    Reserve(uint32_t Count)                                         {   m_String.reserve(Count);                                    }
 
     // Modifiers
-    void                    Clear() noexcept                                                {   m_String.clear();                                           }
-    void                    PopBack() noexcept                                              {   m_String.pop_back();                                        }
-    void                    PushBack(const char Char)                                       {   m_String.push_back(Char);                                   }
-    void                    Resize(uint32_t Count)                                          {   m_String.resize(Count);                                     }
-    void                    Resize(uint32_t Count, char Char)                               {   m_String.resize(Count, Char);                               }
+    void                    Clear() noexcept                                                {   Invalidate(); m_String.clear();                             }
+    void                    PopBack() noexcept                                              {   Invalidate(); m_String.pop_back();                          }
+    void                    PushBack(const char Char)                                       {   Invalidate(); m_String.push_back(Char);                     }
+    void                    Resize(uint32_t Count)                                          {   Invalidate(); m_String.resize(Count);                       }
+    void                    Resize(uint32_t Count, char Char)                               {   Invalidate(); m_String.resize(Count, Char);                 }
 
     template<class FwdIter>
-    JsonString&             Append(FwdIter First, FwdIter Last)                             {   m_String.append(First, Last); return *this;                 }
-    JsonString&             Append(uint32_t Count, const char Char)                         {   m_String.append(Count, Char); return *this;                 }
-    JsonString&             Append(const JsonString& Other)                                 {   m_String.append(Other.m_String); return *this;              }
-    JsonString&             Append(const JsonString& Other, uint32_t Pos, uint32_t Count)   {   m_String.append(Other.m_String, Pos, Count);  return *this; }
-    JsonString&             Append(const char* Src, uint32_t Count)                         {   m_String.append(Src, Count); return *this;                  }
-    JsonString&             Append(const char* Src)                                         {   m_String.append(Src); return *this;                         }
+    JsonString&             Append(FwdIter First, FwdIter Last)                             {   Invalidate(); m_String.append(First, Last); return *this;   }
+    JsonString&             Append(uint32_t Count, const char Char)                         {   Invalidate(); m_String.append(Count, Char); return *this;   }
+    JsonString&             Append(const JsonString& Other)                                 {   Invalidate(); m_String.append(Other.m_String); return *this; }
+    JsonString&             Append(const JsonString& Other, uint32_t Pos, uint32_t Count)   {   Invalidate(); m_String.append(Other.m_String, Pos, Count); return *this; }
+    JsonString&             Append(const char* Src, uint32_t Count)                         {   Invalidate(); m_String.append(Src, Count); return *this;    }
+    JsonString&             Append(const char* Src)                                         {   Invalidate(); m_String.append(Src); return *this;           }
 
     // Comparison
     bool                    operator==(const JsonString& Rhs) const noexcept                {   return m_String == Rhs.m_String;                            }
@@ -246,7 +273,11 @@ public:
                             JsonArray() : JsonValue(JsonType::Array)                {}
     explicit                JsonArray(const ContainerType& Array);
     explicit                JsonArray(ContainerType&& Array) noexcept;
+                            JsonArray(const JsonArray& Other);
+                            JsonArray(JsonArray&& Other);
 
+    JsonArray&              operator=(const JsonArray& Rhs)                         {   Rhs.Materialize(); return *this = Rhs.m_Array;  }
+    JsonArray&              operator=(JsonArray&& Rhs)                              {   Rhs.Materialize(); return *this = std::move(Rhs.m_Array);   }
     JsonArray&              operator=(const ContainerType& Array);
     JsonArray&              operator=(ContainerType&& Array) noexcept;
     
@@ -257,53 +288,63 @@ public:
     ValueType&              At(uint32_t Index);
     const ValueType&        At(uint32_t Index) const;
 
-    Reference               Front() noexcept                                        {   return m_Array.front();         }
-    ConstReference          Front() const noexcept                                  {   return m_Array.front();         }
-    Reference               Back() noexcept                                         {   return m_Array.back();          }
-    ConstReference          Back() const noexcept                                   {   return m_Array.back();          }
-    Pointer                 Data() noexcept                                         {   return m_Array.data();          }
-    ConstPointer            Data() const noexcept                                   {   return m_Array.data();          }
+    Reference               Front()                                                 {   Materialize(); return m_Array.front();          }
+    ConstReference          Front() const                                           {   Materialize(); return m_Array.front();          }
+    Reference               Back()                                                  {   Materialize(); return m_Array.back();           }
+    ConstReference          Back() const                                            {   Materialize(); return m_Array.back();           }
+    Pointer                 Data()                                                  {   Materialize(); return m_Array.data();           }
+    ConstPointer            Data() const                                            {   Materialize(); return m_Array.data();           }
 
-    Reference               operator[](uint32_t Index) noexcept                     {   return m_Array[Index];          }
-    ConstReference          operator[](uint32_t Index) const noexcept               {   return m_Array[Index];          }
+    Reference               operator[](uint32_t Index)                              {   Materialize(); return m_Array[Index];           }
+    ConstReference          operator[](uint32_t Index) const                        {   Materialize(); return m_Array[Index];           }
 
     // Iterator
-    Iterator                Begin() noexcept                                        {   return m_Array.begin();         }
-    Iterator                End() noexcept                                          {   return m_Array.end();           }
-    ConstIterator           CBegin() const noexcept                                 {   return m_Array.cbegin();        }
-    ConstIterator           CEnd() const noexcept                                   {   return m_Array.cend();          }
-    ReverseIterator         RBegin() noexcept                                       {   return m_Array.rbegin();        }
-    ReverseIterator         REnd() noexcept                                         {   return m_Array.rend();          }
-    ConstReverseIterator    CRbegin() const noexcept                                {   return m_Array.crbegin();       }
-    ConstReverseIterator    CREnd() const noexcept                                  {   return m_Array.crend();         }
+    Iterator                Begin()                                                 {   Materialize(); return m_Array.begin();          }
+    Iterator                End()                                                   {   Materialize(); return m_Array.end();            }
+    ConstIterator           CBegin() const                                          {   Materialize(); return m_Array.cbegin();         }
+    ConstIterator           CEnd() const                                            {   Materialize(); return m_Array.cend();           }
+    ReverseIterator         RBegin()                                                {   Materialize(); return m_Array.rbegin();         }
+    ReverseIterator         REnd()                                                  {   Materialize(); return m_Array.rend();           }
+    ConstReverseIterator    CRbegin() const                                         {   Materialize(); return m_Array.crbegin();        }
+    ConstReverseIterator    CREnd() const                                           {   Materialize(); return m_Array.crend();          }
 
     // Lookup
     template<JsonType Type>
-    bool                    HasType(uint32_t Index) const                           {   return At(Index)->Is<Type>();   }
+    bool                    HasType(uint32_t Index) const                           {   return At(Index)->Is<Type>();                   }
 
     // Capacity             
-    bool                    Empty() const noexcept                                  {   return m_Array.empty();         }
-    SizeType                Size() const noexcept                                   {   return m_Array.size();          }
-    SizeType                Capacity() const noexcept                               {   return m_Array.capacity();      }
-    void                    Reserve(uint32_t Size)                                  {   m_Array.reserve(Size);          }
+    bool                    Empty() const                                           {   Materialize(); return m_Array.empty();          }
+    SizeType                Size() const                                            {   Materialize(); return m_Array.size();           }
+    SizeType                Capacity() const                                        {   Materialize(); return m_Array.capacity();       }
+    void                    Reserve(uint32_t Size)                                  {   Materialize(); m_Array.reserve(Size);           }
 
     // Modifiers
-    void                    Clear() noexcept                                        {   m_Array.clear();                }
-    void                    PopBack() noexcept                                      {   m_Array.pop_back();             }
-    void                    PushBack(ValueType Value)                               {   m_Array.push_back(Value);       }
-    void                    Erase(ConstIterator Where) noexcept                     {   m_Array.erase(Where);           }
-    void                    Insert(ConstIterator Where, ValueType Value)            {   m_Array.insert(Where, Value);   }
-    void                    Resize(uint32_t Count, ValueType Value = ValueType())   {   m_Array.resize(Count, Value);   }
+    void                    Clear() noexcept                                        {   Detach(); Invalidate(); m_Array.clear();        }
+    void                    PopBack()                                               {   Materialize(); Invalidate(); m_Array.pop_back(); }
+    void                    PushBack(ValueType Value)                               {   Materialize(); Invalidate(); m_Array.push_back(Value); }
+    void                    Erase(ConstIterator Where) noexcept                     {   Invalidate(); m_Array.erase(Where);             }
+    void                    Insert(ConstIterator Where, ValueType Value)            {   Invalidate(); m_Array.insert(Where, Value);     }
+    void                    Resize(uint32_t Count, ValueType Value = ValueType())   {   Materialize(); Invalidate(); m_Array.resize(Count, Value); }
 
     bool                    GetArray(PointerArray& OutArray) override;
     bool                    GetArray(CPointerArray& OutArray) const override;
 
+    // Lazy documents - false until the elements have been parsed
+    bool                    IsMaterialized() const noexcept                         {   return m_Lazy == 0;                             }
+
     // Comparison
-    bool                    operator==(const JsonArray& Rhs) const noexcept         {   return m_Array == Rhs.m_Array;  }
-    bool                    operator!=(const JsonArray& Rhs) const noexcept         {   return !(*this == Rhs);         }
+    bool                    operator==(const JsonArray& Rhs) const                  {   Materialize(); Rhs.Materialize(); return m_Array == Rhs.m_Array;    }
+    bool                    operator!=(const JsonArray& Rhs) const                  {   return !(*this == Rhs);                         }
     
 private:
-    ContainerType m_Array;
+    // Containers of a lazy document are subclasses holding the tape, flagged by m_Lazy
+    void                    Materialize() const                                     {   if (m_Lazy) Load();                             }
+    void                    Detach() const noexcept                                 {   if (m_Lazy) Release();                          }
+    void                    Load() const;
+    void                    Release() const noexcept;
+
+private:
+    mutable ContainerType   m_Array;
 };
 
 // Class JsonObject
@@ -323,66 +364,100 @@ public:
     using ConstReverseIterator  = typename ContainerType::const_reverse_iterator;
 
                             JsonObject() : JsonValue(JsonType::Object)  {}
+    explicit                JsonObject(JsonObjectLayout Layout) : JsonValue(JsonType::Object), m_Values(Layout)    {}
     explicit                JsonObject(const ContainerType& Values);
     explicit                JsonObject(ContainerType&& Values) noexcept;
+                            JsonObject(const JsonObject& Other);
+                            JsonObject(JsonObject&& Other);
 
+    JsonObject&             operator=(const JsonObject& Rhs)                    {   Rhs.Materialize(); return *this = Rhs.m_Values;             }
+    JsonObject&             operator=(JsonObject&& Rhs)                         {   Rhs.Materialize(); return *this = std::move(Rhs.m_Values);  }
     JsonObject&             operator=(const ContainerType& Values);
     JsonObject&             operator=(ContainerType&& Values) noexcept;
 
     // Element access
+    // Names are looked up without allocating, a JsonKey also skips hashing them
+    template<class Return = JsonValue>
+    TSharedPtr<Return>      GetValueAs(JsonStringRef Identifier) const;
     template<class Return = JsonValue>
-    TSharedPtr<Return>      GetValueAs(const KeyType& Identifier) const;
+    TSharedPtr<Return>      GetValueAs(const JsonKey& Identifier) const;
 
-    MappedType&             At(const KeyType& Identifier);
-    const MappedType&       At(const KeyType& Identifier) const;
+    MappedType&             At(JsonStringRef Identifier);
+    const MappedType&       At(JsonStringRef Identifier) const;
+    MappedType&             At(const JsonKey& Identifier);
+    const MappedType&       At(const JsonKey& Identifier) const;
 
-    MappedType&             operator[](const KeyType& Identifier)               {   return m_Values[Identifier];                        }
-    MappedType&             operator[](KeyType&& Identifier)                    {   return m_Values[std::move(Identifier)];             }
+    MappedType&             operator[](const KeyType& Identifier);
+    MappedType&             operator[](KeyType&& Identifier);
 
     // Iterator
-    Iterator                Begin() noexcept                                    {   return m_Values.begin();                            }
-    Iterator                End() noexcept                                      {   return m_Values.end();                              }
-    ConstIterator           CBegin() const noexcept                             {   return m_Values.cbegin();                           }
-    ConstIterator           CEnd() const noexcept                               {   return m_Values.cend();                             }
-    ReverseIterator         RBegin() noexcept                                   {   return m_Values.rbegin();                           }
-    ReverseIterator         REnd() noexcept                                     {   return m_Values.rend();                             }
-    ConstReverseIterator    CRBegin() const noexcept                            {   return m_Values.crbegin();                          }
-    ConstReverseIterator    CREnd() const noexcept                              {   return m_Values.crend();                            }
+    Iterator                Begin()                                             {   Materialize(); return m_Values.begin();                     }
+    Iterator                End()                                               {   Materialize(); return m_Values.end();                       }
+    ConstIterator           CBegin() const                                      {   Materialize(); return m_Values.cbegin();                    }
+    ConstIterator           CEnd() const                                        {   Materialize(); return m_Values.cend();                      }
+    ReverseIterator         RBegin()                                            {   Materialize(); return m_Values.rbegin();                    }
+    ReverseIterator         REnd()                                              {   Materialize(); return m_Values.rend();                      }
+    ConstReverseIterator    CRBegin() const                                     {   Materialize(); return m_Values.crbegin();                   }
+    ConstReverseIterator    CREnd() const                                       {   Materialize(); return m_Values.crend();                     }
 
     // Lookup
     template<JsonType Type>
-    bool                HasType(const KeyType& Identifier) const;
-    bool                Has(const KeyType& Identifier) const;
-    Iterator            Find(const KeyType& Identifier)                     {   return m_Values.find(Identifier);                   }
-    ConstIterator       Find(const KeyType& Identifier) const               {   return m_Values.find(Identifier);                   }
-    uint32_t            Count(JsonType Type) const noexcept;
-    bool                Contains(JsonType Type) const noexcept;
+    bool                HasType(JsonStringRef Identifier) const;
+    template<JsonType Type>
+    bool                HasType(const JsonKey& Identifier) const;
+    bool                Has(JsonStringRef Identifier) const                 {   return Lookup(Identifier) != nullptr;                       }
+    bool                Has(const JsonKey& Identifier) const                {   return Lookup(Identifier) != nullptr;                       }
+    Iterator            Find(JsonStringRef Identifier)                      {   Materialize(); return m_Values.find(Identifier);            }
+    ConstIterator       Find(JsonStringRef Identifier) const                {   Materialize(); return m_Values.find(Identifier);            }
+    Iterator            Find(const JsonKey& Identifier)                     {   Materialize(); return m_Values.find(Identifier);            }
+    ConstIterator       Find(const JsonKey& Identifier) const               {   Materialize(); return m_Values.find(Identifier);            }
+    uint32_t            Count(JsonType Type) const;
+    bool                Contains(JsonType Type) const;
 
     // Capacity
-    bool                Empty() const noexcept                              {   return m_Values.empty();                            }
-    SizeType            Size() const noexcept                               {   return m_Values.size();                             }
+    bool                Empty() const                                       {   Materialize(); return m_Values.empty();                     }
+    SizeType            Size() const                                        {   Materialize(); return m_Values.size();                      }
+
+    // Layout - how members are ordered and looked up, see JsonObjectLayout
+    JsonObjectLayout    GetLayout() const noexcept                          {   return m_Values.GetLayout();                                }
+    void                SetLayout(JsonObjectLayout Layout)                  {   Materialize(); Invalidate(); m_Values.SetLayout(Layout);    }
 
     // Modifiers
-    void                Clear() noexcept                                    {   m_Values.clear();                                   }
-    void                Erase(const KeyType& Identifier);
-    void                Erase(ConstIterator Where)                          {   m_Values.erase(Where);                              }
-    bool                Insert(const ValueType& Value)                      {   return m_Values.insert(Value).second;               }
-    bool                Insert(ValueType&& Value)                           {   return m_Values.insert(std::move(Value)).second;    }
+    void                Clear() noexcept                                    {   Detach(); Invalidate(); m_Values.clear();                   }
+    void                Erase(JsonStringRef Identifier);
+    void                Erase(ConstIterator Where)                          {   Invalidate(); m_Values.erase(Where);                        }
+    bool                Insert(const ValueType& Value)                      {   Materialize(); Invalidate(); return m_Values.insert(Value).second; }
+    bool                Insert(ValueType&& Value)                           {   Materialize(); Invalidate(); return m_Values.insert(std::move(Value)).second; }
     bool                Insert(const KeyType& Identifier, MappedType Value);
     bool                Insert(KeyType&& Identifier, MappedType Value);
     MappedType          Extract(ConstIterator Where);
-    MappedType          Extract(const KeyType& Identifier);
+    MappedType          Extract(JsonStringRef Identifier);
     bool                Emplace(KeyType&& Identifier, MappedType Value);
 
     bool                GetMap(PointerMap& OutMap) override;
     bool                GetMap(CPointerMap& OutMap) const override;
 
+    // Lazy documents - false until the members have been parsed
+    bool                IsMaterialized() const noexcept                     {   return m_Lazy == 0;                                         }
+
     // Comparison
-    bool                operator==(const JsonObject& Rhs) const noexcept    {   return m_Values == Rhs.m_Values;                    }
-    bool                operator!=(const JsonObject& Rhs) const noexcept    {   return !(*this == Rhs);                             }
+    bool                operator==(const JsonObject& Rhs) const             {   Materialize(); Rhs.Materialize(); return m_Values == Rhs.m_Values;  }
+    bool                operator!=(const JsonObject& Rhs) const             {   return !(*this == Rhs);                                     }
+
+private:
+    void                Materialize() const                                 {   if (m_Lazy) Load();                                         }
+    void                Detach() const noexcept                             {   if (m_Lazy) Release();                                      }
+    void                Load() const;
+    void                Release() const noexcept;
+
+    // Member named Identifier, nullptr when there is none
+    template<class Key>
+    MappedType*         Lookup(const Key& Identifier) const;
+    template<class Return>
+    TSharedPtr<Return>  CastValue(const MappedType* Value) const;
 
 private:
-    ContainerType m_Values;
+    mutable ContainerType   m_Values;
 };
 
 JSONCPP_NAMESPACE_END
@@ -23,21 +23,12 @@ template<class T>
 inline JsonNumber& JsonNumber::SetNumber(const T& Value)
 {
     JSON_STATIC_ASSERT(std::is_arithmetic<T>::value);
-    m_Number = std::to_string(Value);
+    Invalidate();
+    ReleaseText();
+    m_Number.Set(Value);
     return *this;
 }
 
-template<class T>
-inline T JsonNumber::GetNumber() const
-{
-    JSON_STATIC_ASSERT(std::is_arithmetic<T>::value);
-    std::stringstream Stream;
-    Stream << m_Number;
-    T Value;
-    Stream >> Value;
-    return Value;
-}
-
 template<class Return>
 inline JsonValue::TSharedPtr<Return> JsonArray::GetValueAs(uint32_t Index) const
 {
@@ -50,27 +41,50 @@ inline JsonValue::TSharedPtr<Return> JsonArray::GetValueAs(uint32_t Index) const
 }
 
 template<class Return>
-inline JsonValue::TSharedPtr<Return> JsonObject::GetValueAs(const KeyType& Identifier) const
+inline JsonValue::TSharedPtr<Return> JsonObject::GetValueAs(JsonStringRef Identifier) const
 {
-    using IsBaseOfJsonValue = std::is_base_of<JsonValue, Return>;
-    JSON_STATIC_ASSERT(IsBaseOfJsonValue::value);
-    auto Found = m_Values.find(Identifier);
-    if (Found == m_Values.end())
-        return nullptr;
-   
-    auto Value = Found->second;
-    if (!Value->Is<DefineJson<Return>::Type>())
-        TypeCastErrorMessage(DefineJson<Return>::Type);
-    return std::dynamic_pointer_cast<Return>(Value);
+    return CastValue<Return>(Lookup(Identifier));
+}
+
+template<class Return>
+inline JsonValue::TSharedPtr<Return> JsonObject::GetValueAs(const JsonKey& Identifier) const
+{
+    return CastValue<Return>(Lookup(Identifier));
 }
 
 template<JsonType Type>
-inline bool JsonObject::HasType(const KeyType& Name) const
+inline bool JsonObject::HasType(JsonStringRef Identifier) const
 {
-    auto Found = m_Values.find(Name);
-    if (Found != m_Values.end())
-        return Found->second->Is<Type>();
-    return false;
+    auto Value = Lookup(Identifier);
+    return Value != nullptr && (*Value)->Is<Type>();
+}
+
+template<JsonType Type>
+inline bool JsonObject::HasType(const JsonKey& Identifier) const
+{
+    auto Value = Lookup(Identifier);
+    return Value != nullptr && (*Value)->Is<Type>();
+}
+
+template<class Key>
+inline JsonObject::MappedType* JsonObject::Lookup(const Key& Identifier) const
+{
+    Materialize();
+    auto Found = m_Values.find(Identifier);
+    return Found != m_Values.end() ? &Found->second : nullptr;
+}
+
+template<class Return>
+inline JsonValue::TSharedPtr<Return> JsonObject::CastValue(const MappedType* Value) const
+{
+    using IsBaseOfJsonValue = std::is_base_of<JsonValue, Return>;
+    JSON_STATIC_ASSERT(IsBaseOfJsonValue::value);
+    if (Value == nullptr)
+        return nullptr;
+
+    if (!(*Value)->Is<DefineJson<Return>::Type>())
+        TypeCastErrorMessage(DefineJson<Return>::Type);
+    return std::dynamic_pointer_cast<Return>(*Value);
 }
 
 JSONCPP_NAMESPACE_END
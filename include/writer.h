@@ -1,49 +1,156 @@
 #pragma once
 #include "value.h"
+#include "document.h"
+#include "fragment.h"
+#include "output.h"
+#include <functional>
+#include <vector>
 
 JSONCPP_NAMESPACE_BEGIN
 
-class JSON_API JsonWriter
+// Output formats, picked through the template parameter of the writers' Create
+//
+// Pretty - members on their own lines indented by Indent spaces per level
+// Compact - the minimal RFC 8259 byte sequence, no white space at all
+struct JsonPrettyFormat		{	static constexpr bool Compact = false;	};
+struct JsonCompactFormat	{	static constexpr bool Compact = true;	};
+
+// Class JsonFormatter
+//
+// Layout and escaping settings with the routines that turn values into bytes. Shared by
+// the writers, which serialize whole trees, and JsonEmitter, which streams one call at a time.
+class JSON_API JsonFormatter
 {
 protected:
-	explicit JsonWriter(uint32_t Indent) : m_Indent(Indent) {}
+	explicit JsonFormatter(uint32_t Indent, bool Compact) : m_Indent(Indent), m_Compact(Compact) {}
+	~JsonFormatter() = default;
 
 public:
-	using OStream = std::basic_ostream<char>;
-
-	virtual ~JsonWriter() = default;
-	virtual void Serialize(const JsonValue* Root) const = 0;
+	static constexpr size_t MinParallelElements = 16 * 1024;	// smaller containers are written serially
+
+	uint32_t	GetIndent() const noexcept { return m_Indent; }
+	bool		IsCompact() const noexcept { return m_Compact; }
+
+	// Escape every non-ASCII character as \uXXXX, above the BMP as a surrogate pair.
+	// Otherwise UTF-8 is written as is. Malformed UTF-8 becomes U+FFFD in this mode
+	JsonFormatter&	SetEnsureAscii(bool EnsureAscii) noexcept { m_EnsureAscii = EnsureAscii; return *this; }
+	bool			IsEnsureAscii() const noexcept { return m_EnsureAscii; }
+
+	// A container of at least MinParallelElements is cut into element ranges written on Threads
+	// threads and joined in order, the bytes are those of the serial writer. A smaller root is
+	// followed down to its largest child container. 1 - serial, 0 - one per hardware thread
+	JsonFormatter&	SetThreads(uint32_t Threads) noexcept { m_Threads = Threads; return *this; }
+	uint32_t		GetThreads() const noexcept { return m_Threads; }
+
+	// Keep the bytes of every JsonValue container written and reuse them until a value inside
+	// changes, see JsonFragment. Rewriting costs the containers on the way to the change. The
+	// tree must not be written from two threads nor hold a value in two containers. Modifiers
+	// report changes, a child replaced through a reference from At, operator[], Find or an
+	// iterator is reported with JsonValue::Invalidate on its container
+	JsonFormatter&	SetFragmentCache(bool FragmentCache) noexcept { m_FragmentCache = FragmentCache; return *this; }
+	bool			IsFragmentCache() const noexcept { return m_FragmentCache; }
+
+	// Exact number of bytes the current settings produce for Root, nothing is formatted
+	// except numbers, strings are only scanned
+	size_t	Measure(const JsonValue* Root) const;
+	size_t	Measure(const JsonNode& Root) const;
 
 protected:
-	void	Write(OStream& Stream, const JsonValue* Root, uint32_t Level = 1) const;
+	// Measure with NumberConverter::MaxDoubleLength for every double, which spares the
+	// conversion of their shortest digits. Exact for trees without doubles, and for cached
+	// containers, whose fragments it builds for the Write that follows
+	size_t	MeasureCapacity(const JsonValue* Root) const;
+	size_t	MeasureCapacity(const JsonNode& Root) const;
+
+	// Everything is appended to Out, Level is the nesting depth of Root plus one
+	void	Write(JsonOutputBuffer& Out, const JsonValue* Root, uint32_t Level = 1) const;
+	void	Write(JsonOutputBuffer& Out, const JsonNode& Root, uint32_t Level = 1) const;
+
+	void	WriteNumber(JsonOutputBuffer& Out, const JsonNumeric& Number) const;
+	void	WriteString(JsonOutputBuffer& Out, JsonStringRef String) const;
+	void	WriteIndent(JsonOutputBuffer& Out, uint32_t Level) const;
 
 private:
-	void	WriteHex(OStream& Stream, uint32_t CodePoint) const;
-	void	WriteString(OStream& Stream, const std::string& String) const;
-	void	WriteIndent(OStream& Stream, uint32_t Level) const;
-	void	WriteObject(OStream& Stream, const JsonValue* Root, uint32_t Level) const;
-	void	WriteArray(OStream& Stream, const JsonValue* Root, uint32_t Level) const;
+	using RangeFunction = std::function<void(JsonOutputBuffer& Out, size_t First, size_t Last)>;
+
+	// The format is resolved once per document, the recursion carries no layout branches
+	template<class Format> void	WriteValue(JsonOutputBuffer& Out, const JsonValue* Root, uint32_t Level) const;
+	template<class Format> void	WriteValue(JsonOutputBuffer& Out, const JsonNode& Root, uint32_t Level) const;
+	template<class Format> void	WriteObject(JsonOutputBuffer& Out, const JsonValue* Root, uint32_t Level) const;
+	template<class Format> void	WriteObject(JsonOutputBuffer& Out, const JsonNode& Root, uint32_t Level) const;
+	template<class Format> void	WriteArray(JsonOutputBuffer& Out, const JsonValue* Root, uint32_t Level) const;
+	template<class Format> void	WriteArray(JsonOutputBuffer& Out, const JsonNode& Root, uint32_t Level) const;
+
+	// Members and elements [First, Last) of a container, laid out as at their place in it
+	template<class Format> void	WriteMembers(JsonOutputBuffer& Out, const JsonValue* Root, size_t First, size_t Last, uint32_t Level) const;
+	template<class Format> void	WriteMembers(JsonOutputBuffer& Out, const JsonNode& Root, size_t First, size_t Last, uint32_t Level) const;
+	template<class Format> void	WriteElements(JsonOutputBuffer& Out, const JsonValue* Root, size_t First, size_t Last, uint32_t Level) const;
+	template<class Format> void	WriteElements(JsonOutputBuffer& Out, const JsonNode& Root, size_t First, size_t Last, uint32_t Level) const;
+	template<class Format> void	WriteMemberName(JsonOutputBuffer& Out, JsonStringRef Name, size_t Index, uint32_t Level) const;
+	template<class Format> void	WriteElementSeparator(JsonOutputBuffer& Out, size_t Index) const;
+	template<class Format> void	WriteObjectEnd(JsonOutputBuffer& Out, size_t Size, uint32_t Level) const;
+
+	// Parallel path, Path leads from Root to the container split into ranges
+	uint32_t	ThreadCount() const noexcept;
+	template<class Node> bool	WriteParallel(JsonOutputBuffer& Out, const Node& Root, uint32_t Level) const;
+	template<class Format, class Node> void	WriteSplit(JsonOutputBuffer& Out, const Node& Root, uint32_t Level, const std::vector<size_t>& Path, size_t Depth, uint32_t Threads) const;
+	void		WriteRanges(JsonOutputBuffer& Out, size_t Size, uint32_t Threads, const RangeFunction& Function) const;
+
+	// Cached path, Scratch holds the bytes of the containers being rebuilt
+	std::shared_ptr<const JsonFragment>	CachedFragment(const JsonValue* Root, uint32_t Level) const;
+	template<class Format> std::shared_ptr<const JsonFragment>	CacheFragment(const JsonFragmentTable::Scope& Locked, JsonOutputBuffer& Scratch, const JsonValue* Root, uint32_t Level) const;
+	template<class Format> size_t	CacheChild(const JsonFragmentTable::Scope& Locked, JsonOutputBuffer& Scratch, JsonFragment& Fragment, size_t Start, const std::shared_ptr<JsonFragmentCache>& Node, const JsonValue* Child, uint32_t Level) const;
+
+	void	WriteHex(JsonOutputBuffer& Out, uint32_t CodePoint) const;
+	template<bool EnsureAscii> void	WriteEscaped(JsonOutputBuffer& Out, JsonStringRef String) const;
+
+	// Sizing pass, follows the Write routines above byte for byte
+	template<class Format, bool Bound> size_t	MeasureValue(const JsonValue* Root, uint32_t Level) const;
+	template<class Format, bool Bound> size_t	MeasureValue(const JsonNode& Root, uint32_t Level) const;
+	template<class Format> size_t	MeasureMember(JsonStringRef Name, size_t Index, uint32_t Level) const;
+	template<class Format> size_t	MeasureObjectEnd(size_t Size, uint32_t Level) const;
+	size_t	MeasureString(JsonStringRef String) const;
+	template<bool EnsureAscii> size_t	MeasureEscaped(JsonStringRef String) const;
 
 private:
 	uint32_t m_Indent;
+	bool	 m_Compact;
+	bool	 m_EnsureAscii = false;
+	uint32_t m_Threads = 1;
+	bool	 m_FragmentCache = false;
+};
+
+class JSON_API JsonWriter : public JsonFormatter
+{
+protected:
+	explicit JsonWriter(uint32_t Indent, bool Compact = false) : JsonFormatter(Indent, Compact) {}
+
+public:
+	using OStream = std::basic_ostream<char>;
+
+	virtual ~JsonWriter() = default;
+	virtual void Serialize(const JsonValue* Root) const = 0;
+	virtual void Serialize(const JsonNode& Root) const = 0;
 };
 
 class JSON_API JsonStreamWriter : public JsonWriter
 {
 protected:
-	explicit JsonStreamWriter(OStream* Stream, uint32_t Indent) : m_Stream(Stream), JsonWriter(Indent) {}
+	explicit JsonStreamWriter(OStream* Stream, uint32_t Indent, bool Compact) : m_Stream(Stream), JsonWriter(Indent, Compact) {}
 
 public:
 	using UniquePointer = std::unique_ptr<JsonStreamWriter>;
 	
 	virtual ~JsonStreamWriter() = default;
 
+	template<class Format = JsonPrettyFormat>
 	JSON_NODISCARD static UniquePointer Create(OStream* Stream, uint32_t Indent = 2)
 	{
-		return UniquePointer(new JsonStreamWriter(Stream, Indent));
+		return UniquePointer(new JsonStreamWriter(Stream, Indent, Format::Compact));
 	}
 
 	void Serialize(const JsonValue* Root) const override;
+	void Serialize(const JsonNode& Root) const override;
 
 private:
 	OStream* m_Stream;
@@ -52,22 +159,64 @@ private:
 class JSON_API JsonStringWriter : public JsonWriter
 {
 protected:
-	explicit JsonStringWriter(std::string* OutString, uint32_t Indent) : m_OutString(OutString), JsonWriter(Indent) {}
+	explicit JsonStringWriter(std::string* OutString, uint32_t Indent, bool Compact) : m_OutString(OutString), JsonWriter(Indent, Compact) {}
 
 public:
 	using UniquePointer = std::unique_ptr<JsonStringWriter>;
 
 	virtual ~JsonStringWriter() = default;
 
+	template<class Format = JsonPrettyFormat>
 	JSON_NODISCARD static UniquePointer Create(std::string* OutString, uint32_t Indent = 2)
 	{
-		return UniquePointer(new JsonStringWriter(OutString, Indent));
+		return UniquePointer(new JsonStringWriter(OutString, Indent, Format::Compact));
 	}
 
+	// Size the string once from a measuring pass and write the bytes in place, no buffer in
+	// between. The pass walks the tree a second time, worth it where allocations are expensive
+	JsonStringWriter&	SetPresize(bool Presize) noexcept { m_Presize = Presize; return *this; }
+	bool				IsPresize() const noexcept { return m_Presize; }
+
 	void Serialize(const JsonValue* Root) const override;
+	void Serialize(const JsonNode& Root) const override;
 
 private:
 	std::string* m_OutString;
+	bool		 m_Presize = false;
+};
+
+// Class JsonFileWriter
+//
+// Writes to a file descriptor through a buffer of BufferSize bytes, the descriptor stays
+// owned by the caller and is neither flushed nor closed. With Background the writes run on
+// a separate thread from two aligned buffers of BufferSize, see JsonAsyncFileSink.
+class JSON_API JsonFileWriter : public JsonWriter
+{
+protected:
+	explicit JsonFileWriter(int Descriptor, uint32_t Indent, bool Compact, size_t BufferSize, bool Background)
+		: JsonWriter(Indent, Compact), m_Descriptor(Descriptor), m_BufferSize(BufferSize), m_Background(Background) {}
+
+public:
+	using UniquePointer = std::unique_ptr<JsonFileWriter>;
+
+	virtual ~JsonFileWriter() = default;
+
+	template<class Format = JsonPrettyFormat>
+	JSON_NODISCARD static UniquePointer Create(int Descriptor, uint32_t Indent = 2, size_t BufferSize = 1024 * 1024, bool Background = false)
+	{
+		return UniquePointer(new JsonFileWriter(Descriptor, Indent, Format::Compact, BufferSize, Background));
+	}
+
+	void Serialize(const JsonValue* Root) const override;
+	void Serialize(const JsonNode& Root) const override;
+
+private:
+	std::unique_ptr<JsonOutputSink> CreateSink() const;
+
+private:
+	int		m_Descriptor;
+	size_t	m_BufferSize;
+	bool	m_Background;
 };
 
 class JSON_API JsonWriterFactory
@@ -78,13 +227,15 @@ public:
 	using StringWriterPointer = std::unique_ptr<JsonStringWriter>;
     using StreamWriterPointer = std::unique_ptr<JsonStreamWriter>;
 
+	template<class Format = JsonPrettyFormat>
 	JSON_NODISCARD static StreamWriterPointer Create(OStream* OutStream, int32_t Indent = 2)
 	{
-		return JsonStreamWriter::Create(OutStream, Indent);
+		return JsonStreamWriter::Create<Format>(OutStream, Indent);
 	}
+	template<class Format = JsonPrettyFormat>
 	JSON_NODISCARD static StringWriterPointer Create(String* OutString, int32_t Indent = 2)
 	{
-		return JsonStringWriter::Create(OutString, Indent);
+		return JsonStringWriter::Create<Format>(OutString, Indent);
 	}
 };
 
@@ -92,8 +243,10 @@ struct JSON_API Serializer
 {
 	bool operator()(const JsonValue& Root, JsonWriter& Writer) const;
 	bool operator()(const std::shared_ptr<JsonValue>& Root, JsonWriter& Writer) const;
+	bool operator()(const JsonDocument& Document, JsonWriter& Writer) const;
 };
 
 JSON_API std::ostream& operator<<(std::ostream& Out, const JsonValue& Root);
+JSON_API std::ostream& operator<<(std::ostream& Out, const JsonDocument& Document);
 
 JSONCPP_NAMESPACE_END
\ No newline at end of file
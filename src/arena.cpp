@@ -0,0 +1,123 @@
+#include "arena.h"
+#include "error.h"
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+using namespace JSONCPP_NAMESPACE;
+
+JsonArena::JsonArena(JsonArena&& Other) noexcept
+    : m_Head(Other.m_Head), m_Cursor(Other.m_Cursor), m_End(Other.m_End),
+    m_ChunkSize(Other.m_ChunkSize), m_NextSize(Other.m_NextSize), m_Reserved(Other.m_Reserved)
+{
+    Other.m_Head = nullptr;
+    Other.m_Cursor = Other.m_End = nullptr;
+    Other.m_NextSize = Other.m_Reserved = 0;
+}
+
+JsonArena& JsonArena::operator=(JsonArena&& Other) noexcept
+{
+    if (this != &Other)
+    {
+        Release();
+        std::swap(m_Head, Other.m_Head);
+        std::swap(m_Cursor, Other.m_Cursor);
+        std::swap(m_End, Other.m_End);
+        std::swap(m_ChunkSize, Other.m_ChunkSize);
+        std::swap(m_NextSize, Other.m_NextSize);
+        std::swap(m_Reserved, Other.m_Reserved);
+    }
+    return *this;
+}
+
+const char* JsonArena::CopyString(const char* Src, size_t Length)
+{
+    if (Length == 0)
+        return "";
+    auto Dest = static_cast<char*>(Allocate(Length, 1));
+    std::memcpy(Dest, Src, Length);
+    return Dest;
+}
+
+void JsonArena::Release() noexcept
+{
+    while (m_Head != nullptr)
+    {
+        auto Next = m_Head->Next;
+        std::free(m_Head);
+        m_Head = Next;
+    }
+    m_Cursor = m_End = nullptr;
+    m_NextSize = 0;
+    m_Reserved = 0;
+}
+
+void JsonArena::Reset() noexcept
+{
+    if (m_Head == nullptr)
+        return;
+
+    auto Keep = m_Head;
+    m_Head = m_Head->Next;
+    Release();
+
+    Keep->Next = nullptr;
+    m_Head = Keep;
+    m_Reserved = Keep->Size;
+    m_NextSize = Keep->Size < MaxChunkSize ? Keep->Size * 2 : MaxChunkSize;
+    m_Cursor = reinterpret_cast<char*>(Keep) + sizeof(Chunk);
+    m_End = reinterpret_cast<char*>(Keep) + Keep->Size;
+}
+
+void JsonArena::Adopt(JsonArena& Other) noexcept
+{
+    if (this == &Other || Other.m_Head == nullptr)
+        return;
+    if (m_Head == nullptr)
+    {
+        // Nothing allocated yet, continue in the newest adopted chunk
+        m_Head = Other.m_Head;
+        m_Cursor = Other.m_Cursor;
+        m_End = Other.m_End;
+        m_NextSize = Other.m_NextSize;
+    }
+    else
+    {
+        // Link the adopted chunks behind the current one, allocation continues where it was
+        auto Tail = Other.m_Head;
+        while (Tail->Next != nullptr)
+            Tail = Tail->Next;
+        Tail->Next = m_Head->Next;
+        m_Head->Next = Other.m_Head;
+    }
+    m_Reserved += Other.m_Reserved;
+
+    Other.m_Head = nullptr;
+    Other.m_Cursor = Other.m_End = nullptr;
+    Other.m_NextSize = Other.m_Reserved = 0;
+}
+
+void* JsonArena::AllocateChunk(size_t Size, size_t Alignment)
+{
+    // Chunks double up to MaxChunkSize, oversized requests get a chunk of their own
+    if (m_NextSize == 0)
+        m_NextSize = m_ChunkSize;
+    size_t ChunkSize = m_NextSize;
+    const size_t Header = (sizeof(Chunk) + Alignment - 1) & ~(Alignment - 1);
+    if (ChunkSize < Header + Size)
+        ChunkSize = Header + Size;
+    else if (m_NextSize < MaxChunkSize)
+        m_NextSize *= 2;
+
+    auto NewChunk = static_cast<Chunk*>(std::malloc(ChunkSize));
+    JSON_ASSERT_MESSAGE(NewChunk != nullptr, "Arena out of memory.");
+    NewChunk->Next = m_Head;
+    NewChunk->Size = ChunkSize;
+    m_Head = NewChunk;
+    m_Reserved += ChunkSize;
+
+    auto Address = reinterpret_cast<uintptr_t>(NewChunk) + Header;
+    m_Cursor = reinterpret_cast<char*>(Address + Size);
+    m_End = reinterpret_cast<char*>(NewChunk) + ChunkSize;
+    return reinterpret_cast<void*>(Address);
+}
@@ -0,0 +1,278 @@
+#include "cursor.h"
+#include "reader.h"
+#include "simd.h"
+#include "utils.h"
+#include <limits>
+
+using namespace JSONCPP_NAMESPACE;
+
+JsonCursor::JsonCursor(const char* Data, size_t Length)
+    : m_Last(Data + Length)
+{
+    m_Scanner.Reset(Data, m_Last);
+    Advance();
+}
+
+JsonType JsonCursor::GetType() const
+{
+    switch (*CurrentValue())
+    {
+    case '{': return JsonType::Object;
+    case '[': return JsonType::Array;
+    case '"': return JsonType::String;
+    case 'n': return JsonType::Null;
+    case 't': JSON_FALLTHROUGH;
+    case 'f': return JsonType::Boolean;
+    default:  return IsJsonNumber(*m_Token) ? JsonType::Number : JsonType::Unknown;
+    }
+}
+
+JsonCursor& JsonCursor::FindField(JsonStringRef Name)
+{
+    const bool Found = TryFindField(Name);
+    JSON_ASSERT_MESSAGE(Found, "A member with the name '%s' does not exist.", Name.ToString().c_str());
+    return *this;
+}
+
+bool JsonCursor::TryFindField(JsonStringRef Name)
+{
+    if (m_ValuePending && Peek() == '{')
+    {
+        // Enter the object the cursor stands on
+        m_Scopes.push_back(JsonType::Object);
+        m_ValuePending = false;
+        m_ScopeStart = true;
+        Advance();
+    }
+    else
+    {
+        JSON_ASSERT_MESSAGE(!m_Scopes.empty() && m_Scopes.back() == JsonType::Object, "Cursor is not in an object.");
+        if (m_ValuePending)
+            Skip();
+    }
+
+    while (Peek() != '}')
+    {
+        if (!m_ScopeStart)
+        {
+            JSON_ASSERT_MESSAGE(Peek() == ',', "Comma expected.");
+            Advance();
+        }
+        m_ScopeStart = false;
+
+        JSON_ASSERT_MESSAGE(Peek() == '"', "Member name expected.");
+        const bool Match = MatchKey(Name);
+        Advance();
+        JSON_ASSERT_MESSAGE(Peek() == ':', "Colon expected.");
+        Advance();
+
+        m_ValuePending = true;
+        if (Match)
+            return true;
+        Skip();
+    }
+
+    // Not found, the object is consumed
+    CloseScope();
+    return false;
+}
+
+JsonCursor& JsonCursor::EnterArray()
+{
+    JSON_ASSERT_MESSAGE(*CurrentValue() == '[', "Value is not an array.");
+    m_Scopes.push_back(JsonType::Array);
+    m_ValuePending = false;
+    m_ScopeStart = true;
+    Advance();
+    return *this;
+}
+
+bool JsonCursor::NextElement()
+{
+    JSON_ASSERT_MESSAGE(!m_Scopes.empty() && m_Scopes.back() == JsonType::Array, "Cursor is not in an array.");
+    if (m_ValuePending)
+        Skip();
+
+    if (Peek() == ']')
+    {
+        CloseScope();
+        return false;
+    }
+    if (!m_ScopeStart)
+    {
+        JSON_ASSERT_MESSAGE(Peek() == ',', "Comma expected.");
+        Advance();
+    }
+    m_ScopeStart = false;
+    m_ValuePending = true;
+    return true;
+}
+
+bool JsonCursor::GetBoolean()
+{
+    auto First = CurrentValue();
+    JSON_ASSERT_MESSAGE(IsJsonBoolean(First, m_Last), "Invalid boolean value.");
+    const bool Value = (*First == 't');
+    EndScalar(First + (Value ? 4 : 5));
+    return Value;
+}
+
+JsonNumeric JsonCursor::GetNumeric()
+{
+    JsonNumeric Number;
+    auto First = CurrentValue();
+    auto _Last = IsJsonNumber(*First) ? NumberConverter::Parse(First, m_Last, Number) : nullptr;
+    JSON_ASSERT_MESSAGE(_Last != nullptr, "Invalid number value.");
+    EndScalar(_Last);
+    return Number;
+}
+
+int64_t JsonCursor::GetInt64()
+{
+    auto Number = GetNumeric();
+    JSON_ASSERT_MESSAGE(Number.Type == JsonNumberType::Int64 ||
+        (Number.Type == JsonNumberType::UInt64 && Number.UInt64 <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max())),
+        "Number is not a 64 bit signed integer.");
+    return Number.Int64;
+}
+
+uint64_t JsonCursor::GetUInt64()
+{
+    auto Number = GetNumeric();
+    JSON_ASSERT_MESSAGE(Number.Type == JsonNumberType::UInt64 || (Number.Type == JsonNumberType::Int64 && Number.Int64 >= 0),
+        "Number is not a 64 bit unsigned integer.");
+    return Number.UInt64;
+}
+
+std::string JsonCursor::GetString()
+{
+    auto First = CurrentValue();
+    JSON_ASSERT_MESSAGE(*First == '"', "Value is not a string.");
+    bool Escaped;
+    auto _Last = FindStringEnd(First + 1, Escaped);
+
+    std::string String;
+    if (Escaped)
+        JsonReader::UnescapeString(First + 1, _Last + 1, String);
+    else
+        String.assign(First + 1, _Last);
+    EndScalar(_Last + 1);
+    return String;
+}
+
+JsonStringRef JsonCursor::GetRawString()
+{
+    auto First = CurrentValue();
+    JSON_ASSERT_MESSAGE(*First == '"', "Value is not a string.");
+    bool Escaped;
+    auto _Last = FindStringEnd(First + 1, Escaped);
+    EndScalar(_Last + 1);
+    return JsonStringRef(First + 1, static_cast<size_t>(_Last - First - 1));
+}
+
+JsonCursor& JsonCursor::Skip()
+{
+    auto First = CurrentValue();
+    m_ValuePending = false;
+    if (*First != '{' && *First != '[')
+    {
+        Advance();
+        return *this;
+    }
+
+    // Count brackets up to the matching close
+    uint32_t Depth = 0;
+    do
+    {
+        switch (Peek())
+        {
+        case '{': JSON_FALLTHROUGH;
+        case '[': ++Depth; break;
+        case '}': JSON_FALLTHROUGH;
+        case ']': --Depth; break;
+        default: break;
+        }
+        Advance();
+    } while (Depth > 0);
+    return *this;
+}
+
+JsonCursor& JsonCursor::Leave()
+{
+    JSON_ASSERT_MESSAGE(!m_Scopes.empty(), "Cursor is not in a container.");
+    if (m_ValuePending)
+        Skip();
+
+    uint32_t Depth = 1;
+    while (true)
+    {
+        const char Char = Peek();
+        if (Char == '{' || Char == '[')
+            ++Depth;
+        else if ((Char == '}' || Char == ']') && --Depth == 0)
+            break;
+        Advance();
+    }
+    CloseScope();
+    return *this;
+}
+
+char JsonCursor::Peek() const
+{
+    JSON_ASSERT_MESSAGE(m_Token != m_Last, "Unexpected end of input.");
+    return *m_Token;
+}
+
+const char* JsonCursor::CurrentValue() const
+{
+    JSON_ASSERT_MESSAGE(m_ValuePending, "Cursor does not stand on a value.");
+    Peek();
+    return m_Token;
+}
+
+void JsonCursor::EndScalar(const char* Last)
+{
+    // Scalar must be followed by white space or by the next structural
+    Advance();
+    JSON_ASSERT_MESSAGE(Last == m_Token || IsWhiteSpace(*Last), "Invalid json token.");
+    m_ValuePending = false;
+}
+
+void JsonCursor::CloseScope()
+{
+    const char Close = m_Scopes.back() == JsonType::Object ? '}' : ']';
+    JSON_ASSERT_MESSAGE(Peek() == Close, "Unexpected end of container.");
+    m_Scopes.pop_back();
+    m_ValuePending = false;
+    m_ScopeStart = false;
+    Advance();
+}
+
+const char* JsonCursor::FindStringEnd(const char* First, bool& OutEscaped) const
+{
+    OutEscaped = false;
+    while (true)
+    {
+        First = Simd::FindQuoteOrBackslash(First, m_Last);
+        JSON_ASSERT_MESSAGE(First != m_Last, "Unexpected end of string.");
+        if (*First == '"')
+            return First;
+
+        // Backslash - step over the escaped character
+        OutEscaped = true;
+        JSON_ASSERT_MESSAGE(m_Last - First > 1, "Unexpected end of string.");
+        First += 2;
+    }
+}
+
+bool JsonCursor::MatchKey(JsonStringRef Name)
+{
+    bool Escaped;
+    auto First = m_Token + 1;
+    auto _Last = FindStringEnd(First, Escaped);
+    if (!Escaped)
+        return JsonStringRef(First, static_cast<size_t>(_Last - First)) == Name;
+
+    JsonReader::UnescapeString(First, _Last + 1, m_StringBuffer);
+    return JsonStringRef(m_StringBuffer) == Name;
+}
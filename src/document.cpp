@@ -0,0 +1,327 @@
+#include "document.h"
+#include "value.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+using namespace JSONCPP_NAMESPACE;
+
+namespace {
+    JsonNode::SizeType CheckedSize(size_t Size)
+    {
+        JSON_ASSERT_MESSAGE(Size <= std::numeric_limits<JsonNode::SizeType>::max(), "Value exceeds %u bytes or children.", std::numeric_limits<JsonNode::SizeType>::max());
+        return static_cast<JsonNode::SizeType>(Size);
+    }
+
+    // The lexeme of a Text number moves into the arena with the other strings
+    JsonNumeric StoreNumber(JsonArena& Arena, JsonNumeric Number)
+    {
+        if (Number.Type == JsonNumberType::Text)
+            Number.Text = Arena.CopyString(Number.Text, Number.Length);
+        return Number;
+    }
+
+    JsonNode CopyValue(JsonDocument& Document, const JsonValue& Value)
+    {
+        auto& Arena = Document.GetArena();
+        switch (Value.GetType())
+        {
+        case JsonType::Null:    return JsonNode::MakeNull();
+        case JsonType::Boolean: return JsonNode::MakeBoolean(Value.AsBool());
+        case JsonType::Number:  return JsonNode::MakeNumber(StoreNumber(Arena, static_cast<const JsonNumber&>(Value).GetNumeric()));
+        case JsonType::String:
+        {
+            const auto& String = static_cast<const JsonString&>(Value);
+            return JsonNode::MakeString(Arena.CopyString(String.Data(), String.Size()), CheckedSize(String.Size()));
+        }
+        case JsonType::Array:
+        {
+            const auto& Array = Value.AsArray();
+            auto Size = CheckedSize(Array.size());
+            auto Elements = Arena.Allocate<JsonNode>(Size);
+            for (JsonNode::SizeType Index = 0; Index < Size; ++Index)
+                Elements[Index] = CopyValue(Document, *Array[Index]);
+            return JsonNode::MakeArray(Elements, Size);
+        }
+        case JsonType::Object:
+        {
+            const auto& Object = Value.AsObject();
+            auto Size = CheckedSize(Object.size());
+            auto Members = Arena.Allocate<JsonMember>(Size);
+            auto Member = Members;
+            for (const auto& Pair : Object)
+                *Member++ = JsonMember{ Document.StoreKey(Pair.first), CopyValue(Document, *Pair.second) };
+            return JsonNode::MakeObject(Members, Size);
+        }
+        default:
+            JSON_ASSERT_MESSAGE(false, "Invalid JSON type.");
+            return JsonNode();
+        }
+    }
+}
+
+JsonNode JsonNode::MakeNull() noexcept
+{
+    JsonNode Node;
+    Node.m_Type = static_cast<uint8_t>(JsonType::Null);
+    return Node;
+}
+
+JsonNode JsonNode::MakeBoolean(bool Value) noexcept
+{
+    JsonNode Node;
+    Node.m_Type = static_cast<uint8_t>(JsonType::Boolean);
+    Node.m_Value.Boolean = Value;
+    return Node;
+}
+
+JsonNode JsonNode::MakeNumber(const JsonNumeric& Value) noexcept
+{
+    JsonNode Node;
+    Node.m_Type = static_cast<uint8_t>(JsonType::Number);
+    Node.m_NumberType = static_cast<uint8_t>(Value.Type);
+    Node.m_Value.UInt64 = Value.UInt64;
+    Node.m_Size = Value.Length;
+    return Node;
+}
+
+JsonNode JsonNode::MakeString(const char* Data, SizeType Length) noexcept
+{
+    JsonNode Node;
+    Node.m_Type = static_cast<uint8_t>(JsonType::String);
+    Node.m_Value.Children = Data;
+    Node.m_Size = Length;
+    return Node;
+}
+
+JsonNode JsonNode::MakeArray(const JsonNode* Elements, SizeType Size) noexcept
+{
+    JsonNode Node;
+    Node.m_Type = static_cast<uint8_t>(JsonType::Array);
+    Node.m_Value.Children = Elements;
+    Node.m_Size = Size;
+    return Node;
+}
+
+JsonNode JsonNode::MakeObject(const JsonMember* Members, SizeType Size) noexcept
+{
+    JsonNode Node;
+    Node.m_Type = static_cast<uint8_t>(JsonType::Object);
+    Node.m_Value.Children = Members;
+    Node.m_Size = Size;
+    return Node;
+}
+
+bool JsonNode::GetBoolean() const
+{
+    JSON_ASSERT_MESSAGE(Is<JsonType::Boolean>(), "Node is not a boolean.");
+    return m_Value.Boolean;
+}
+
+JsonNumeric JsonNode::GetNumeric() const
+{
+    JSON_ASSERT_MESSAGE(Is<JsonType::Number>(), "Node is not a number.");
+    JsonNumeric Number;
+    Number.Type = static_cast<JsonNumberType>(m_NumberType);
+    Number.Length = m_Size;
+    Number.UInt64 = m_Value.UInt64;
+    return Number;
+}
+
+JsonStringRef JsonNode::GetString() const
+{
+    JSON_ASSERT_MESSAGE(Is<JsonType::String>(), "Node is not a string.");
+    return JsonStringRef(static_cast<const char*>(m_Value.Children), m_Size);
+}
+
+JsonNode::SizeType JsonNode::Size() const noexcept
+{
+    return (Is<JsonType::Array>() || Is<JsonType::Object>()) ? m_Size : 0;
+}
+
+const JsonNode& JsonNode::At(SizeType Index) const
+{
+    JSON_ASSERT_MESSAGE(Is<JsonType::Array>(), "Node is not an array.");
+    JSON_ASSERT_MESSAGE(Index < m_Size, "Index %u is out of range.", Index);
+    return Begin()[Index];
+}
+
+const JsonNode* JsonNode::Begin() const noexcept
+{
+    return Is<JsonType::Array>() ? static_cast<const JsonNode*>(m_Value.Children) : nullptr;
+}
+
+const JsonNode& JsonNode::At(JsonStringRef Key) const
+{
+    JSON_ASSERT_MESSAGE(Is<JsonType::Object>(), "Node is not an object.");
+    auto Found = Find(Key);
+    JSON_ASSERT_MESSAGE(Found != nullptr, "A member with the name '%s' does not exist.", Key.ToString().c_str());
+    return *Found;
+}
+
+const JsonNode* JsonNode::Find(JsonStringRef Key) const noexcept
+{
+    // Readers reject duplicate names, members are searched in document order
+    for (auto Member = MemberBegin(), Last = MemberEnd(); Member != Last; ++Member)
+    {
+        if (Member->Key == Key)
+            return &Member->Value;
+    }
+    return nullptr;
+}
+
+const JsonMember* JsonNode::MemberBegin() const noexcept
+{
+    return Is<JsonType::Object>() ? static_cast<const JsonMember*>(m_Value.Children) : nullptr;
+}
+
+const JsonMember* JsonNode::MemberEnd() const noexcept
+{
+    return MemberBegin() + Size();
+}
+
+std::shared_ptr<JsonValue> JsonNode::ToValue() const
+{
+    switch (GetType())
+    {
+    case JsonType::Null:    return std::make_shared<JsonNull>();
+    case JsonType::Boolean: return std::make_shared<JsonBoolean>(m_Value.Boolean);
+    case JsonType::Number:  return std::make_shared<JsonNumber>(GetNumeric());
+    case JsonType::String:  return std::make_shared<JsonString>(GetString().Begin(), GetString().End());
+    case JsonType::Array:
+    {
+        auto Array = std::make_shared<JsonArray>();
+        Array->Reserve(m_Size);
+        for (auto Element = Begin(); Element != End(); ++Element)
+            Array->PushBack(Element->ToValue());
+        return Array;
+    }
+    case JsonType::Object:
+    {
+        auto Object = std::make_shared<JsonObject>();
+        auto& Members = Object->AsObject();
+        Members.reserve(m_Size);
+        for (auto Member = MemberBegin(); Member != MemberEnd(); ++Member)
+            Members.Append(Member->Key.ToString(), Member->Value.ToValue());
+        auto Duplicate = Members.Seal();
+        JSON_ASSERT_MESSAGE(Duplicate == nullptr, "A member with the name '%s' already exists.", Duplicate->c_str());
+        return Object;
+    }
+    default:
+        return nullptr;
+    }
+}
+
+JsonStringRef JsonDocument::StoreKey(JsonStringRef Key)
+{
+    if (m_SharedKeys != nullptr)
+    {
+        auto Shared = m_SharedKeys->Find(Key);
+        if (Shared.Data() != nullptr)
+            return Shared;
+    }
+    if (m_InternKeys)
+        return m_Keys.Intern(Key, m_Arena);
+    return JsonStringRef(m_Arena.CopyString(Key.Data(), Key.Size()), Key.Size());
+}
+
+void JsonDocument::Assign(const JsonValue& Root)
+{
+    Clear();
+    m_Root = CopyValue(*this, Root);
+}
+
+void JsonDocumentBuilder::Number(const JsonNumeric& Value)
+{
+    AppendNode(JsonNode::MakeNumber(StoreNumber(m_Document.GetArena(), Value)));
+}
+
+void JsonDocumentBuilder::String(JsonStringRef Value)
+{
+    auto& Arena = m_Document.GetArena();
+    AppendNode(JsonNode::MakeString(Arena.CopyString(Value.Data(), Value.Size()), CheckedSize(Value.Size())));
+}
+
+void JsonDocumentBuilder::Key(JsonStringRef Value)
+{
+    JSON_ASSERT(!m_Scopes.empty() && m_Scopes.back().Type == JsonType::Object);
+    m_Members.push_back(JsonMember{ m_Document.StoreKey(Value), JsonNode() });
+}
+
+void JsonDocumentBuilder::EndObject()
+{
+    JSON_ASSERT(!m_Scopes.empty() && m_Scopes.back().Type == JsonType::Object);
+    const size_t First = m_Scopes.back().First;
+    const auto Size = CheckedSize(m_Members.size() - First);
+    m_Scopes.pop_back();
+    CheckNames(First);
+
+    JsonMember* Members = nullptr;
+    if (Size > 0)
+    {
+        Members = m_Document.GetArena().Allocate<JsonMember>(Size);
+        std::memcpy(static_cast<void*>(Members), m_Members.data() + First, Size * sizeof(JsonMember));
+        m_Members.resize(First);
+    }
+    AppendNode(JsonNode::MakeObject(Members, Size));
+}
+
+void JsonDocumentBuilder::EndArray()
+{
+    JSON_ASSERT(!m_Scopes.empty() && m_Scopes.back().Type == JsonType::Array);
+    const size_t First = m_Scopes.back().First;
+    const auto Size = CheckedSize(m_Elements.size() - First);
+    m_Scopes.pop_back();
+
+    JsonNode* Elements = nullptr;
+    if (Size > 0)
+    {
+        Elements = m_Document.GetArena().Allocate<JsonNode>(Size);
+        std::memcpy(static_cast<void*>(Elements), m_Elements.data() + First, Size * sizeof(JsonNode));
+        m_Elements.resize(First);
+    }
+    AppendNode(JsonNode::MakeArray(Elements, Size));
+}
+
+void JsonDocumentBuilder::CheckNames(size_t First)
+{
+    // Only the members of the closing object, small ones are compared pairwise
+    constexpr size_t PairwiseLimit = 8;
+    const size_t Size = m_Members.size() - First;
+    const JsonStringRef* Twice = nullptr;
+    if (Size <= PairwiseLimit)
+    {
+        for (size_t Index = First + 1; Index < m_Members.size() && Twice == nullptr; ++Index)
+        {
+            for (size_t Other = First; Other < Index; ++Other)
+            {
+                if (m_Members[Other].Key == m_Members[Index].Key)
+                {
+                    Twice = &m_Members[Index].Key;
+                    break;
+                }
+            }
+        }
+    }
+    else
+    {
+        m_Names.clear();
+        for (size_t Index = First; Index < m_Members.size(); ++Index)
+            m_Names.push_back(m_Members[Index].Key);
+        std::sort(m_Names.begin(), m_Names.end());
+        auto Found = std::adjacent_find(m_Names.begin(), m_Names.end());
+        if (Found != m_Names.end())
+            Twice = &*Found;
+    }
+    JSON_ASSERT_MESSAGE(Twice == nullptr, "A member with the name '%.*s' already exists.", static_cast<int>(Twice->Size()), Twice->Data());
+}
+
+void JsonDocumentBuilder::AppendNode(const JsonNode& Node)
+{
+    if (m_Scopes.empty())
+        m_Document.SetRoot(Node);
+    else if (m_Scopes.back().Type == JsonType::Object)
+        m_Members.back().Value = Node;
+    else
+        m_Elements.push_back(Node);
+}
@@ -0,0 +1,156 @@
+#include "emitter.h"
+
+using namespace JSONCPP_NAMESPACE;
+
+constexpr uint32_t JsonEmitter::MaxDepth;
+
+JsonEmitter::JsonEmitter(std::unique_ptr<JsonOutputSink> Sink, uint32_t Indent, bool Compact, size_t BufferSize)
+    : JsonFormatter(Indent, Compact), m_Sink(std::move(Sink)), m_Out(m_Sink.get(), BufferSize)
+{
+}
+
+JsonEmitter::~JsonEmitter()
+{
+    // A destination that fails now has no one left to report to
+    try
+    {
+        m_Out.Flush();
+    }
+    catch (...)
+    {
+    }
+}
+
+JsonEmitter& JsonEmitter::BeginObject()
+{
+    BeginValue();
+    Push(Object);
+    m_Out.Put('{');
+    return *this;
+}
+
+JsonEmitter& JsonEmitter::EndObject()
+{
+    EndContainer(Object, '}');
+    return *this;
+}
+
+JsonEmitter& JsonEmitter::BeginArray()
+{
+    BeginValue();
+    Push(Array);
+    m_Out.Put('[');
+    return *this;
+}
+
+JsonEmitter& JsonEmitter::EndArray()
+{
+    EndContainer(Array, ']');
+    return *this;
+}
+
+JsonEmitter& JsonEmitter::Key(JsonStringRef Name)
+{
+    JSON_ASSERT_MESSAGE(m_Depth > 0 && (m_Stack[m_Depth - 1] & Object) && !m_AfterKey, "Unexpected member name.");
+    auto& Top = m_Stack[m_Depth - 1];
+    if (Top & HasItems)
+        m_Out.Put(',');
+    if (!IsCompact())
+    {
+        m_Out.Put('\n');
+        WriteIndent(m_Out, m_Depth);
+    }
+    WriteString(m_Out, Name);
+    IsCompact() ? m_Out.Put(':') : m_Out.Put(": ", 2);
+
+    Top |= HasItems;
+    m_AfterKey = true;
+    return *this;
+}
+
+JsonEmitter& JsonEmitter::Null()
+{
+    BeginValue();
+    m_Out.Put("null", 4);
+    m_Complete = m_Depth == 0;
+    return *this;
+}
+
+JsonEmitter& JsonEmitter::Value(bool Boolean)
+{
+    BeginValue();
+    Boolean ? m_Out.Put("true", 4) : m_Out.Put("false", 5);
+    m_Complete = m_Depth == 0;
+    return *this;
+}
+
+JsonEmitter& JsonEmitter::Value(const JsonNumeric& Number)
+{
+    BeginValue();
+    WriteNumber(m_Out, Number);
+    m_Complete = m_Depth == 0;
+    return *this;
+}
+
+JsonEmitter& JsonEmitter::Value(JsonStringRef String)
+{
+    BeginValue();
+    WriteString(m_Out, String);
+    m_Complete = m_Depth == 0;
+    return *this;
+}
+
+JsonEmitter& JsonEmitter::Value(const JsonValue& Root)
+{
+    BeginValue();
+    Write(m_Out, &Root, m_Depth + 1);
+    m_Complete = m_Depth == 0;
+    return *this;
+}
+
+JsonEmitter& JsonEmitter::Value(const JsonNode& Root)
+{
+    BeginValue();
+    Write(m_Out, Root, m_Depth + 1);
+    m_Complete = m_Depth == 0;
+    return *this;
+}
+
+void JsonEmitter::BeginValue()
+{
+    JSON_ASSERT_MESSAGE(!m_Complete, "The root value is already complete.");
+    if (m_Depth == 0)
+        return;
+
+    auto& Top = m_Stack[m_Depth - 1];
+    if (Top & Object)
+    {
+        JSON_ASSERT_MESSAGE(m_AfterKey, "Member name expected.");
+        m_AfterKey = false;
+        return;
+    }
+    if (Top & HasItems)
+        IsCompact() ? m_Out.Put(',') : m_Out.Put(", ", 2);
+    Top |= HasItems;
+}
+
+void JsonEmitter::Push(Frame Type)
+{
+    JSON_ASSERT_MESSAGE(m_Depth < MaxDepth, "Nesting exceeds %u levels.", MaxDepth);
+    m_Stack[m_Depth++] = Type;
+}
+
+void JsonEmitter::EndContainer(Frame Type, char Close)
+{
+    JSON_ASSERT_MESSAGE(m_Depth > 0 && (m_Stack[m_Depth - 1] & Object) == Type && !m_AfterKey,
+        "Unexpected end of %s.", Type == Object ? "object" : "array");
+
+    const auto Top = m_Stack[--m_Depth];
+    if (Type == Object && !IsCompact() && (Top & HasItems))
+    {
+        m_Out.Put('\n');
+        WriteIndent(m_Out, m_Depth);
+    }
+    m_Out.Put(Close);
+    m_Complete = m_Depth == 0;
+}
@@ -0,0 +1,92 @@
+#include "fragment.h"
+#include "value.h"
+#include <mutex>
+#include <vector>
+
+using namespace JSONCPP_NAMESPACE;
+
+namespace {
+    struct FragmentTable
+    {
+        std::mutex                                      Mutex;
+        std::vector<std::shared_ptr<JsonFragmentCache>> Records{ 1 };    // slot 0 stands for none
+        std::vector<uint32_t>                           Free;
+    };
+
+    // Never destroyed, values of static storage may still leave it at exit
+    FragmentTable& GetTable()
+    {
+        static FragmentTable* Table = new FragmentTable();
+        return *Table;
+    }
+
+    // The record a value names, or null for a slot freed since
+    JsonFragmentCache* Lookup(const FragmentTable& Table, uint32_t Slot) noexcept
+    {
+        return Slot < Table.Records.size() ? Table.Records[Slot].get() : nullptr;
+    }
+}
+
+JsonFragmentTable::Scope::Scope() : m_Lock(GetTable().Mutex)
+{
+}
+
+std::shared_ptr<JsonFragmentCache> JsonFragmentTable::Own(const Scope&, const JsonValue* Value)
+{
+    auto& Table = GetTable();
+    const auto Found = Lookup(Table, Value->m_Link);
+    if (Found != nullptr && Found->Owner == Value)
+        return Table.Records[Value->m_Link];
+
+    uint32_t Slot;
+    if (!Table.Free.empty())
+    {
+        Slot = Table.Free.back();
+        Table.Free.pop_back();
+    }
+    else
+    {
+        // Slots are 31 bits wide, the top bit of the word is JsonValue::m_Lazy
+        JSON_ASSERT_MESSAGE(Table.Records.size() < (1u << 31), "Fragment cache holds too many containers.");
+        Slot = static_cast<uint32_t>(Table.Records.size());
+        Table.Records.emplace_back();
+    }
+    Table.Records[Slot] = std::make_shared<JsonFragmentCache>(Value);
+    Value->m_Link = Slot;
+    return Table.Records[Slot];
+}
+
+void JsonFragmentTable::Attach(const Scope& Locked, const JsonValue* Child, const std::shared_ptr<JsonFragmentCache>& Parent, bool Container)
+{
+    if (Container)
+        Own(Locked, Child)->Parent = Parent;
+    else
+        Child->m_Link = Parent->Owner->m_Link;
+}
+
+void JsonFragmentTable::Drop(const JsonValue* Value) noexcept
+{
+    auto& Table = GetTable();
+    std::lock_guard<std::mutex> Lock(Table.Mutex);
+    const auto Found = Lookup(Table, Value->m_Link);
+    if (Found == nullptr || !Found->Fragment)
+        return;
+
+    // A dropped record has no cached ancestors left, each was rebuilt after its children
+    Found->Fragment.reset();
+    for (auto Node = Found->Parent.lock(); Node && Node->Fragment; Node = Node->Parent.lock())
+        Node->Fragment.reset();
+}
+
+void JsonFragmentTable::Forget(const JsonValue* Value) noexcept
+{
+    auto& Table = GetTable();
+    std::lock_guard<std::mutex> Lock(Table.Mutex);
+    const auto Found = Lookup(Table, Value->m_Link);
+    if (Found == nullptr || Found->Owner != Value)
+        return;
+
+    // Children may outlive the container, their records lose it as parent
+    Table.Records[Value->m_Link].reset();
+    Table.Free.push_back(Value->m_Link);
+}
@@ -0,0 +1,67 @@
+#include "keytable.h"
+#include "error.h"
+#include <limits>
+
+using namespace JSONCPP_NAMESPACE;
+
+JsonStringRef JsonKeyTable::Intern(JsonStringRef Key, JsonArena& Storage)
+{
+    JSON_ASSERT_MESSAGE(Key.Size() <= std::numeric_limits<uint32_t>::max(), "Member name exceeds %u bytes.", std::numeric_limits<uint32_t>::max());
+    if ((m_Count + 1) * 2 > m_Slots.size())
+        Grow();
+
+    const uint32_t KeyHash = Key.Hash();
+    Slot& Found = m_Slots[Probe(Key, KeyHash)];
+    if (Found.Data == nullptr)
+    {
+        Found = Slot{ Storage.CopyString(Key.Data(), Key.Size()), static_cast<uint32_t>(Key.Size()), KeyHash };
+        ++m_Count;
+    }
+    return JsonStringRef(Found.Data, Found.Length);
+}
+
+JsonStringRef JsonKeyTable::Find(JsonStringRef Key) const noexcept
+{
+    if (m_Count == 0)
+        return JsonStringRef();
+    const Slot& Found = m_Slots[Probe(Key, Key.Hash())];
+    return JsonStringRef(Found.Data, Found.Length);
+}
+
+void JsonKeyTable::Clear() noexcept
+{
+    for (auto& Entry : m_Slots)
+        Entry = Slot{ nullptr, 0, 0 };
+    m_Count = 0;
+}
+
+size_t JsonKeyTable::Probe(JsonStringRef Key, uint32_t KeyHash) const noexcept
+{
+    // Linear probing, stops at the matching name or at the first free slot
+    const size_t Mask = m_Slots.size() - 1;
+    for (size_t Index = KeyHash & Mask;; Index = (Index + 1) & Mask)
+    {
+        const Slot& Entry = m_Slots[Index];
+        if (Entry.Data == nullptr)
+            return Index;
+        if (Entry.Hash == KeyHash && JsonStringRef(Entry.Data, Entry.Length) == Key)
+            return Index;
+    }
+}
+
+void JsonKeyTable::Grow()
+{
+    std::vector<Slot> Slots(m_Slots.empty() ? 64 : m_Slots.size() * 2, Slot{ nullptr, 0, 0 });
+    m_Slots.swap(Slots);
+
+    const size_t Mask = m_Slots.size() - 1;
+    for (const auto& Entry : Slots)
+    {
+        if (Entry.Data == nullptr)
+            continue;
+        size_t Index = Entry.Hash & Mask;
+        while (m_Slots[Index].Data != nullptr)
+            Index = (Index + 1) & Mask;
+        m_Slots[Index] = Entry;
+    }
+}
@@ -0,0 +1,246 @@
+#include "lazy.h"
+#include "utils.h"
+#include <cstring>
+#include <limits>
+
+using namespace JSONCPP_NAMESPACE;
+
+namespace {
+    // Containers of a lazy document - an eager container with the position of its text on
+    // the tape, the flag in JsonValue tells the accessors to load it on first use
+    struct JsonLazySource
+    {
+        std::shared_ptr<const JsonLazyTape> Tape;
+        uint32_t                            Index;
+    };
+
+    template<class Container>
+    class JsonLazyContainer final : public Container
+    {
+    public:
+        explicit JsonLazyContainer(JsonLazySource&& InSource) noexcept : Source(std::move(InSource))  {   this->m_Lazy = 1;   }
+
+        mutable JsonLazySource  Source;
+    };
+
+    using JsonLazyArray     = JsonLazyContainer<JsonArray>;
+    using JsonLazyObject    = JsonLazyContainer<JsonObject>;
+}
+
+JsonLazyTape::JsonLazyTape(const char* Data, size_t Length)
+    : m_First(Data), m_Last(Data + Length)
+{
+    Build();
+}
+
+JsonLazyTape::JsonLazyTape(std::string&& Content)
+    : m_Content(std::move(Content))
+{
+    m_First = m_Content.data();
+    m_Last = m_First + m_Content.size();
+    Build();
+}
+
+std::shared_ptr<JsonValue> JsonLazyTape::GetRoot() const
+{
+    uint32_t Entry = 0;
+    return LoadValue(Entry);
+}
+
+void JsonLazyTape::Build()
+{
+    JSON_ASSERT_MESSAGE(static_cast<size_t>(m_Last - m_First) < std::numeric_limits<uint32_t>::max(), "Input is too large for a lazy document.");
+
+    // Roughly one token per eight bytes in typical documents
+    m_Tape.reserve(static_cast<size_t>(m_Last - m_First) / 8);
+
+    // Entries of the containers still open
+    std::vector<uint32_t> Open;
+    JsonStructuralScanner Scanner(m_First, m_Last);
+    for (auto _Token = Scanner.Next(); _Token != m_Last; _Token = Scanner.Next())
+    {
+        JSON_ASSERT_MESSAGE(!m_Tape.empty() || *_Token == '{' || *_Token == '[', "Object or array begin expected.");
+        JSON_ASSERT_MESSAGE(m_Tape.empty() || !Open.empty(), "End of file expected.");
+        JSON_ASSERT_MESSAGE(m_Tape.size() < std::numeric_limits<uint32_t>::max(), "Input is too large for a lazy document.");
+
+        const auto Entry = static_cast<uint32_t>(m_Tape.size());
+        m_Tape.push_back(static_cast<uint64_t>(_Token - m_First));
+        switch (*_Token)
+        {
+        case '{':  JSON_FALLTHROUGH;
+        case '[':
+            Open.push_back(Entry);
+            break;
+        case '}':  JSON_FALLTHROUGH;
+        case ']':
+        {
+            JSON_ASSERT_MESSAGE(!Open.empty(), "Unexpected end of container.");
+            const char Begin = *Token(Open.back());
+            JSON_ASSERT_MESSAGE((Begin == '{') == (*_Token == '}'), "Unexpected end of container.");
+            m_Tape[Open.back()] |= static_cast<uint64_t>(Entry) << 32;
+            Open.pop_back();
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    JSON_ASSERT_MESSAGE(!m_Tape.empty() && Open.empty(), "Unexpected end of file.");
+}
+
+void JsonLazyTape::LoadArray(uint32_t Index, JsonArray::ContainerType& OutArray) const
+{
+    const uint32_t End = Close(Index);
+    for (uint32_t Entry = Index + 1; Entry != End;)
+    {
+        OutArray.push_back(LoadValue(Entry));
+        if (Entry == End)
+            break;
+        JSON_ASSERT_MESSAGE(*Token(Entry) == ',', "Comma expected.");
+        JSON_ASSERT_MESSAGE(++Entry != End, "Array end unexpected.");
+    }
+}
+
+void JsonLazyTape::LoadObject(uint32_t Index, JsonObject::ContainerType& OutObject) const
+{
+    const uint32_t End = Close(Index);
+    std::string Identifier;
+    for (uint32_t Entry = Index + 1; Entry != End;)
+    {
+        JSON_ASSERT_MESSAGE(*Token(Entry) == '"', "Member name expected.");
+        LoadString(Entry++, Identifier);
+        JSON_ASSERT_MESSAGE(*Token(Entry) == ':', "Colon expected.");
+        auto Value = LoadValue(++Entry);
+
+        OutObject.Append(std::move(Identifier), std::move(Value));
+
+        if (Entry == End)
+            break;
+        JSON_ASSERT_MESSAGE(*Token(Entry) == ',', "Comma expected.");
+        JSON_ASSERT_MESSAGE(++Entry != End, "Object end unexpected.");
+    }
+    auto Duplicate = OutObject.Seal();
+    JSON_ASSERT_MESSAGE(Duplicate == nullptr, "A member with the name '%s' already exists.", Duplicate->c_str());
+}
+
+std::shared_ptr<JsonValue> JsonLazyTape::LoadValue(uint32_t& Entry) const
+{
+    const char* First = Token(Entry);
+    switch (*First)
+    {
+    case '[':
+    {
+        // Nested containers are parsed when they are accessed themselves
+        auto Array = std::make_shared<JsonLazyArray>(JsonLazySource{ shared_from_this(), Entry });
+        Entry = Close(Entry) + 1;
+        return Array;
+    }
+    case '{':
+    {
+        auto Object = std::make_shared<JsonLazyObject>(JsonLazySource{ shared_from_this(), Entry });
+        Entry = Close(Entry) + 1;
+        return Object;
+    }
+    case '"':
+    {
+        std::string String;
+        LoadString(Entry++, String);
+        return std::make_shared<JsonString>(std::move(String));
+    }
+    case 'n':
+        JSON_ASSERT_MESSAGE(IsJsonNull(First, m_Last), "Invalid null value.");
+        EndScalar(First + 4, Entry);
+        return std::make_shared<JsonNull>();
+    case 't':  JSON_FALLTHROUGH;
+    case 'f':
+    {
+        JSON_ASSERT_MESSAGE(IsJsonBoolean(First, m_Last), "Invalid boolean value.");
+        const bool Value = (*First == 't');
+        EndScalar(First + (Value ? 4 : 5), Entry);
+        return std::make_shared<JsonBoolean>(Value);
+    }
+    default:
+    {
+        JsonNumeric Number;
+        auto _Last = IsJsonNumber(*First) ? NumberConverter::Parse(First, m_Last, Number) : nullptr;
+        JSON_ASSERT_MESSAGE(_Last != nullptr, "Invalid number value.");
+        EndScalar(_Last, Entry);
+        return std::make_shared<JsonNumber>(Number);
+    }
+    }
+}
+
+void JsonLazyTape::LoadString(uint32_t Entry, std::string& OutString) const
+{
+    // Only white space separates the closing quote from the next token
+    const char* First = Token(Entry) + 1;
+    const char* Last = Token(Entry + 1);
+    do
+    {
+        --Last;
+    } while (IsWhiteSpace(*Last));
+    JSON_ASSERT_MESSAGE(*Last == '"' && Last >= First, "Unexpected end of string.");
+
+    if (std::memchr(First, '\\', static_cast<size_t>(Last - First)) != nullptr)
+        JsonReader::UnescapeString(First, Last + 1, OutString);
+    else
+        OutString.assign(First, Last);
+}
+
+void JsonLazyTape::EndScalar(const char* Last, uint32_t& Entry) const
+{
+    // Scalar must be followed by white space or by the next token
+    ++Entry;
+    JSON_ASSERT_MESSAGE(Last == Token(Entry) || IsWhiteSpace(*Last), "Invalid json token.");
+}
+
+// Containers of a lazy document are filled from the tape on first access
+void JsonArray::Load() const
+{
+    const auto& Source = static_cast<const JsonLazyArray*>(this)->Source;
+    ContainerType Array;
+    Source.Tape->LoadArray(Source.Index, Array);
+    m_Array = std::move(Array);
+    Release();
+}
+
+void JsonArray::Release() const noexcept
+{
+    static_cast<const JsonLazyArray*>(this)->Source.Tape.reset();
+    m_Lazy = 0;
+}
+
+void JsonObject::Load() const
+{
+    const auto& Source = static_cast<const JsonLazyObject*>(this)->Source;
+    ContainerType Values;
+    Source.Tape->LoadObject(Source.Index, Values);
+    m_Values = std::move(Values);
+    Release();
+}
+
+void JsonObject::Release() const noexcept
+{
+    static_cast<const JsonLazyObject*>(this)->Source.Tape.reset();
+    m_Lazy = 0;
+}
+
+bool JsonLazyReader::Deserialize(std::shared_ptr<JsonValue>& Root)
+{
+    if (m_Tape == nullptr)
+        m_Tape = m_Owned ? std::make_shared<JsonLazyTape>(std::move(m_Content)) : std::make_shared<JsonLazyTape>(m_Data, m_Length);
+    Root = m_Tape->GetRoot();
+    return true;
+}
+
+bool JsonLazyReader::Deserialize(JsonDocument& Document)
+{
+    if (m_Tape != nullptr)
+    {
+        const auto Text = m_Tape->Text();
+        return ParseDocument(Text.Begin(), Text.End(), Document);
+    }
+    const char* First = m_Owned ? m_Content.data() : m_Data;
+    const size_t Length = m_Owned ? m_Content.size() : m_Length;
+    return ParseDocument(First, First + Length, Document);
+}
@@ -0,0 +1,284 @@
+#include "lines.h"
+#include "utils.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+using namespace JSONCPP_NAMESPACE;
+
+enum class BatchState : uint32_t
+{
+    Free,
+    Parsing,
+    Ready,
+};
+
+struct JsonLinesReader::Batch
+{
+    Batch() : Builder(Document) {}
+
+    JsonDocument        Document;       // root array holding the records of the batch
+    JsonDocumentBuilder Builder;
+    std::string         Text;           // streamed input only
+    const char*         First       = nullptr;
+    const char*         Last        = nullptr;
+    uint64_t            Sequence    = 0;
+    BatchState          State       = BatchState::Free;
+    std::exception_ptr  Error;
+};
+
+JsonLinesReader::JsonLinesReader(const char* Data, size_t Length, const JsonLinesOptions& Options)
+    : m_Options(Options), m_Cursor(Data), m_Last(Data + Length)
+{
+}
+
+JsonLinesReader::JsonLinesReader(std::basic_istream<char>& IStream, const JsonLinesOptions& Options)
+    : m_Options(Options), m_Stream(&IStream)
+{
+}
+
+JsonLinesReader::JsonLinesReader(const std::string& Path, const JsonLinesOptions& Options)
+    : m_Options(Options), m_File(JsonMappedFileReader::Create(Path))
+{
+    m_Cursor = m_File->Data();
+    m_Last = m_Cursor + m_File->Size();
+}
+
+JsonLinesReader::~JsonLinesReader() = default;
+
+size_t JsonLinesReader::Read(const RecordCallback& Callback)
+{
+    const uint32_t Threads = m_Options.Threads > 0 ? m_Options.Threads : std::max(1U, std::thread::hardware_concurrency());
+
+    // Two batches per worker, one being parsed while the other waits for delivery
+    std::vector<std::unique_ptr<Batch>> Batches(Threads * 2);
+    for (auto& Work : Batches)
+    {
+        Work.reset(new Batch());
+        Work->Document.SetKeyInterning(m_Options.InternKeys);
+    }
+
+    std::mutex              Mutex;
+    std::condition_variable WorkerWake;
+    std::condition_variable ResultReady;
+    uint64_t                Scheduled   = 0;
+    uint64_t                Delivered   = 0;
+    bool                    Exhausted   = false;
+    bool                    Stopped     = false;
+
+    const bool Ordered = (m_Options.Delivery == JsonLinesOrder::Ordered);
+    const size_t Slots = Batches.size();
+
+    auto FreeBatch = [&]() -> Batch* {
+        if (Ordered)
+        {
+            auto& Work = Batches[Scheduled % Slots];
+            return Work->State == BatchState::Free ? Work.get() : nullptr;
+        }
+        for (auto& Work : Batches)
+        {
+            if (Work->State == BatchState::Free)
+                return Work.get();
+        }
+        return nullptr;
+    };
+
+    auto ReadyBatch = [&]() -> Batch* {
+        if (Ordered)
+        {
+            auto& Work = Batches[Delivered % Slots];
+            return (Work->State == BatchState::Ready && Work->Sequence == Delivered) ? Work.get() : nullptr;
+        }
+        for (auto& Work : Batches)
+        {
+            if (Work->State == BatchState::Ready)
+                return Work.get();
+        }
+        return nullptr;
+    };
+
+    auto Worker = [&]() {
+        // Reader state is per thread and reused for every batch
+        auto Reader = JsonBufferReader::Create(nullptr, 0);
+        while (true)
+        {
+            Batch* Work = nullptr;
+            {
+                std::unique_lock<std::mutex> Lock(Mutex);
+                WorkerWake.wait(Lock, [&]() { return Stopped || Exhausted || FreeBatch() != nullptr; });
+                if (Stopped || Exhausted)
+                    return;
+
+                Work = FreeBatch();
+                bool Found = false;
+                try
+                {
+                    Found = NextBatch(*Work);
+                }
+                catch (...)
+                {
+                    Work->Error = std::current_exception();
+                    Found = true;
+                }
+                if (!Found)
+                {
+                    Exhausted = true;
+                    WorkerWake.notify_all();
+                    ResultReady.notify_all();
+                    return;
+                }
+                Work->Sequence = Scheduled++;
+                Work->State = BatchState::Parsing;
+            }
+
+            if (!Work->Error)
+            {
+                try
+                {
+                    ParseBatch(*Reader, *Work);
+                }
+                catch (...)
+                {
+                    Work->Error = std::current_exception();
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> Lock(Mutex);
+                Work->State = BatchState::Ready;
+            }
+            ResultReady.notify_all();
+        }
+    };
+
+    std::vector<std::thread> Pool;
+    Pool.reserve(Threads);
+    for (uint32_t Index = 0; Index < Threads; ++Index)
+        Pool.emplace_back(Worker);
+
+    // Workers are stopped and joined on every exit path, including a throwing callback
+    struct PoolGuard
+    {
+        ~PoolGuard()
+        {
+            {
+                std::lock_guard<std::mutex> Lock(Mutex);
+                Stopped = true;
+            }
+            WorkerWake.notify_all();
+            for (auto& Thread : Pool)
+                Thread.join();
+        }
+
+        std::mutex&                 Mutex;
+        std::condition_variable&    WorkerWake;
+        bool&                       Stopped;
+        std::vector<std::thread>&   Pool;
+    } Guard{ Mutex, WorkerWake, Stopped, Pool };
+
+    size_t Records = 0;
+    while (true)
+    {
+        Batch* Work = nullptr;
+        {
+            std::unique_lock<std::mutex> Lock(Mutex);
+            ResultReady.wait(Lock, [&]() { return ReadyBatch() != nullptr || (Exhausted && Delivered == Scheduled); });
+            Work = ReadyBatch();
+            if (Work == nullptr)
+                break;
+        }
+
+        if (Work->Error)
+            std::rethrow_exception(Work->Error);
+
+        const auto& Root = Work->Document.GetRoot();
+        for (auto Record = Root.Begin(); Record != Root.End(); ++Record)
+            Callback(*Record);
+        Records += Root.Size();
+
+        {
+            std::lock_guard<std::mutex> Lock(Mutex);
+            Work->State = BatchState::Free;
+            ++Delivered;
+        }
+        WorkerWake.notify_all();
+    }
+    return Records;
+}
+
+bool JsonLinesReader::NextBatch(Batch& Work)
+{
+    const size_t BatchSize = std::max<size_t>(m_Options.BatchSize, 1);
+
+    if (m_Stream == nullptr)
+    {
+        if (m_Cursor == m_Last)
+            return false;
+
+        // Cut at the first newline after BatchSize bytes
+        auto Cut = m_Cursor + std::min(BatchSize, static_cast<size_t>(m_Last - m_Cursor));
+        if (Cut != m_Last)
+        {
+            auto NewLine = static_cast<const char*>(std::memchr(Cut, '\n', static_cast<size_t>(m_Last - Cut)));
+            Cut = NewLine ? NewLine + 1 : m_Last;
+        }
+        Work.First = m_Cursor;
+        Work.Last = Cut;
+        m_Cursor = Cut;
+        return true;
+    }
+
+    // Streamed input - read a batch and carry the unfinished last line over
+    Work.Text.swap(m_Carry);
+    m_Carry.clear();
+    while (true)
+    {
+        const size_t Offset = Work.Text.size();
+        Work.Text.resize(Offset + BatchSize);
+        m_Stream->read(&Work.Text[Offset], static_cast<std::streamsize>(BatchSize));
+        const size_t Count = static_cast<size_t>(m_Stream->gcount());
+        Work.Text.resize(Offset + Count);
+        if (Count == 0)
+            break;
+
+        auto NewLine = Work.Text.rfind('\n');
+        if (NewLine != std::string::npos && NewLine >= Offset)
+        {
+            m_Carry.assign(Work.Text, NewLine + 1, std::string::npos);
+            Work.Text.resize(NewLine + 1);
+            break;
+        }
+    }
+    if (Work.Text.empty())
+        return false;
+
+    Work.First = Work.Text.data();
+    Work.Last = Work.First + Work.Text.size();
+    return true;
+}
+
+void JsonLinesReader::ParseBatch(JsonReader& Reader, Batch& Work) const
+{
+    Work.Document.Reset();
+    Work.Builder.Reset();
+
+    // Every line is a document of its own, they become the elements of one root array
+    Work.Builder.StartArray();
+    for (auto First = Work.First; First != Work.Last;)
+    {
+        auto NewLine = static_cast<const char*>(std::memchr(First, '\n', static_cast<size_t>(Work.Last - First)));
+        auto Last = NewLine ? NewLine : Work.Last;
+
+        auto Token = First;
+        while (Token != Last && IsWhiteSpace(*Token))
+            ++Token;
+        if (Token != Last)
+            Reader.Parse(Token, Last, Work.Builder);
+
+        First = NewLine ? NewLine + 1 : Work.Last;
+    }
+    Work.Builder.EndArray();
+}
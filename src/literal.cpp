@@ -90,7 +90,7 @@ std::basic_string<wchar_t> Literal::operator""_utfw(const char32_t* Source, size
 
 std::shared_ptr<JsonValue> Literal::operator""_json(const char* Src, size_t Length)
 {
-	auto Reader = JsonReaderFactory::Create(std::string(Src, Length));
+	auto Reader = JsonReaderFactory::Create(Src, Length);
 	std::shared_ptr<JsonValue> Doc;
 	Reader->Deserialize(Doc);
 	return Doc;
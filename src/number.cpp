@@ -0,0 +1,1555 @@
+#include "number.h"
+#include "utils.h"
+#include "simd.h"
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <locale>
+#include <sstream>
+
+using namespace JSONCPP_NAMESPACE;
+
+namespace {
+    struct UInt128
+    {
+        uint64_t Low;
+        uint64_t High;
+    };
+
+#if defined(__SIZEOF_INT128__)
+    // __extension__ keeps -Wpedantic quiet about the compiler's own 128 bit type
+    __extension__ typedef unsigned __int128 NativeUInt128;
+#endif // __SIZEOF_INT128__
+
+    inline UInt128 Multiply(uint64_t Lhs, uint64_t Rhs) noexcept
+    {
+#if defined(__SIZEOF_INT128__)
+        const NativeUInt128 Product = static_cast<NativeUInt128>(Lhs) * Rhs;
+        return UInt128{ static_cast<uint64_t>(Product), static_cast<uint64_t>(Product >> 64) };
+#elif defined(_MSC_VER) && defined(_M_X64)
+        UInt128 Product;
+        Product.Low = _umul128(Lhs, Rhs, &Product.High);
+        return Product;
+#else
+        const uint64_t LhsLow = Lhs & 0xFFFFFFFFU, LhsHigh = Lhs >> 32;
+        const uint64_t RhsLow = Rhs & 0xFFFFFFFFU, RhsHigh = Rhs >> 32;
+        const uint64_t LowLow = LhsLow * RhsLow;
+        const uint64_t HighLow = LhsHigh * RhsLow + (LowLow >> 32);
+        const uint64_t LowHigh = LhsLow * RhsHigh + (HighLow & 0xFFFFFFFFU);
+        return UInt128{ (LowHigh << 32) | (LowLow & 0xFFFFFFFFU), LhsHigh * RhsHigh + (HighLow >> 32) + (LowHigh >> 32) };
+#endif
+    }
+
+    // Truncated 128 bit approximations of 5^Q for Q in [-342, 308], most significant bit set
+    constexpr int32_t SmallestPowerOfFive = -342;
+    constexpr int32_t LargestPowerOfFive = 308;
+    const uint64_t PowerOfFive128[] = {
+        0xeef453d6923bd65aULL, 0x113faa2906a13b3fULL,
+        0x9558b4661b6565f8ULL, 0x4ac7ca59a424c507ULL,
+        0xbaaee17fa23ebf76ULL, 0x5d79bcf00d2df649ULL,
+        0xe95a99df8ace6f53ULL, 0xf4d82c2c107973dcULL,
+        0x91d8a02bb6c10594ULL, 0x79071b9b8a4be869ULL,
+        0xb64ec836a47146f9ULL, 0x9748e2826cdee284ULL,
+        0xe3e27a444d8d98b7ULL, 0xfd1b1b2308169b25ULL,
+        0x8e6d8c6ab0787f72ULL, 0xfe30f0f5e50e20f7ULL,
+        0xb208ef855c969f4fULL, 0xbdbd2d335e51a935ULL,
+        0xde8b2b66b3bc4723ULL, 0xad2c788035e61382ULL,
+        0x8b16fb203055ac76ULL, 0x4c3bcb5021afcc31ULL,
+        0xaddcb9e83c6b1793ULL, 0xdf4abe242a1bbf3dULL,
+        0xd953e8624b85dd78ULL, 0xd71d6dad34a2af0dULL,
+        0x87d4713d6f33aa6bULL, 0x8672648c40e5ad68ULL,
+        0xa9c98d8ccb009506ULL, 0x680efdaf511f18c2ULL,
+        0xd43bf0effdc0ba48ULL, 0x0212bd1b2566def2ULL,
+        0x84a57695fe98746dULL, 0x014bb630f7604b57ULL,
+        0xa5ced43b7e3e9188ULL, 0x419ea3bd35385e2dULL,
+        0xcf42894a5dce35eaULL, 0x52064cac828675b9ULL,
+        0x818995ce7aa0e1b2ULL, 0x7343efebd1940993ULL,
+        0xa1ebfb4219491a1fULL, 0x1014ebe6c5f90bf8ULL,
+        0xca66fa129f9b60a6ULL, 0xd41a26e077774ef6ULL,
+        0xfd00b897478238d0ULL, 0x8920b098955522b4ULL,
+        0x9e20735e8cb16382ULL, 0x55b46e5f5d5535b0ULL,
+        0xc5a890362fddbc62ULL, 0xeb2189f734aa831dULL,
+        0xf712b443bbd52b7bULL, 0xa5e9ec7501d523e4ULL,
+        0x9a6bb0aa55653b2dULL, 0x47b233c92125366eULL,
+        0xc1069cd4eabe89f8ULL, 0x999ec0bb696e840aULL,
+        0xf148440a256e2c76ULL, 0xc00670ea43ca250dULL,
+        0x96cd2a865764dbcaULL, 0x380406926a5e5728ULL,
+        0xbc807527ed3e12bcULL, 0xc605083704f5ecf2ULL,
+        0xeba09271e88d976bULL, 0xf7864a44c633682eULL,
+        0x93445b8731587ea3ULL, 0x7ab3ee6afbe0211dULL,
+        0xb8157268fdae9e4cULL, 0x5960ea05bad82964ULL,
+        0xe61acf033d1a45dfULL, 0x6fb92487298e33bdULL,
+        0x8fd0c16206306babULL, 0xa5d3b6d479f8e056ULL,
+        0xb3c4f1ba87bc8696ULL, 0x8f48a4899877186cULL,
+        0xe0b62e2929aba83cULL, 0x331acdabfe94de87ULL,
+        0x8c71dcd9ba0b4925ULL, 0x9ff0c08b7f1d0b14ULL,
+        0xaf8e5410288e1b6fULL, 0x07ecf0ae5ee44dd9ULL,
+        0xdb71e91432b1a24aULL, 0xc9e82cd9f69d6150ULL,
+        0x892731ac9faf056eULL, 0xbe311c083a225cd2ULL,
+        0xab70fe17c79ac6caULL, 0x6dbd630a48aaf406ULL,
+        0xd64d3d9db981787dULL, 0x092cbbccdad5b108ULL,
+        0x85f0468293f0eb4eULL, 0x25bbf56008c58ea5ULL,
+        0xa76c582338ed2621ULL, 0xaf2af2b80af6f24eULL,
+        0xd1476e2c07286faaULL, 0x1af5af660db4aee1ULL,
+        0x82cca4db847945caULL, 0x50d98d9fc890ed4dULL,
+        0xa37fce126597973cULL, 0xe50ff107bab528a0ULL,
+        0xcc5fc196fefd7d0cULL, 0x1e53ed49a96272c8ULL,
+        0xff77b1fcbebcdc4fULL, 0x25e8e89c13bb0f7aULL,
+        0x9faacf3df73609b1ULL, 0x77b191618c54e9acULL,
+        0xc795830d75038c1dULL, 0xd59df5b9ef6a2417ULL,
+        0xf97ae3d0d2446f25ULL, 0x4b0573286b44ad1dULL,
+        0x9becce62836ac577ULL, 0x4ee367f9430aec32ULL,
+        0xc2e801fb244576d5ULL, 0x229c41f793cda73fULL,
+        0xf3a20279ed56d48aULL, 0x6b43527578c1110fULL,
+        0x9845418c345644d6ULL, 0x830a13896b78aaa9ULL,
+        0xbe5691ef416bd60cULL, 0x23cc986bc656d553ULL,
+        0xedec366b11c6cb8fULL, 0x2cbfbe86b7ec8aa8ULL,
+        0x94b3a202eb1c3f39ULL, 0x7bf7d71432f3d6a9ULL,
+        0xb9e08a83a5e34f07ULL, 0xdaf5ccd93fb0cc53ULL,
+        0xe858ad248f5c22c9ULL, 0xd1b3400f8f9cff68ULL,
+        0x91376c36d99995beULL, 0x23100809b9c21fa1ULL,
+        0xb58547448ffffb2dULL, 0xabd40a0c2832a78aULL,
+        0xe2e69915b3fff9f9ULL, 0x16c90c8f323f516cULL,
+        0x8dd01fad907ffc3bULL, 0xae3da7d97f6792e3ULL,
+        0xb1442798f49ffb4aULL, 0x99cd11cfdf41779cULL,
+        0xdd95317f31c7fa1dULL, 0x40405643d711d583ULL,
+        0x8a7d3eef7f1cfc52ULL, 0x482835ea666b2572ULL,
+        0xad1c8eab5ee43b66ULL, 0xda3243650005eecfULL,
+        0xd863b256369d4a40ULL, 0x90bed43e40076a82ULL,
+        0x873e4f75e2224e68ULL, 0x5a7744a6e804a291ULL,
+        0xa90de3535aaae202ULL, 0x711515d0a205cb36ULL,
+        0xd3515c2831559a83ULL, 0x0d5a5b44ca873e03ULL,
+        0x8412d9991ed58091ULL, 0xe858790afe9486c2ULL,
+        0xa5178fff668ae0b6ULL, 0x626e974dbe39a872ULL,
+        0xce5d73ff402d98e3ULL, 0xfb0a3d212dc8128fULL,
+        0x80fa687f881c7f8eULL, 0x7ce66634bc9d0b99ULL,
+        0xa139029f6a239f72ULL, 0x1c1fffc1ebc44e80ULL,
+        0xc987434744ac874eULL, 0xa327ffb266b56220ULL,
+        0xfbe9141915d7a922ULL, 0x4bf1ff9f0062baa8ULL,
+        0x9d71ac8fada6c9b5ULL, 0x6f773fc3603db4a9ULL,
+        0xc4ce17b399107c22ULL, 0xcb550fb4384d21d3ULL,
+        0xf6019da07f549b2bULL, 0x7e2a53a146606a48ULL,
+        0x99c102844f94e0fbULL, 0x2eda7444cbfc426dULL,
+        0xc0314325637a1939ULL, 0xfa911155fefb5308ULL,
+        0xf03d93eebc589f88ULL, 0x793555ab7eba27caULL,
+        0x96267c7535b763b5ULL, 0x4bc1558b2f3458deULL,
+        0xbbb01b9283253ca2ULL, 0x9eb1aaedfb016f16ULL,
+        0xea9c227723ee8bcbULL, 0x465e15a979c1cadcULL,
+        0x92a1958a7675175fULL, 0x0bfacd89ec191ec9ULL,
+        0xb749faed14125d36ULL, 0xcef980ec671f667bULL,
+        0xe51c79a85916f484ULL, 0x82b7e12780e7401aULL,
+        0x8f31cc0937ae58d2ULL, 0xd1b2ecb8b0908810ULL,
+        0xb2fe3f0b8599ef07ULL, 0x861fa7e6dcb4aa15ULL,
+        0xdfbdcece67006ac9ULL, 0x67a791e093e1d49aULL,
+        0x8bd6a141006042bdULL, 0xe0c8bb2c5c6d24e0ULL,
+        0xaecc49914078536dULL, 0x58fae9f773886e18ULL,
+        0xda7f5bf590966848ULL, 0xaf39a475506a899eULL,
+        0x888f99797a5e012dULL, 0x6d8406c952429603ULL,
+        0xaab37fd7d8f58178ULL, 0xc8e5087ba6d33b83ULL,
+        0xd5605fcdcf32e1d6ULL, 0xfb1e4a9a90880a64ULL,
+        0x855c3be0a17fcd26ULL, 0x5cf2eea09a55067fULL,
+        0xa6b34ad8c9dfc06fULL, 0xf42faa48c0ea481eULL,
+        0xd0601d8efc57b08bULL, 0xf13b94daf124da26ULL,
+        0x823c12795db6ce57ULL, 0x76c53d08d6b70858ULL,
+        0xa2cb1717b52481edULL, 0x54768c4b0c64ca6eULL,
+        0xcb7ddcdda26da268ULL, 0xa9942f5dcf7dfd09ULL,
+        0xfe5d54150b090b02ULL, 0xd3f93b35435d7c4cULL,
+        0x9efa548d26e5a6e1ULL, 0xc47bc5014a1a6dafULL,
+        0xc6b8e9b0709f109aULL, 0x359ab6419ca1091bULL,
+        0xf867241c8cc6d4c0ULL, 0xc30163d203c94b62ULL,
+        0x9b407691d7fc44f8ULL, 0x79e0de63425dcf1dULL,
+        0xc21094364dfb5636ULL, 0x985915fc12f542e4ULL,
+        0xf294b943e17a2bc4ULL, 0x3e6f5b7b17b2939dULL,
+        0x979cf3ca6cec5b5aULL, 0xa705992ceecf9c42ULL,
+        0xbd8430bd08277231ULL, 0x50c6ff782a838353ULL,
+        0xece53cec4a314ebdULL, 0xa4f8bf5635246428ULL,
+        0x940f4613ae5ed136ULL, 0x871b7795e136be99ULL,
+        0xb913179899f68584ULL, 0x28e2557b59846e3fULL,
+        0xe757dd7ec07426e5ULL, 0x331aeada2fe589cfULL,
+        0x9096ea6f3848984fULL, 0x3ff0d2c85def7621ULL,
+        0xb4bca50b065abe63ULL, 0x0fed077a756b53a9ULL,
+        0xe1ebce4dc7f16dfbULL, 0xd3e8495912c62894ULL,
+        0x8d3360f09cf6e4bdULL, 0x64712dd7abbbd95cULL,
+        0xb080392cc4349decULL, 0xbd8d794d96aacfb3ULL,
+        0xdca04777f541c567ULL, 0xecf0d7a0fc5583a0ULL,
+        0x89e42caaf9491b60ULL, 0xf41686c49db57244ULL,
+        0xac5d37d5b79b6239ULL, 0x311c2875c522ced5ULL,
+        0xd77485cb25823ac7ULL, 0x7d633293366b828bULL,
+        0x86a8d39ef77164bcULL, 0xae5dff9c02033197ULL,
+        0xa8530886b54dbdebULL, 0xd9f57f830283fdfcULL,
+        0xd267caa862a12d66ULL, 0xd072df63c324fd7bULL,
+        0x8380dea93da4bc60ULL, 0x4247cb9e59f71e6dULL,
+        0xa46116538d0deb78ULL, 0x52d9be85f074e608ULL,
+        0xcd795be870516656ULL, 0x67902e276c921f8bULL,
+        0x806bd9714632dff6ULL, 0x00ba1cd8a3db53b6ULL,
+        0xa086cfcd97bf97f3ULL, 0x80e8a40eccd228a4ULL,
+        0xc8a883c0fdaf7df0ULL, 0x6122cd128006b2cdULL,
+        0xfad2a4b13d1b5d6cULL, 0x796b805720085f81ULL,
+        0x9cc3a6eec6311a63ULL, 0xcbe3303674053bb0ULL,
+        0xc3f490aa77bd60fcULL, 0xbedbfc4411068a9cULL,
+        0xf4f1b4d515acb93bULL, 0xee92fb5515482d44ULL,
+        0x991711052d8bf3c5ULL, 0x751bdd152d4d1c4aULL,
+        0xbf5cd54678eef0b6ULL, 0xd262d45a78a0635dULL,
+        0xef340a98172aace4ULL, 0x86fb897116c87c34ULL,
+        0x9580869f0e7aac0eULL, 0xd45d35e6ae3d4da0ULL,
+        0xbae0a846d2195712ULL, 0x8974836059cca109ULL,
+        0xe998d258869facd7ULL, 0x2bd1a438703fc94bULL,
+        0x91ff83775423cc06ULL, 0x7b6306a34627ddcfULL,
+        0xb67f6455292cbf08ULL, 0x1a3bc84c17b1d542ULL,
+        0xe41f3d6a7377eecaULL, 0x20caba5f1d9e4a93ULL,
+        0x8e938662882af53eULL, 0x547eb47b7282ee9cULL,
+        0xb23867fb2a35b28dULL, 0xe99e619a4f23aa43ULL,
+        0xdec681f9f4c31f31ULL, 0x6405fa00e2ec94d4ULL,
+        0x8b3c113c38f9f37eULL, 0xde83bc408dd3dd04ULL,
+        0xae0b158b4738705eULL, 0x9624ab50b148d445ULL,
+        0xd98ddaee19068c76ULL, 0x3badd624dd9b0957ULL,
+        0x87f8a8d4cfa417c9ULL, 0xe54ca5d70a80e5d6ULL,
+        0xa9f6d30a038d1dbcULL, 0x5e9fcf4ccd211f4cULL,
+        0xd47487cc8470652bULL, 0x7647c3200069671fULL,
+        0x84c8d4dfd2c63f3bULL, 0x29ecd9f40041e073ULL,
+        0xa5fb0a17c777cf09ULL, 0xf468107100525890ULL,
+        0xcf79cc9db955c2ccULL, 0x7182148d4066eeb4ULL,
+        0x81ac1fe293d599bfULL, 0xc6f14cd848405530ULL,
+        0xa21727db38cb002fULL, 0xb8ada00e5a506a7cULL,
+        0xca9cf1d206fdc03bULL, 0xa6d90811f0e4851cULL,
+        0xfd442e4688bd304aULL, 0x908f4a166d1da663ULL,
+        0x9e4a9cec15763e2eULL, 0x9a598e4e043287feULL,
+        0xc5dd44271ad3cdbaULL, 0x40eff1e1853f29fdULL,
+        0xf7549530e188c128ULL, 0xd12bee59e68ef47cULL,
+        0x9a94dd3e8cf578b9ULL, 0x82bb74f8301958ceULL,
+        0xc13a148e3032d6e7ULL, 0xe36a52363c1faf01ULL,
+        0xf18899b1bc3f8ca1ULL, 0xdc44e6c3cb279ac1ULL,
+        0x96f5600f15a7b7e5ULL, 0x29ab103a5ef8c0b9ULL,
+        0xbcb2b812db11a5deULL, 0x7415d448f6b6f0e7ULL,
+        0xebdf661791d60f56ULL, 0x111b495b3464ad21ULL,
+        0x936b9fcebb25c995ULL, 0xcab10dd900beec34ULL,
+        0xb84687c269ef3bfbULL, 0x3d5d514f40eea742ULL,
+        0xe65829b3046b0afaULL, 0x0cb4a5a3112a5112ULL,
+        0x8ff71a0fe2c2e6dcULL, 0x47f0e785eaba72abULL,
+        0xb3f4e093db73a093ULL, 0x59ed216765690f56ULL,
+        0xe0f218b8d25088b8ULL, 0x306869c13ec3532cULL,
+        0x8c974f7383725573ULL, 0x1e414218c73a13fbULL,
+        0xafbd2350644eeacfULL, 0xe5d1929ef90898faULL,
+        0xdbac6c247d62a583ULL, 0xdf45f746b74abf39ULL,
+        0x894bc396ce5da772ULL, 0x6b8bba8c328eb783ULL,
+        0xab9eb47c81f5114fULL, 0x066ea92f3f326564ULL,
+        0xd686619ba27255a2ULL, 0xc80a537b0efefebdULL,
+        0x8613fd0145877585ULL, 0xbd06742ce95f5f36ULL,
+        0xa798fc4196e952e7ULL, 0x2c48113823b73704ULL,
+        0xd17f3b51fca3a7a0ULL, 0xf75a15862ca504c5ULL,
+        0x82ef85133de648c4ULL, 0x9a984d73dbe722fbULL,
+        0xa3ab66580d5fdaf5ULL, 0xc13e60d0d2e0ebbaULL,
+        0xcc963fee10b7d1b3ULL, 0x318df905079926a8ULL,
+        0xffbbcfe994e5c61fULL, 0xfdf17746497f7052ULL,
+        0x9fd561f1fd0f9bd3ULL, 0xfeb6ea8bedefa633ULL,
+        0xc7caba6e7c5382c8ULL, 0xfe64a52ee96b8fc0ULL,
+        0xf9bd690a1b68637bULL, 0x3dfdce7aa3c673b0ULL,
+        0x9c1661a651213e2dULL, 0x06bea10ca65c084eULL,
+        0xc31bfa0fe5698db8ULL, 0x486e494fcff30a62ULL,
+        0xf3e2f893dec3f126ULL, 0x5a89dba3c3efccfaULL,
+        0x986ddb5c6b3a76b7ULL, 0xf89629465a75e01cULL,
+        0xbe89523386091465ULL, 0xf6bbb397f1135823ULL,
+        0xee2ba6c0678b597fULL, 0x746aa07ded582e2cULL,
+        0x94db483840b717efULL, 0xa8c2a44eb4571cdcULL,
+        0xba121a4650e4ddebULL, 0x92f34d62616ce413ULL,
+        0xe896a0d7e51e1566ULL, 0x77b020baf9c81d17ULL,
+        0x915e2486ef32cd60ULL, 0x0ace1474dc1d122eULL,
+        0xb5b5ada8aaff80b8ULL, 0x0d819992132456baULL,
+        0xe3231912d5bf60e6ULL, 0x10e1fff697ed6c69ULL,
+        0x8df5efabc5979c8fULL, 0xca8d3ffa1ef463c1ULL,
+        0xb1736b96b6fd83b3ULL, 0xbd308ff8a6b17cb2ULL,
+        0xddd0467c64bce4a0ULL, 0xac7cb3f6d05ddbdeULL,
+        0x8aa22c0dbef60ee4ULL, 0x6bcdf07a423aa96bULL,
+        0xad4ab7112eb3929dULL, 0x86c16c98d2c953c6ULL,
+        0xd89d64d57a607744ULL, 0xe871c7bf077ba8b7ULL,
+        0x87625f056c7c4a8bULL, 0x11471cd764ad4972ULL,
+        0xa93af6c6c79b5d2dULL, 0xd598e40d3dd89bcfULL,
+        0xd389b47879823479ULL, 0x4aff1d108d4ec2c3ULL,
+        0x843610cb4bf160cbULL, 0xcedf722a585139baULL,
+        0xa54394fe1eedb8feULL, 0xc2974eb4ee658828ULL,
+        0xce947a3da6a9273eULL, 0x733d226229feea32ULL,
+        0x811ccc668829b887ULL, 0x0806357d5a3f525fULL,
+        0xa163ff802a3426a8ULL, 0xca07c2dcb0cf26f7ULL,
+        0xc9bcff6034c13052ULL, 0xfc89b393dd02f0b5ULL,
+        0xfc2c3f3841f17c67ULL, 0xbbac2078d443ace2ULL,
+        0x9d9ba7832936edc0ULL, 0xd54b944b84aa4c0dULL,
+        0xc5029163f384a931ULL, 0x0a9e795e65d4df11ULL,
+        0xf64335bcf065d37dULL, 0x4d4617b5ff4a16d5ULL,
+        0x99ea0196163fa42eULL, 0x504bced1bf8e4e45ULL,
+        0xc06481fb9bcf8d39ULL, 0xe45ec2862f71e1d6ULL,
+        0xf07da27a82c37088ULL, 0x5d767327bb4e5a4cULL,
+        0x964e858c91ba2655ULL, 0x3a6a07f8d510f86fULL,
+        0xbbe226efb628afeaULL, 0x890489f70a55368bULL,
+        0xeadab0aba3b2dbe5ULL, 0x2b45ac74ccea842eULL,
+        0x92c8ae6b464fc96fULL, 0x3b0b8bc90012929dULL,
+        0xb77ada0617e3bbcbULL, 0x09ce6ebb40173744ULL,
+        0xe55990879ddcaabdULL, 0xcc420a6a101d0515ULL,
+        0x8f57fa54c2a9eab6ULL, 0x9fa946824a12232dULL,
+        0xb32df8e9f3546564ULL, 0x47939822dc96abf9ULL,
+        0xdff9772470297ebdULL, 0x59787e2b93bc56f7ULL,
+        0x8bfbea76c619ef36ULL, 0x57eb4edb3c55b65aULL,
+        0xaefae51477a06b03ULL, 0xede622920b6b23f1ULL,
+        0xdab99e59958885c4ULL, 0xe95fab368e45ecedULL,
+        0x88b402f7fd75539bULL, 0x11dbcb0218ebb414ULL,
+        0xaae103b5fcd2a881ULL, 0xd652bdc29f26a119ULL,
+        0xd59944a37c0752a2ULL, 0x4be76d3346f0495fULL,
+        0x857fcae62d8493a5ULL, 0x6f70a4400c562ddbULL,
+        0xa6dfbd9fb8e5b88eULL, 0xcb4ccd500f6bb952ULL,
+        0xd097ad07a71f26b2ULL, 0x7e2000a41346a7a7ULL,
+        0x825ecc24c873782fULL, 0x8ed400668c0c28c8ULL,
+        0xa2f67f2dfa90563bULL, 0x728900802f0f32faULL,
+        0xcbb41ef979346bcaULL, 0x4f2b40a03ad2ffb9ULL,
+        0xfea126b7d78186bcULL, 0xe2f610c84987bfa8ULL,
+        0x9f24b832e6b0f436ULL, 0x0dd9ca7d2df4d7c9ULL,
+        0xc6ede63fa05d3143ULL, 0x91503d1c79720dbbULL,
+        0xf8a95fcf88747d94ULL, 0x75a44c6397ce912aULL,
+        0x9b69dbe1b548ce7cULL, 0xc986afbe3ee11abaULL,
+        0xc24452da229b021bULL, 0xfbe85badce996168ULL,
+        0xf2d56790ab41c2a2ULL, 0xfae27299423fb9c3ULL,
+        0x97c560ba6b0919a5ULL, 0xdccd879fc967d41aULL,
+        0xbdb6b8e905cb600fULL, 0x5400e987bbc1c920ULL,
+        0xed246723473e3813ULL, 0x290123e9aab23b68ULL,
+        0x9436c0760c86e30bULL, 0xf9a0b6720aaf6521ULL,
+        0xb94470938fa89bceULL, 0xf808e40e8d5b3e69ULL,
+        0xe7958cb87392c2c2ULL, 0xb60b1d1230b20e04ULL,
+        0x90bd77f3483bb9b9ULL, 0xb1c6f22b5e6f48c2ULL,
+        0xb4ecd5f01a4aa828ULL, 0x1e38aeb6360b1af3ULL,
+        0xe2280b6c20dd5232ULL, 0x25c6da63c38de1b0ULL,
+        0x8d590723948a535fULL, 0x579c487e5a38ad0eULL,
+        0xb0af48ec79ace837ULL, 0x2d835a9df0c6d851ULL,
+        0xdcdb1b2798182244ULL, 0xf8e431456cf88e65ULL,
+        0x8a08f0f8bf0f156bULL, 0x1b8e9ecb641b58ffULL,
+        0xac8b2d36eed2dac5ULL, 0xe272467e3d222f3fULL,
+        0xd7adf884aa879177ULL, 0x5b0ed81dcc6abb0fULL,
+        0x86ccbb52ea94baeaULL, 0x98e947129fc2b4e9ULL,
+        0xa87fea27a539e9a5ULL, 0x3f2398d747b36224ULL,
+        0xd29fe4b18e88640eULL, 0x8eec7f0d19a03aadULL,
+        0x83a3eeeef9153e89ULL, 0x1953cf68300424acULL,
+        0xa48ceaaab75a8e2bULL, 0x5fa8c3423c052dd7ULL,
+        0xcdb02555653131b6ULL, 0x3792f412cb06794dULL,
+        0x808e17555f3ebf11ULL, 0xe2bbd88bbee40bd0ULL,
+        0xa0b19d2ab70e6ed6ULL, 0x5b6aceaeae9d0ec4ULL,
+        0xc8de047564d20a8bULL, 0xf245825a5a445275ULL,
+        0xfb158592be068d2eULL, 0xeed6e2f0f0d56712ULL,
+        0x9ced737bb6c4183dULL, 0x55464dd69685606bULL,
+        0xc428d05aa4751e4cULL, 0xaa97e14c3c26b886ULL,
+        0xf53304714d9265dfULL, 0xd53dd99f4b3066a8ULL,
+        0x993fe2c6d07b7fabULL, 0xe546a8038efe4029ULL,
+        0xbf8fdb78849a5f96ULL, 0xde98520472bdd033ULL,
+        0xef73d256a5c0f77cULL, 0x963e66858f6d4440ULL,
+        0x95a8637627989aadULL, 0xdde7001379a44aa8ULL,
+        0xbb127c53b17ec159ULL, 0x5560c018580d5d52ULL,
+        0xe9d71b689dde71afULL, 0xaab8f01e6e10b4a6ULL,
+        0x9226712162ab070dULL, 0xcab3961304ca70e8ULL,
+        0xb6b00d69bb55c8d1ULL, 0x3d607b97c5fd0d22ULL,
+        0xe45c10c42a2b3b05ULL, 0x8cb89a7db77c506aULL,
+        0x8eb98a7a9a5b04e3ULL, 0x77f3608e92adb242ULL,
+        0xb267ed1940f1c61cULL, 0x55f038b237591ed3ULL,
+        0xdf01e85f912e37a3ULL, 0x6b6c46dec52f6688ULL,
+        0x8b61313bbabce2c6ULL, 0x2323ac4b3b3da015ULL,
+        0xae397d8aa96c1b77ULL, 0xabec975e0a0d081aULL,
+        0xd9c7dced53c72255ULL, 0x96e7bd358c904a21ULL,
+        0x881cea14545c7575ULL, 0x7e50d64177da2e54ULL,
+        0xaa242499697392d2ULL, 0xdde50bd1d5d0b9e9ULL,
+        0xd4ad2dbfc3d07787ULL, 0x955e4ec64b44e864ULL,
+        0x84ec3c97da624ab4ULL, 0xbd5af13bef0b113eULL,
+        0xa6274bbdd0fadd61ULL, 0xecb1ad8aeacdd58eULL,
+        0xcfb11ead453994baULL, 0x67de18eda5814af2ULL,
+        0x81ceb32c4b43fcf4ULL, 0x80eacf948770ced7ULL,
+        0xa2425ff75e14fc31ULL, 0xa1258379a94d028dULL,
+        0xcad2f7f5359a3b3eULL, 0x096ee45813a04330ULL,
+        0xfd87b5f28300ca0dULL, 0x8bca9d6e188853fcULL,
+        0x9e74d1b791e07e48ULL, 0x775ea264cf55347eULL,
+        0xc612062576589ddaULL, 0x95364afe032a819eULL,
+        0xf79687aed3eec551ULL, 0x3a83ddbd83f52205ULL,
+        0x9abe14cd44753b52ULL, 0xc4926a9672793543ULL,
+        0xc16d9a0095928a27ULL, 0x75b7053c0f178294ULL,
+        0xf1c90080baf72cb1ULL, 0x5324c68b12dd6339ULL,
+        0x971da05074da7beeULL, 0xd3f6fc16ebca5e04ULL,
+        0xbce5086492111aeaULL, 0x88f4bb1ca6bcf585ULL,
+        0xec1e4a7db69561a5ULL, 0x2b31e9e3d06c32e6ULL,
+        0x9392ee8e921d5d07ULL, 0x3aff322e62439fd0ULL,
+        0xb877aa3236a4b449ULL, 0x09befeb9fad487c3ULL,
+        0xe69594bec44de15bULL, 0x4c2ebe687989a9b4ULL,
+        0x901d7cf73ab0acd9ULL, 0x0f9d37014bf60a11ULL,
+        0xb424dc35095cd80fULL, 0x538484c19ef38c95ULL,
+        0xe12e13424bb40e13ULL, 0x2865a5f206b06fbaULL,
+        0x8cbccc096f5088cbULL, 0xf93f87b7442e45d4ULL,
+        0xafebff0bcb24aafeULL, 0xf78f69a51539d749ULL,
+        0xdbe6fecebdedd5beULL, 0xb573440e5a884d1cULL,
+        0x89705f4136b4a597ULL, 0x31680a88f8953031ULL,
+        0xabcc77118461cefcULL, 0xfdc20d2b36ba7c3eULL,
+        0xd6bf94d5e57a42bcULL, 0x3d32907604691b4dULL,
+        0x8637bd05af6c69b5ULL, 0xa63f9a49c2c1b110ULL,
+        0xa7c5ac471b478423ULL, 0x0fcf80dc33721d54ULL,
+        0xd1b71758e219652bULL, 0xd3c36113404ea4a9ULL,
+        0x83126e978d4fdf3bULL, 0x645a1cac083126eaULL,
+        0xa3d70a3d70a3d70aULL, 0x3d70a3d70a3d70a4ULL,
+        0xccccccccccccccccULL, 0xcccccccccccccccdULL,
+        0x8000000000000000ULL, 0x0000000000000000ULL,
+        0xa000000000000000ULL, 0x0000000000000000ULL,
+        0xc800000000000000ULL, 0x0000000000000000ULL,
+        0xfa00000000000000ULL, 0x0000000000000000ULL,
+        0x9c40000000000000ULL, 0x0000000000000000ULL,
+        0xc350000000000000ULL, 0x0000000000000000ULL,
+        0xf424000000000000ULL, 0x0000000000000000ULL,
+        0x9896800000000000ULL, 0x0000000000000000ULL,
+        0xbebc200000000000ULL, 0x0000000000000000ULL,
+        0xee6b280000000000ULL, 0x0000000000000000ULL,
+        0x9502f90000000000ULL, 0x0000000000000000ULL,
+        0xba43b74000000000ULL, 0x0000000000000000ULL,
+        0xe8d4a51000000000ULL, 0x0000000000000000ULL,
+        0x9184e72a00000000ULL, 0x0000000000000000ULL,
+        0xb5e620f480000000ULL, 0x0000000000000000ULL,
+        0xe35fa931a0000000ULL, 0x0000000000000000ULL,
+        0x8e1bc9bf04000000ULL, 0x0000000000000000ULL,
+        0xb1a2bc2ec5000000ULL, 0x0000000000000000ULL,
+        0xde0b6b3a76400000ULL, 0x0000000000000000ULL,
+        0x8ac7230489e80000ULL, 0x0000000000000000ULL,
+        0xad78ebc5ac620000ULL, 0x0000000000000000ULL,
+        0xd8d726b7177a8000ULL, 0x0000000000000000ULL,
+        0x878678326eac9000ULL, 0x0000000000000000ULL,
+        0xa968163f0a57b400ULL, 0x0000000000000000ULL,
+        0xd3c21bcecceda100ULL, 0x0000000000000000ULL,
+        0x84595161401484a0ULL, 0x0000000000000000ULL,
+        0xa56fa5b99019a5c8ULL, 0x0000000000000000ULL,
+        0xcecb8f27f4200f3aULL, 0x0000000000000000ULL,
+        0x813f3978f8940984ULL, 0x4000000000000000ULL,
+        0xa18f07d736b90be5ULL, 0x5000000000000000ULL,
+        0xc9f2c9cd04674edeULL, 0xa400000000000000ULL,
+        0xfc6f7c4045812296ULL, 0x4d00000000000000ULL,
+        0x9dc5ada82b70b59dULL, 0xf020000000000000ULL,
+        0xc5371912364ce305ULL, 0x6c28000000000000ULL,
+        0xf684df56c3e01bc6ULL, 0xc732000000000000ULL,
+        0x9a130b963a6c115cULL, 0x3c7f400000000000ULL,
+        0xc097ce7bc90715b3ULL, 0x4b9f100000000000ULL,
+        0xf0bdc21abb48db20ULL, 0x1e86d40000000000ULL,
+        0x96769950b50d88f4ULL, 0x1314448000000000ULL,
+        0xbc143fa4e250eb31ULL, 0x17d955a000000000ULL,
+        0xeb194f8e1ae525fdULL, 0x5dcfab0800000000ULL,
+        0x92efd1b8d0cf37beULL, 0x5aa1cae500000000ULL,
+        0xb7abc627050305adULL, 0xf14a3d9e40000000ULL,
+        0xe596b7b0c643c719ULL, 0x6d9ccd05d0000000ULL,
+        0x8f7e32ce7bea5c6fULL, 0xe4820023a2000000ULL,
+        0xb35dbf821ae4f38bULL, 0xdda2802c8a800000ULL,
+        0xe0352f62a19e306eULL, 0xd50b2037ad200000ULL,
+        0x8c213d9da502de45ULL, 0x4526f422cc340000ULL,
+        0xaf298d050e4395d6ULL, 0x9670b12b7f410000ULL,
+        0xdaf3f04651d47b4cULL, 0x3c0cdd765f114000ULL,
+        0x88d8762bf324cd0fULL, 0xa5880a69fb6ac800ULL,
+        0xab0e93b6efee0053ULL, 0x8eea0d047a457a00ULL,
+        0xd5d238a4abe98068ULL, 0x72a4904598d6d880ULL,
+        0x85a36366eb71f041ULL, 0x47a6da2b7f864750ULL,
+        0xa70c3c40a64e6c51ULL, 0x999090b65f67d924ULL,
+        0xd0cf4b50cfe20765ULL, 0xfff4b4e3f741cf6dULL,
+        0x82818f1281ed449fULL, 0xbff8f10e7a8921a4ULL,
+        0xa321f2d7226895c7ULL, 0xaff72d52192b6a0dULL,
+        0xcbea6f8ceb02bb39ULL, 0x9bf4f8a69f764490ULL,
+        0xfee50b7025c36a08ULL, 0x02f236d04753d5b4ULL,
+        0x9f4f2726179a2245ULL, 0x01d762422c946590ULL,
+        0xc722f0ef9d80aad6ULL, 0x424d3ad2b7b97ef5ULL,
+        0xf8ebad2b84e0d58bULL, 0xd2e0898765a7deb2ULL,
+        0x9b934c3b330c8577ULL, 0x63cc55f49f88eb2fULL,
+        0xc2781f49ffcfa6d5ULL, 0x3cbf6b71c76b25fbULL,
+        0xf316271c7fc3908aULL, 0x8bef464e3945ef7aULL,
+        0x97edd871cfda3a56ULL, 0x97758bf0e3cbb5acULL,
+        0xbde94e8e43d0c8ecULL, 0x3d52eeed1cbea317ULL,
+        0xed63a231d4c4fb27ULL, 0x4ca7aaa863ee4bddULL,
+        0x945e455f24fb1cf8ULL, 0x8fe8caa93e74ef6aULL,
+        0xb975d6b6ee39e436ULL, 0xb3e2fd538e122b44ULL,
+        0xe7d34c64a9c85d44ULL, 0x60dbbca87196b616ULL,
+        0x90e40fbeea1d3a4aULL, 0xbc8955e946fe31cdULL,
+        0xb51d13aea4a488ddULL, 0x6babab6398bdbe41ULL,
+        0xe264589a4dcdab14ULL, 0xc696963c7eed2dd1ULL,
+        0x8d7eb76070a08aecULL, 0xfc1e1de5cf543ca2ULL,
+        0xb0de65388cc8ada8ULL, 0x3b25a55f43294bcbULL,
+        0xdd15fe86affad912ULL, 0x49ef0eb713f39ebeULL,
+        0x8a2dbf142dfcc7abULL, 0x6e3569326c784337ULL,
+        0xacb92ed9397bf996ULL, 0x49c2c37f07965404ULL,
+        0xd7e77a8f87daf7fbULL, 0xdc33745ec97be906ULL,
+        0x86f0ac99b4e8dafdULL, 0x69a028bb3ded71a3ULL,
+        0xa8acd7c0222311bcULL, 0xc40832ea0d68ce0cULL,
+        0xd2d80db02aabd62bULL, 0xf50a3fa490c30190ULL,
+        0x83c7088e1aab65dbULL, 0x792667c6da79e0faULL,
+        0xa4b8cab1a1563f52ULL, 0x577001b891185938ULL,
+        0xcde6fd5e09abcf26ULL, 0xed4c0226b55e6f86ULL,
+        0x80b05e5ac60b6178ULL, 0x544f8158315b05b4ULL,
+        0xa0dc75f1778e39d6ULL, 0x696361ae3db1c721ULL,
+        0xc913936dd571c84cULL, 0x03bc3a19cd1e38e9ULL,
+        0xfb5878494ace3a5fULL, 0x04ab48a04065c723ULL,
+        0x9d174b2dcec0e47bULL, 0x62eb0d64283f9c76ULL,
+        0xc45d1df942711d9aULL, 0x3ba5d0bd324f8394ULL,
+        0xf5746577930d6500ULL, 0xca8f44ec7ee36479ULL,
+        0x9968bf6abbe85f20ULL, 0x7e998b13cf4e1ecbULL,
+        0xbfc2ef456ae276e8ULL, 0x9e3fedd8c321a67eULL,
+        0xefb3ab16c59b14a2ULL, 0xc5cfe94ef3ea101eULL,
+        0x95d04aee3b80ece5ULL, 0xbba1f1d158724a12ULL,
+        0xbb445da9ca61281fULL, 0x2a8a6e45ae8edc97ULL,
+        0xea1575143cf97226ULL, 0xf52d09d71a3293bdULL,
+        0x924d692ca61be758ULL, 0x593c2626705f9c56ULL,
+        0xb6e0c377cfa2e12eULL, 0x6f8b2fb00c77836cULL,
+        0xe498f455c38b997aULL, 0x0b6dfb9c0f956447ULL,
+        0x8edf98b59a373fecULL, 0x4724bd4189bd5eacULL,
+        0xb2977ee300c50fe7ULL, 0x58edec91ec2cb657ULL,
+        0xdf3d5e9bc0f653e1ULL, 0x2f2967b66737e3edULL,
+        0x8b865b215899f46cULL, 0xbd79e0d20082ee74ULL,
+        0xae67f1e9aec07187ULL, 0xecd8590680a3aa11ULL,
+        0xda01ee641a708de9ULL, 0xe80e6f4820cc9495ULL,
+        0x884134fe908658b2ULL, 0x3109058d147fdcddULL,
+        0xaa51823e34a7eedeULL, 0xbd4b46f0599fd415ULL,
+        0xd4e5e2cdc1d1ea96ULL, 0x6c9e18ac7007c91aULL,
+        0x850fadc09923329eULL, 0x03e2cf6bc604ddb0ULL,
+        0xa6539930bf6bff45ULL, 0x84db8346b786151cULL,
+        0xcfe87f7cef46ff16ULL, 0xe612641865679a63ULL,
+        0x81f14fae158c5f6eULL, 0x4fcb7e8f3f60c07eULL,
+        0xa26da3999aef7749ULL, 0xe3be5e330f38f09dULL,
+        0xcb090c8001ab551cULL, 0x5cadf5bfd3072cc5ULL,
+        0xfdcb4fa002162a63ULL, 0x73d9732fc7c8f7f6ULL,
+        0x9e9f11c4014dda7eULL, 0x2867e7fddcdd9afaULL,
+        0xc646d63501a1511dULL, 0xb281e1fd541501b8ULL,
+        0xf7d88bc24209a565ULL, 0x1f225a7ca91a4226ULL,
+        0x9ae757596946075fULL, 0x3375788de9b06958ULL,
+        0xc1a12d2fc3978937ULL, 0x0052d6b1641c83aeULL,
+        0xf209787bb47d6b84ULL, 0xc0678c5dbd23a49aULL,
+        0x9745eb4d50ce6332ULL, 0xf840b7ba963646e0ULL,
+        0xbd176620a501fbffULL, 0xb650e5a93bc3d898ULL,
+        0xec5d3fa8ce427affULL, 0xa3e51f138ab4cebeULL,
+        0x93ba47c980e98cdfULL, 0xc66f336c36b10137ULL,
+        0xb8a8d9bbe123f017ULL, 0xb80b0047445d4184ULL,
+        0xe6d3102ad96cec1dULL, 0xa60dc059157491e5ULL,
+        0x9043ea1ac7e41392ULL, 0x87c89837ad68db2fULL,
+        0xb454e4a179dd1877ULL, 0x29babe4598c311fbULL,
+        0xe16a1dc9d8545e94ULL, 0xf4296dd6fef3d67aULL,
+        0x8ce2529e2734bb1dULL, 0x1899e4a65f58660cULL,
+        0xb01ae745b101e9e4ULL, 0x5ec05dcff72e7f8fULL,
+        0xdc21a1171d42645dULL, 0x76707543f4fa1f73ULL,
+        0x899504ae72497ebaULL, 0x6a06494a791c53a8ULL,
+        0xabfa45da0edbde69ULL, 0x0487db9d17636892ULL,
+        0xd6f8d7509292d603ULL, 0x45a9d2845d3c42b6ULL,
+        0x865b86925b9bc5c2ULL, 0x0b8a2392ba45a9b2ULL,
+        0xa7f26836f282b732ULL, 0x8e6cac7768d7141eULL,
+        0xd1ef0244af2364ffULL, 0x3207d795430cd926ULL,
+        0x8335616aed761f1fULL, 0x7f44e6bd49e807b8ULL,
+        0xa402b9c5a8d3a6e7ULL, 0x5f16206c9c6209a6ULL,
+        0xcd036837130890a1ULL, 0x36dba887c37a8c0fULL,
+        0x802221226be55a64ULL, 0xc2494954da2c9789ULL,
+        0xa02aa96b06deb0fdULL, 0xf2db9baa10b7bd6cULL,
+        0xc83553c5c8965d3dULL, 0x6f92829494e5acc7ULL,
+        0xfa42a8b73abbf48cULL, 0xcb772339ba1f17f9ULL,
+        0x9c69a97284b578d7ULL, 0xff2a760414536efbULL,
+        0xc38413cf25e2d70dULL, 0xfef5138519684abaULL,
+        0xf46518c2ef5b8cd1ULL, 0x7eb258665fc25d69ULL,
+        0x98bf2f79d5993802ULL, 0xef2f773ffbd97a61ULL,
+        0xbeeefb584aff8603ULL, 0xaafb550ffacfd8faULL,
+        0xeeaaba2e5dbf6784ULL, 0x95ba2a53f983cf38ULL,
+        0x952ab45cfa97a0b2ULL, 0xdd945a747bf26183ULL,
+        0xba756174393d88dfULL, 0x94f971119aeef9e4ULL,
+        0xe912b9d1478ceb17ULL, 0x7a37cd5601aab85dULL,
+        0x91abb422ccb812eeULL, 0xac62e055c10ab33aULL,
+        0xb616a12b7fe617aaULL, 0x577b986b314d6009ULL,
+        0xe39c49765fdf9d94ULL, 0xed5a7e85fda0b80bULL,
+        0x8e41ade9fbebc27dULL, 0x14588f13be847307ULL,
+        0xb1d219647ae6b31cULL, 0x596eb2d8ae258fc8ULL,
+        0xde469fbd99a05fe3ULL, 0x6fca5f8ed9aef3bbULL,
+        0x8aec23d680043beeULL, 0x25de7bb9480d5854ULL,
+        0xada72ccc20054ae9ULL, 0xaf561aa79a10ae6aULL,
+        0xd910f7ff28069da4ULL, 0x1b2ba1518094da04ULL,
+        0x87aa9aff79042286ULL, 0x90fb44d2f05d0842ULL,
+        0xa99541bf57452b28ULL, 0x353a1607ac744a53ULL,
+        0xd3fa922f2d1675f2ULL, 0x42889b8997915ce8ULL,
+        0x847c9b5d7c2e09b7ULL, 0x69956135febada11ULL,
+        0xa59bc234db398c25ULL, 0x43fab9837e699095ULL,
+        0xcf02b2c21207ef2eULL, 0x94f967e45e03f4bbULL,
+        0x8161afb94b44f57dULL, 0x1d1be0eebac278f5ULL,
+        0xa1ba1ba79e1632dcULL, 0x6462d92a69731732ULL,
+        0xca28a291859bbf93ULL, 0x7d7b8f7503cfdcfeULL,
+        0xfcb2cb35e702af78ULL, 0x5cda735244c3d43eULL,
+        0x9defbf01b061adabULL, 0x3a0888136afa64a7ULL,
+        0xc56baec21c7a1916ULL, 0x088aaa1845b8fdd0ULL,
+        0xf6c69a72a3989f5bULL, 0x8aad549e57273d45ULL,
+        0x9a3c2087a63f6399ULL, 0x36ac54e2f678864bULL,
+        0xc0cb28a98fcf3c7fULL, 0x84576a1bb416a7ddULL,
+        0xf0fdf2d3f3c30b9fULL, 0x656d44a2a11c51d5ULL,
+        0x969eb7c47859e743ULL, 0x9f644ae5a4b1b325ULL,
+        0xbc4665b596706114ULL, 0x873d5d9f0dde1feeULL,
+        0xeb57ff22fc0c7959ULL, 0xa90cb506d155a7eaULL,
+        0x9316ff75dd87cbd8ULL, 0x09a7f12442d588f2ULL,
+        0xb7dcbf5354e9beceULL, 0x0c11ed6d538aeb2fULL,
+        0xe5d3ef282a242e81ULL, 0x8f1668c8a86da5faULL,
+        0x8fa475791a569d10ULL, 0xf96e017d694487bcULL,
+        0xb38d92d760ec4455ULL, 0x37c981dcc395a9acULL,
+        0xe070f78d3927556aULL, 0x85bbe253f47b1417ULL,
+        0x8c469ab843b89562ULL, 0x93956d7478ccec8eULL,
+        0xaf58416654a6babbULL, 0x387ac8d1970027b2ULL,
+        0xdb2e51bfe9d0696aULL, 0x06997b05fcc0319eULL,
+        0x88fcf317f22241e2ULL, 0x441fece3bdf81f03ULL,
+        0xab3c2fddeeaad25aULL, 0xd527e81cad7626c3ULL,
+        0xd60b3bd56a5586f1ULL, 0x8a71e223d8d3b074ULL,
+        0x85c7056562757456ULL, 0xf6872d5667844e49ULL,
+        0xa738c6bebb12d16cULL, 0xb428f8ac016561dbULL,
+        0xd106f86e69d785c7ULL, 0xe13336d701beba52ULL,
+        0x82a45b450226b39cULL, 0xecc0024661173473ULL,
+        0xa34d721642b06084ULL, 0x27f002d7f95d0190ULL,
+        0xcc20ce9bd35c78a5ULL, 0x31ec038df7b441f4ULL,
+        0xff290242c83396ceULL, 0x7e67047175a15271ULL,
+        0x9f79a169bd203e41ULL, 0x0f0062c6e984d386ULL,
+        0xc75809c42c684dd1ULL, 0x52c07b78a3e60868ULL,
+        0xf92e0c3537826145ULL, 0xa7709a56ccdf8a82ULL,
+        0x9bbcc7a142b17ccbULL, 0x88a66076400bb691ULL,
+        0xc2abf989935ddbfeULL, 0x6acff893d00ea435ULL,
+        0xf356f7ebf83552feULL, 0x0583f6b8c4124d43ULL,
+        0x98165af37b2153deULL, 0xc3727a337a8b704aULL,
+        0xbe1bf1b059e9a8d6ULL, 0x744f18c0592e4c5cULL,
+        0xeda2ee1c7064130cULL, 0x1162def06f79df73ULL,
+        0x9485d4d1c63e8be7ULL, 0x8addcb5645ac2ba8ULL,
+        0xb9a74a0637ce2ee1ULL, 0x6d953e2bd7173692ULL,
+        0xe8111c87c5c1ba99ULL, 0xc8fa8db6ccdd0437ULL,
+        0x910ab1d4db9914a0ULL, 0x1d9c9892400a22a2ULL,
+        0xb54d5e4a127f59c8ULL, 0x2503beb6d00cab4bULL,
+        0xe2a0b5dc971f303aULL, 0x2e44ae64840fd61dULL,
+        0x8da471a9de737e24ULL, 0x5ceaecfed289e5d2ULL,
+        0xb10d8e1456105dadULL, 0x7425a83e872c5f47ULL,
+        0xdd50f1996b947518ULL, 0xd12f124e28f77719ULL,
+        0x8a5296ffe33cc92fULL, 0x82bd6b70d99aaa6fULL,
+        0xace73cbfdc0bfb7bULL, 0x636cc64d1001550bULL,
+        0xd8210befd30efa5aULL, 0x3c47f7e05401aa4eULL,
+        0x8714a775e3e95c78ULL, 0x65acfaec34810a71ULL,
+        0xa8d9d1535ce3b396ULL, 0x7f1839a741a14d0dULL,
+        0xd31045a8341ca07cULL, 0x1ede48111209a050ULL,
+        0x83ea2b892091e44dULL, 0x934aed0aab460432ULL,
+        0xa4e4b66b68b65d60ULL, 0xf81da84d5617853fULL,
+        0xce1de40642e3f4b9ULL, 0x36251260ab9d668eULL,
+        0x80d2ae83e9ce78f3ULL, 0xc1d72b7c6b426019ULL,
+        0xa1075a24e4421730ULL, 0xb24cf65b8612f81fULL,
+        0xc94930ae1d529cfcULL, 0xdee033f26797b627ULL,
+        0xfb9b7cd9a4a7443cULL, 0x169840ef017da3b1ULL,
+        0x9d412e0806e88aa5ULL, 0x8e1f289560ee864eULL,
+        0xc491798a08a2ad4eULL, 0xf1a6f2bab92a27e2ULL,
+        0xf5b5d7ec8acb58a2ULL, 0xae10af696774b1dbULL,
+        0x9991a6f3d6bf1765ULL, 0xacca6da1e0a8ef29ULL,
+        0xbff610b0cc6edd3fULL, 0x17fd090a58d32af3ULL,
+        0xeff394dcff8a948eULL, 0xddfc4b4cef07f5b0ULL,
+        0x95f83d0a1fb69cd9ULL, 0x4abdaf101564f98eULL,
+        0xbb764c4ca7a4440fULL, 0x9d6d1ad41abe37f1ULL,
+        0xea53df5fd18d5513ULL, 0x84c86189216dc5edULL,
+        0x92746b9be2f8552cULL, 0x32fd3cf5b4e49bb4ULL,
+        0xb7118682dbb66a77ULL, 0x3fbc8c33221dc2a1ULL,
+        0xe4d5e82392a40515ULL, 0x0fabaf3feaa5334aULL,
+        0x8f05b1163ba6832dULL, 0x29cb4d87f2a7400eULL,
+        0xb2c71d5bca9023f8ULL, 0x743e20e9ef511012ULL,
+        0xdf78e4b2bd342cf6ULL, 0x914da9246b255416ULL,
+        0x8bab8eefb6409c1aULL, 0x1ad089b6c2f7548eULL,
+        0xae9672aba3d0c320ULL, 0xa184ac2473b529b1ULL,
+        0xda3c0f568cc4f3e8ULL, 0xc9e5d72d90a2741eULL,
+        0x8865899617fb1871ULL, 0x7e2fa67c7a658892ULL,
+        0xaa7eebfb9df9de8dULL, 0xddbb901b98feeab7ULL,
+        0xd51ea6fa85785631ULL, 0x552a74227f3ea565ULL,
+        0x8533285c936b35deULL, 0xd53a88958f87275fULL,
+        0xa67ff273b8460356ULL, 0x8a892abaf368f137ULL,
+        0xd01fef10a657842cULL, 0x2d2b7569b0432d85ULL,
+        0x8213f56a67f6b29bULL, 0x9c3b29620e29fc73ULL,
+        0xa298f2c501f45f42ULL, 0x8349f3ba91b47b8fULL,
+        0xcb3f2f7642717713ULL, 0x241c70a936219a73ULL,
+        0xfe0efb53d30dd4d7ULL, 0xed238cd383aa0110ULL,
+        0x9ec95d1463e8a506ULL, 0xf4363804324a40aaULL,
+        0xc67bb4597ce2ce48ULL, 0xb143c6053edcd0d5ULL,
+        0xf81aa16fdc1b81daULL, 0xdd94b7868e94050aULL,
+        0x9b10a4e5e9913128ULL, 0xca7cf2b4191c8326ULL,
+        0xc1d4ce1f63f57d72ULL, 0xfd1c2f611f63a3f0ULL,
+        0xf24a01a73cf2dccfULL, 0xbc633b39673c8cecULL,
+        0x976e41088617ca01ULL, 0xd5be0503e085d813ULL,
+        0xbd49d14aa79dbc82ULL, 0x4b2d8644d8a74e18ULL,
+        0xec9c459d51852ba2ULL, 0xddf8e7d60ed1219eULL,
+        0x93e1ab8252f33b45ULL, 0xcabb90e5c942b503ULL,
+        0xb8da1662e7b00a17ULL, 0x3d6a751f3b936243ULL,
+        0xe7109bfba19c0c9dULL, 0x0cc512670a783ad4ULL,
+        0x906a617d450187e2ULL, 0x27fb2b80668b24c5ULL,
+        0xb484f9dc9641e9daULL, 0xb1f9f660802dedf6ULL,
+        0xe1a63853bbd26451ULL, 0x5e7873f8a0396973ULL,
+        0x8d07e33455637eb2ULL, 0xdb0b487b6423e1e8ULL,
+        0xb049dc016abc5e5fULL, 0x91ce1a9a3d2cda62ULL,
+        0xdc5c5301c56b75f7ULL, 0x7641a140cc7810fbULL,
+        0x89b9b3e11b6329baULL, 0xa9e904c87fcb0a9dULL,
+        0xac2820d9623bf429ULL, 0x546345fa9fbdcd44ULL,
+        0xd732290fbacaf133ULL, 0xa97c177947ad4095ULL,
+        0x867f59a9d4bed6c0ULL, 0x49ed8eabcccc485dULL,
+        0xa81f301449ee8c70ULL, 0x5c68f256bfff5a74ULL,
+        0xd226fc195c6a2f8cULL, 0x73832eec6fff3111ULL,
+        0x83585d8fd9c25db7ULL, 0xc831fd53c5ff7eabULL,
+        0xa42e74f3d032f525ULL, 0xba3e7ca8b77f5e55ULL,
+        0xcd3a1230c43fb26fULL, 0x28ce1bd2e55f35ebULL,
+        0x80444b5e7aa7cf85ULL, 0x7980d163cf5b81b3ULL,
+        0xa0555e361951c366ULL, 0xd7e105bcc332621fULL,
+        0xc86ab5c39fa63440ULL, 0x8dd9472bf3fefaa7ULL,
+        0xfa856334878fc150ULL, 0xb14f98f6f0feb951ULL,
+        0x9c935e00d4b9d8d2ULL, 0x6ed1bf9a569f33d3ULL,
+        0xc3b8358109e84f07ULL, 0x0a862f80ec4700c8ULL,
+        0xf4a642e14c6262c8ULL, 0xcd27bb612758c0faULL,
+        0x98e7e9cccfbd7dbdULL, 0x8038d51cb897789cULL,
+        0xbf21e44003acdd2cULL, 0xe0470a63e6bd56c3ULL,
+        0xeeea5d5004981478ULL, 0x1858ccfce06cac74ULL,
+        0x95527a5202df0ccbULL, 0x0f37801e0c43ebc8ULL,
+        0xbaa718e68396cffdULL, 0xd30560258f54e6baULL,
+        0xe950df20247c83fdULL, 0x47c6b82ef32a2069ULL,
+        0x91d28b7416cdd27eULL, 0x4cdc331d57fa5441ULL,
+        0xb6472e511c81471dULL, 0xe0133fe4adf8e952ULL,
+        0xe3d8f9e563a198e5ULL, 0x58180fddd97723a6ULL,
+        0x8e679c2f5e44ff8fULL, 0x570f09eaa7ea7648ULL
+    };
+
+    const double PowerOfTen[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    // Binary64 layout
+    constexpr int32_t MantissaBits = 52;
+    constexpr int32_t MinimumExponent = -1023;
+    constexpr int32_t InfinitePower = 0x7FF;
+    constexpr uint32_t MaxMantissaDigits = 19;
+
+    inline double MakeDouble(uint64_t Mantissa, int32_t Power2, bool Negative) noexcept
+    {
+        uint64_t Bits = Mantissa | (static_cast<uint64_t>(Power2) << MantissaBits);
+        if (Negative)
+            Bits |= uint64_t(1) << 63;
+        double Value;
+        std::memcpy(&Value, &Bits, sizeof(Value));
+        return Value;
+    }
+
+    // Eisel-Lemire: nearest double to Mantissa * 10^Exponent10, Mantissa != 0
+    double ComputeFloat(uint64_t Mantissa, int64_t Exponent10, bool Negative) noexcept
+    {
+        if (Exponent10 < SmallestPowerOfFive)
+            return MakeDouble(0, 0, Negative);
+        if (Exponent10 > LargestPowerOfFive)
+            return MakeDouble(0, InfinitePower, Negative);
+
+        const int32_t LeadingZeros = static_cast<int32_t>(Simd::CountLeadingZeros(Mantissa));
+        Mantissa <<= LeadingZeros;
+
+        // 128 bit product, the second half of the power is only needed when the first one is inconclusive
+        const uint32_t Index = 2 * static_cast<uint32_t>(Exponent10 - SmallestPowerOfFive);
+        const uint64_t PrecisionMask = 0xFFFFFFFFFFFFFFFFULL >> (MantissaBits + 3);
+        UInt128 Product = Multiply(Mantissa, PowerOfFive128[Index]);
+        if ((Product.High & PrecisionMask) == PrecisionMask)
+        {
+            const UInt128 Second = Multiply(Mantissa, PowerOfFive128[Index + 1]);
+            Product.Low += Second.High;
+            if (Second.High > Product.Low)
+                ++Product.High;
+        }
+
+        const int32_t UpperBit = static_cast<int32_t>(Product.High >> 63);
+        const int32_t Shift = UpperBit + 64 - MantissaBits - 3;
+        uint64_t Result = Product.High >> Shift;
+        // floor(log2(10^Exponent10)) + 63
+        const int32_t Power = (((152170 + 65536) * static_cast<int32_t>(Exponent10)) >> 16) + 63;
+        int32_t Power2 = Power + UpperBit - LeadingZeros - MinimumExponent;
+
+        if (Power2 <= 0)
+        {
+            // Subnormal
+            if (-Power2 + 1 >= 64)
+                return MakeDouble(0, 0, Negative);
+            Result >>= -Power2 + 1;
+            Result += (Result & 1);
+            Result >>= 1;
+            Power2 = (Result < (uint64_t(1) << MantissaBits)) ? 0 : 1;
+            return MakeDouble(Result, Power2, Negative);
+        }
+
+        // Exactly halfway between two doubles - round to even
+        if (Product.Low <= 1 && Exponent10 >= -4 && Exponent10 <= 23 && (Result & 3) == 1)
+        {
+            if ((Result << Shift) == Product.High)
+                Result &= ~uint64_t(1);
+        }
+
+        Result += (Result & 1);
+        Result >>= 1;
+        if (Result >= (uint64_t(2) << MantissaBits))
+        {
+            Result = uint64_t(1) << MantissaBits;
+            ++Power2;
+        }
+        Result &= ~(uint64_t(1) << MantissaBits);
+        if (Power2 >= InfinitePower)
+            return MakeDouble(0, InfinitePower, Negative);
+        return MakeDouble(Result, Power2, Negative);
+    }
+
+    // Locale independent slow path, only taken for ambiguous numbers with more than 19 significant digits
+    double ParseDoubleFallback(const char* First, const char* Last)
+    {
+        std::istringstream Stream(std::string(First, Last));
+        Stream.imbue(std::locale::classic());
+        double Value = 0.0;
+        Stream >> Value;
+        return Value;
+    }
+
+    struct Significand
+    {
+        uint64_t Mantissa   = 0;
+        int64_t  Exponent10 = 0;
+        uint32_t Digits     = 0;
+        bool     Truncated  = false;
+
+        // Keep the first 19 significant digits, remember whether anything non-zero was dropped
+        void Append(const char* First, const char* Last, bool IsFraction) noexcept
+        {
+            for (; First != Last; ++First)
+            {
+                const uint32_t Digit = static_cast<uint32_t>(*First - '0');
+                if (Digits == 0 && Digit == 0)
+                {
+                    if (IsFraction) --Exponent10;
+                }
+                else if (Digits < MaxMantissaDigits)
+                {
+                    Mantissa = Mantissa * 10 + Digit;
+                    ++Digits;
+                    if (IsFraction) --Exponent10;
+                }
+                else
+                {
+                    if (!IsFraction) ++Exponent10;
+                    Truncated |= (Digit != 0);
+                }
+            }
+        }
+    };
+
+    double ToDouble(const Significand& Value, bool Negative, const char* First, const char* Last)
+    {
+        if (Value.Mantissa == 0)
+            return Negative ? -0.0 : 0.0;
+
+        if (!Value.Truncated)
+        {
+#if FLT_EVAL_METHOD == 0
+            // Clinger's fast path - both operands are exact doubles
+            if (Value.Exponent10 >= -22 && Value.Exponent10 <= 22 && Value.Mantissa <= (uint64_t(1) << 53))
+            {
+                double Result = static_cast<double>(Value.Mantissa);
+                Result = Value.Exponent10 < 0
+                    ? Result / PowerOfTen[-Value.Exponent10]
+                    : Result * PowerOfTen[Value.Exponent10];
+                return Negative ? -Result : Result;
+            }
+#endif // FLT_EVAL_METHOD
+            return ComputeFloat(Value.Mantissa, Value.Exponent10, Negative);
+        }
+
+        // The exact value lies between Mantissa and Mantissa + 1
+        const double Lower = ComputeFloat(Value.Mantissa, Value.Exponent10, Negative);
+        const double Upper = ComputeFloat(Value.Mantissa + 1, Value.Exponent10, Negative);
+        if (Lower == Upper)
+            return Lower;
+        return ParseDoubleFallback(First, Last);
+    }
+
+    const char DigitPairs[] =
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899";
+
+    const uint64_t PowerOfTenInteger[] = {
+        1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL,
+        1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+        100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL,
+        1000000000000000000ULL, 10000000000000000000ULL
+    };
+
+    inline uint32_t CountDigits(uint64_t Value) noexcept
+    {
+        // log10 from the bit length, corrected by one table lookup; 0 counts like 1
+        Value |= 1;
+        const uint32_t Guess = ((64 - Simd::CountLeadingZeros(Value)) * 1233) >> 12;
+        return Guess + 1 - static_cast<uint32_t>(Value < PowerOfTenInteger[Guess]);
+    }
+
+    char* FormatUnsigned(uint64_t Value, char* Buffer) noexcept
+    {
+        char* Last = Buffer + CountDigits(Value);
+        char* Cursor = Last;
+        while (Value >= 100)
+        {
+            const uint32_t Index = static_cast<uint32_t>(Value % 100) * 2;
+            Value /= 100;
+            *--Cursor = DigitPairs[Index + 1];
+            *--Cursor = DigitPairs[Index];
+        }
+        if (Value >= 10)
+        {
+            const uint32_t Index = static_cast<uint32_t>(Value) * 2;
+            *--Cursor = DigitPairs[Index + 1];
+            *--Cursor = DigitPairs[Index];
+        }
+        else
+        {
+            *--Cursor = static_cast<char>('0' + Value);
+        }
+        return Last;
+    }
+
+    // Grisu2 and Grisu3 - Florian Loitsch, "Printing Floating-Point Numbers Quickly and Accurately with Integers"
+    struct DiyFp
+    {
+        uint64_t F;
+        int32_t  E;
+
+        static DiyFp Sub(const DiyFp& Lhs, const DiyFp& Rhs) noexcept
+        {
+            return DiyFp{ Lhs.F - Rhs.F, Lhs.E };
+        }
+
+        // Upper 64 bits of the product, rounded
+        static DiyFp Mul(const DiyFp& Lhs, const DiyFp& Rhs) noexcept
+        {
+            const UInt128 Product = Multiply(Lhs.F, Rhs.F);
+            return DiyFp{ Product.High + (Product.Low >> 63), Lhs.E + Rhs.E + 64 };
+        }
+
+        static DiyFp Normalize(DiyFp Value) noexcept
+        {
+            const int32_t Shift = static_cast<int32_t>(Simd::CountLeadingZeros(Value.F));
+            return DiyFp{ Value.F << Shift, Value.E - Shift };
+        }
+
+        static DiyFp NormalizeTo(const DiyFp& Value, int32_t Exponent) noexcept
+        {
+            return DiyFp{ Value.F << (Value.E - Exponent), Exponent };
+        }
+    };
+
+    struct Boundaries
+    {
+        DiyFp W;
+        DiyFp Minus;
+        DiyFp Plus;
+    };
+
+    // Value and the boundaries of its rounding interval, Value > 0
+    Boundaries ComputeBoundaries(double Value) noexcept
+    {
+        constexpr int32_t Bias = 1023 + MantissaBits;
+        constexpr int32_t MinExp = 1 - Bias;
+        constexpr uint64_t HiddenBit = uint64_t(1) << MantissaBits;
+
+        uint64_t Bits;
+        std::memcpy(&Bits, &Value, sizeof(Bits));
+        const uint64_t Exponent = Bits >> MantissaBits;
+        const uint64_t Fraction = Bits & (HiddenBit - 1);
+
+        const DiyFp V = (Exponent == 0)
+            ? DiyFp{ Fraction, MinExp }
+            : DiyFp{ Fraction + HiddenBit, static_cast<int32_t>(Exponent) - Bias };
+
+        // The lower boundary is closer when the fraction is zero, except for the smallest normal
+        const bool LowerBoundaryIsCloser = (Fraction == 0 && Exponent > 1);
+        const DiyFp MPlus{ 2 * V.F + 1, V.E - 1 };
+        const DiyFp MMinus = LowerBoundaryIsCloser
+            ? DiyFp{ 4 * V.F - 1, V.E - 2 }
+            : DiyFp{ 2 * V.F - 1, V.E - 1 };
+
+        const DiyFp WPlus = DiyFp::Normalize(MPlus);
+        const DiyFp WMinus = DiyFp::NormalizeTo(MMinus, WPlus.E);
+        return Boundaries{ DiyFp::Normalize(V), WMinus, WPlus };
+    }
+
+    struct CachedPower
+    {
+        uint64_t F;
+        int32_t  E;
+        int32_t  K;
+    };
+
+    // Normalized 10^K for K = -300, -292, ..., 324
+    constexpr int32_t CachedPowersMinDecExp = -300;
+    constexpr int32_t CachedPowersDecStep = 8;
+    const CachedPower CachedPowers[] = {
+        { 0xAB70FE17C79AC6CAULL, -1060, -300 },
+        { 0xFF77B1FCBEBCDC4FULL, -1034, -292 },
+        { 0xBE5691EF416BD60CULL, -1007, -284 },
+        { 0x8DD01FAD907FFC3CULL,  -980, -276 },
+        { 0xD3515C2831559A83ULL,  -954, -268 },
+        { 0x9D71AC8FADA6C9B5ULL,  -927, -260 },
+        { 0xEA9C227723EE8BCBULL,  -901, -252 },
+        { 0xAECC49914078536DULL,  -874, -244 },
+        { 0x823C12795DB6CE57ULL,  -847, -236 },
+        { 0xC21094364DFB5637ULL,  -821, -228 },
+        { 0x9096EA6F3848984FULL,  -794, -220 },
+        { 0xD77485CB25823AC7ULL,  -768, -212 },
+        { 0xA086CFCD97BF97F4ULL,  -741, -204 },
+        { 0xEF340A98172AACE5ULL,  -715, -196 },
+        { 0xB23867FB2A35B28EULL,  -688, -188 },
+        { 0x84C8D4DFD2C63F3BULL,  -661, -180 },
+        { 0xC5DD44271AD3CDBAULL,  -635, -172 },
+        { 0x936B9FCEBB25C996ULL,  -608, -164 },
+        { 0xDBAC6C247D62A584ULL,  -582, -156 },
+        { 0xA3AB66580D5FDAF6ULL,  -555, -148 },
+        { 0xF3E2F893DEC3F126ULL,  -529, -140 },
+        { 0xB5B5ADA8AAFF80B8ULL,  -502, -132 },
+        { 0x87625F056C7C4A8BULL,  -475, -124 },
+        { 0xC9BCFF6034C13053ULL,  -449, -116 },
+        { 0x964E858C91BA2655ULL,  -422, -108 },
+        { 0xDFF9772470297EBDULL,  -396, -100 },
+        { 0xA6DFBD9FB8E5B88FULL,  -369,  -92 },
+        { 0xF8A95FCF88747D94ULL,  -343,  -84 },
+        { 0xB94470938FA89BCFULL,  -316,  -76 },
+        { 0x8A08F0F8BF0F156BULL,  -289,  -68 },
+        { 0xCDB02555653131B6ULL,  -263,  -60 },
+        { 0x993FE2C6D07B7FACULL,  -236,  -52 },
+        { 0xE45C10C42A2B3B06ULL,  -210,  -44 },
+        { 0xAA242499697392D3ULL,  -183,  -36 },
+        { 0xFD87B5F28300CA0EULL,  -157,  -28 },
+        { 0xBCE5086492111AEBULL,  -130,  -20 },
+        { 0x8CBCCC096F5088CCULL,  -103,  -12 },
+        { 0xD1B71758E219652CULL,   -77,   -4 },
+        { 0x9C40000000000000ULL,   -50,    4 },
+        { 0xE8D4A51000000000ULL,   -24,   12 },
+        { 0xAD78EBC5AC620000ULL,     3,   20 },
+        { 0x813F3978F8940984ULL,    30,   28 },
+        { 0xC097CE7BC90715B3ULL,    56,   36 },
+        { 0x8F7E32CE7BEA5C70ULL,    83,   44 },
+        { 0xD5D238A4ABE98068ULL,   109,   52 },
+        { 0x9F4F2726179A2245ULL,   136,   60 },
+        { 0xED63A231D4C4FB27ULL,   162,   68 },
+        { 0xB0DE65388CC8ADA8ULL,   189,   76 },
+        { 0x83C7088E1AAB65DBULL,   216,   84 },
+        { 0xC45D1DF942711D9AULL,   242,   92 },
+        { 0x924D692CA61BE758ULL,   269,  100 },
+        { 0xDA01EE641A708DEAULL,   295,  108 },
+        { 0xA26DA3999AEF774AULL,   322,  116 },
+        { 0xF209787BB47D6B85ULL,   348,  124 },
+        { 0xB454E4A179DD1877ULL,   375,  132 },
+        { 0x865B86925B9BC5C2ULL,   402,  140 },
+        { 0xC83553C5C8965D3DULL,   428,  148 },
+        { 0x952AB45CFA97A0B3ULL,   455,  156 },
+        { 0xDE469FBD99A05FE3ULL,   481,  164 },
+        { 0xA59BC234DB398C25ULL,   508,  172 },
+        { 0xF6C69A72A3989F5CULL,   534,  180 },
+        { 0xB7DCBF5354E9BECEULL,   561,  188 },
+        { 0x88FCF317F22241E2ULL,   588,  196 },
+        { 0xCC20CE9BD35C78A5ULL,   614,  204 },
+        { 0x98165AF37B2153DFULL,   641,  212 },
+        { 0xE2A0B5DC971F303AULL,   667,  220 },
+        { 0xA8D9D1535CE3B396ULL,   694,  228 },
+        { 0xFB9B7CD9A4A7443CULL,   720,  236 },
+        { 0xBB764C4CA7A44410ULL,   747,  244 },
+        { 0x8BAB8EEFB6409C1AULL,   774,  252 },
+        { 0xD01FEF10A657842CULL,   800,  260 },
+        { 0x9B10A4E5E9913129ULL,   827,  268 },
+        { 0xE7109BFBA19C0C9DULL,   853,  276 },
+        { 0xAC2820D9623BF429ULL,   880,  284 },
+        { 0x80444B5E7AA7CF85ULL,   907,  292 },
+        { 0xBF21E44003ACDD2DULL,   933,  300 },
+        { 0x8E679C2F5E44FF8FULL,   960,  308 },
+        { 0xD433179D9C8CB841ULL,   986,  316 },
+        { 0x9E19DB92B4E31BA9ULL,  1013,  324 }
+    };
+
+    // Keep the scaled exponent in [Alpha, Gamma] so digit generation works on 32 bit integers
+    constexpr int32_t Alpha = -60;
+    constexpr int32_t Gamma = -32;
+
+    const CachedPower& GetCachedPowerForBinaryExponent(int32_t Exponent) noexcept
+    {
+        const int32_t F = Alpha - Exponent - 1;
+        const int32_t K = (F * 78913) / (1 << 18) + static_cast<int32_t>(F > 0);
+        const int32_t Index = (-CachedPowersMinDecExp + K + (CachedPowersDecStep - 1)) / CachedPowersDecStep;
+        return CachedPowers[Index];
+    }
+
+    int32_t FindLargestPow10(uint32_t Number, uint32_t& Pow10) noexcept
+    {
+        static const uint32_t Powers[] = { 1U, 10U, 100U, 1000U, 10000U, 100000U, 1000000U, 10000000U, 100000000U, 1000000000U };
+        int32_t Index = 9;
+        while (Index > 0 && Number < Powers[Index])
+            --Index;
+        Pow10 = Powers[Index];
+        return Index + 1;
+    }
+
+    void Grisu2Round(char* Buffer, int32_t Length, uint64_t Distance, uint64_t Delta, uint64_t Rest, uint64_t TenK) noexcept
+    {
+        // Move the last digit towards the value while it stays inside the rounding interval
+        while (Rest < Distance && Delta - Rest >= TenK && (Rest + TenK < Distance || Distance - Rest > Rest + TenK - Distance))
+        {
+            --Buffer[Length - 1];
+            Rest += TenK;
+        }
+    }
+
+    void Grisu2DigitGen(char* Buffer, int32_t& Length, int32_t& DecimalExponent, DiyFp MMinus, DiyFp W, DiyFp MPlus) noexcept
+    {
+        uint64_t Delta = DiyFp::Sub(MPlus, MMinus).F;
+        uint64_t Distance = DiyFp::Sub(MPlus, W).F;
+
+        const DiyFp One{ uint64_t(1) << -MPlus.E, MPlus.E };
+        uint32_t P1 = static_cast<uint32_t>(MPlus.F >> -One.E);
+        uint64_t P2 = MPlus.F & (One.F - 1);
+
+        // Integral digits
+        uint32_t Pow10;
+        int32_t N = FindLargestPow10(P1, Pow10);
+        while (N > 0)
+        {
+            const uint32_t Digit = P1 / Pow10;
+            P1 %= Pow10;
+            Buffer[Length++] = static_cast<char>('0' + Digit);
+            --N;
+
+            const uint64_t Rest = (static_cast<uint64_t>(P1) << -One.E) + P2;
+            if (Rest <= Delta)
+            {
+                DecimalExponent += N;
+                Grisu2Round(Buffer, Length, Distance, Delta, Rest, static_cast<uint64_t>(Pow10) << -One.E);
+                return;
+            }
+            Pow10 /= 10;
+        }
+
+        // Fractional digits
+        int32_t M = 0;
+        for (;;)
+        {
+            P2 *= 10;
+            const uint64_t Digit = P2 >> -One.E;
+            P2 &= One.F - 1;
+            Buffer[Length++] = static_cast<char>('0' + Digit);
+            ++M;
+            Delta *= 10;
+            Distance *= 10;
+            if (P2 <= Delta)
+                break;
+        }
+        DecimalExponent -= M;
+        Grisu2Round(Buffer, Length, Distance, Delta, P2, One.F);
+    }
+
+    // Digits of Value > 0 that read back as Value, Value = Digits * 10^DecimalExponent. The shrunk
+    // interval makes them one digit longer than needed for a few values.
+    void Grisu2(char* Buffer, int32_t& Length, int32_t& DecimalExponent, double Value) noexcept
+    {
+        const Boundaries Bounds = ComputeBoundaries(Value);
+        const CachedPower& Cached = GetCachedPowerForBinaryExponent(Bounds.Plus.E);
+        const DiyFp CMinusK{ Cached.F, Cached.E };
+
+        const DiyFp W = DiyFp::Mul(Bounds.W, CMinusK);
+        const DiyFp WMinus = DiyFp::Mul(Bounds.Minus, CMinusK);
+        const DiyFp WPlus = DiyFp::Mul(Bounds.Plus, CMinusK);
+
+        // Shrink the interval by one unit on both sides to stay conservative
+        const DiyFp MMinus{ WMinus.F + 1, WMinus.E };
+        const DiyFp MPlus{ WPlus.F - 1, WPlus.E };
+
+        Length = 0;
+        DecimalExponent = -Cached.K;
+        Grisu2DigitGen(Buffer, Length, DecimalExponent, MMinus, W, MPlus);
+    }
+
+    // Grisu3 - the same digits from the unshrunk interval, with a check that they are the shortest
+    // and closest. Returns false for the about 0.5% of values where the imprecision of the cached
+    // power leaves that open.
+    bool Grisu3RoundWeed(char* Buffer, int32_t Length, uint64_t DistanceTooHighW, uint64_t UnsafeInterval,
+                         uint64_t Rest, uint64_t TenK, uint64_t Unit) noexcept
+    {
+        const uint64_t SmallDistance = DistanceTooHighW - Unit;
+        const uint64_t BigDistance = DistanceTooHighW + Unit;
+
+        // Move the last digit towards the value as long as it is certainly closer
+        while (Rest < SmallDistance && UnsafeInterval - Rest >= TenK
+            && (Rest + TenK < SmallDistance || SmallDistance - Rest >= Rest + TenK - SmallDistance))
+        {
+            --Buffer[Length - 1];
+            Rest += TenK;
+        }
+
+        // Another step might still be closer when the value is seen from the far side of its error
+        if (Rest < BigDistance && UnsafeInterval - Rest >= TenK
+            && (Rest + TenK < BigDistance || BigDistance - Rest > Rest + TenK - BigDistance))
+            return false;
+
+        // The digits must be inside the safe interval, which is the unsafe one less the error
+        return 2 * Unit <= Rest && Rest <= UnsafeInterval - 4 * Unit;
+    }
+
+    bool Grisu3DigitGen(char* Buffer, int32_t& Length, int32_t& DecimalExponent, DiyFp Low, DiyFp W, DiyFp High) noexcept
+    {
+        // Low and High are off by at most one unit, digits are generated from the widest interval
+        uint64_t Unit = 1;
+        const DiyFp TooLow{ Low.F - Unit, Low.E };
+        const DiyFp TooHigh{ High.F + Unit, High.E };
+        uint64_t UnsafeInterval = DiyFp::Sub(TooHigh, TooLow).F;
+
+        const DiyFp One{ uint64_t(1) << -W.E, W.E };
+        uint32_t Integrals = static_cast<uint32_t>(TooHigh.F >> -One.E);
+        uint64_t Fractionals = TooHigh.F & (One.F - 1);
+
+        // Integral digits
+        uint32_t Pow10;
+        int32_t N = FindLargestPow10(Integrals, Pow10);
+        while (N > 0)
+        {
+            Buffer[Length++] = static_cast<char>('0' + Integrals / Pow10);
+            Integrals %= Pow10;
+            --N;
+
+            const uint64_t Rest = (static_cast<uint64_t>(Integrals) << -One.E) + Fractionals;
+            if (Rest < UnsafeInterval)
+            {
+                DecimalExponent += N;
+                return Grisu3RoundWeed(Buffer, Length, DiyFp::Sub(TooHigh, W).F, UnsafeInterval, Rest,
+                                       static_cast<uint64_t>(Pow10) << -One.E, Unit);
+            }
+            Pow10 /= 10;
+        }
+
+        // Fractional digits, the error grows with every digit
+        int32_t M = 0;
+        for (;;)
+        {
+            Fractionals *= 10;
+            Unit *= 10;
+            UnsafeInterval *= 10;
+            Buffer[Length++] = static_cast<char>('0' + (Fractionals >> -One.E));
+            Fractionals &= One.F - 1;
+            ++M;
+            if (Fractionals < UnsafeInterval)
+            {
+                DecimalExponent -= M;
+                return Grisu3RoundWeed(Buffer, Length, DiyFp::Sub(TooHigh, W).F * Unit, UnsafeInterval,
+                                       Fractionals, One.F, Unit);
+            }
+        }
+    }
+
+    bool Grisu3(char* Buffer, int32_t& Length, int32_t& DecimalExponent, double Value) noexcept
+    {
+        const Boundaries Bounds = ComputeBoundaries(Value);
+        const CachedPower& Cached = GetCachedPowerForBinaryExponent(Bounds.Plus.E);
+        const DiyFp CMinusK{ Cached.F, Cached.E };
+
+        Length = 0;
+        DecimalExponent = -Cached.K;
+        return Grisu3DigitGen(Buffer, Length, DecimalExponent, DiyFp::Mul(Bounds.Minus, CMinusK),
+                              DiyFp::Mul(Bounds.W, CMinusK), DiyFp::Mul(Bounds.Plus, CMinusK));
+    }
+
+    // Exact fallback for Grisu3 failures - Grisu2 digits always read back as Value but may be longer
+    // than needed. A shorter representation exists when the rounded down or rounded up digits
+    // still read back as Value, the exact parser settles that for one digit less at a time.
+    void Shorten(char* Buffer, int32_t& Length, int32_t& DecimalExponent, double Value) noexcept
+    {
+        uint64_t Digits = 0;
+        for (int32_t Index = 0; Index < Length; ++Index)
+            Digits = Digits * 10 + static_cast<uint64_t>(Buffer[Index] - '0');
+
+        bool Shortened = false;
+        while (Digits >= 10)
+        {
+            const uint64_t Lower = Digits / 10;
+            const uint64_t Upper = Lower + 1;
+            const bool LowerFits = ComputeFloat(Lower, DecimalExponent + 1, false) == Value;
+            const bool UpperFits = ComputeFloat(Upper, DecimalExponent + 1, false) == Value;
+            if (!LowerFits && !UpperFits)
+                break;
+
+            Digits = (LowerFits && (!UpperFits || Digits % 10 < 5)) ? Lower : Upper;
+            ++DecimalExponent;
+            Shortened = true;
+        }
+        if (!Shortened)
+            return;
+
+        // Rounding up may carry into trailing zeros
+        while (Digits % 10 == 0)
+        {
+            Digits /= 10;
+            ++DecimalExponent;
+        }
+        Length = static_cast<int32_t>(FormatUnsigned(Digits, Buffer) - Buffer);
+    }
+
+    char* AppendExponent(char* Buffer, int32_t Exponent) noexcept
+    {
+        if (Exponent < 0)
+        {
+            Exponent = -Exponent;
+            *Buffer++ = '-';
+        }
+        return FormatUnsigned(static_cast<uint64_t>(Exponent), Buffer);
+    }
+
+    // Lay out Length digits with exponent DecimalExponent as fixed or scientific notation
+    char* FormatDigits(char* Buffer, int32_t Length, int32_t DecimalExponent) noexcept
+    {
+        constexpr int32_t MinExp = -4;
+        constexpr int32_t MaxExp = 15;
+
+        const int32_t K = Length;
+        const int32_t N = Length + DecimalExponent;
+
+        if (K <= N && N <= MaxExp)
+        {
+            // digits[000].0
+            std::memset(Buffer + K, '0', static_cast<size_t>(N - K));
+            Buffer[N] = '.';
+            Buffer[N + 1] = '0';
+            return Buffer + N + 2;
+        }
+        if (0 < N && N <= MaxExp)
+        {
+            // dig.its
+            std::memmove(Buffer + N + 1, Buffer + N, static_cast<size_t>(K - N));
+            Buffer[N] = '.';
+            return Buffer + K + 1;
+        }
+        if (MinExp < N && N <= 0)
+        {
+            // 0.[000]digits
+            std::memmove(Buffer + 2 - N, Buffer, static_cast<size_t>(K));
+            Buffer[0] = '0';
+            Buffer[1] = '.';
+            std::memset(Buffer + 2, '0', static_cast<size_t>(-N));
+            return Buffer + 2 - N + K;
+        }
+
+        if (K == 1)
+        {
+            // dE123
+            Buffer += 1;
+        }
+        else
+        {
+            // d.igitsE123
+            std::memmove(Buffer + 2, Buffer + 1, static_cast<size_t>(K - 1));
+            Buffer[1] = '.';
+            Buffer += 1 + K;
+        }
+        *Buffer++ = 'e';
+        return AppendExponent(Buffer, N - 1);
+    }
+
+    // Whether Result is written back as the digits of Value. Format gives the shortest digits
+    // that read as Result, any other spelling of the number would be lost.
+    bool ReadsBack(const Significand& Value, double Result) noexcept
+    {
+        if (Value.Mantissa == 0)
+            return true;
+        if (Value.Truncated || Result == 0.0 || Result - Result != 0.0)
+            return false;
+
+        uint64_t Mantissa = Value.Mantissa;
+        int64_t Exponent10 = Value.Exponent10;
+        uint32_t Digits = Value.Digits;
+        for (; Mantissa % 10 == 0; Mantissa /= 10, ++Exponent10, --Digits) {}
+
+        // Every decimal of up to 15 digits survives a normal double
+        Result = std::fabs(Result);
+        if (Digits <= 15 && Result >= std::numeric_limits<double>::min())
+            return true;
+
+        char Shortest[NumberConverter::BufferSize];
+        int32_t Length;
+        int32_t DecimalExponent;
+        if (!Grisu3(Shortest, Length, DecimalExponent, Result))
+        {
+            Grisu2(Shortest, Length, DecimalExponent, Result);
+            Shorten(Shortest, Length, DecimalExponent, Result);
+        }
+        for (; Length > 1 && Shortest[Length - 1] == '0'; --Length, ++DecimalExponent) {}
+
+        char Expected[NumberConverter::BufferSize];
+        return DecimalExponent == Exponent10 && FormatUnsigned(Mantissa, Expected) - Expected == Length
+            && std::memcmp(Shortest, Expected, static_cast<size_t>(Length)) == 0;
+    }
+
+    const char* ParseNumber(const char* First, const char* Last, JsonNumeric& OutNumber, bool KeepText)
+    {
+        auto _First = First;
+        bool Negative = false;
+        if (_First != Last && IsSign(*_First))
+            Negative = (*_First++ == '-');
+
+        // Integral part
+        const char* IntegralFirst = _First;
+        uint64_t Integer = 0;
+        bool Overflow = false;
+        for (; _First != Last && IsDigit(*_First); ++_First)
+        {
+            const uint64_t Digit = static_cast<uint64_t>(*_First - '0');
+            Overflow |= (Integer > (std::numeric_limits<uint64_t>::max() - Digit) / 10);
+            Integer = Integer * 10 + Digit;
+        }
+        const char* IntegralLast = _First;
+        if (IntegralFirst == IntegralLast)
+            return nullptr;
+
+        // Fractional part
+        const char* FractionFirst = _First;
+        const char* FractionLast = _First;
+        if (_First != Last && *_First == '.')
+        {
+            FractionFirst = ++_First;
+            while (_First != Last && IsDigit(*_First)) ++_First;
+            FractionLast = _First;
+            if (FractionFirst == FractionLast)
+                return nullptr;
+        }
+
+        // Exponential part
+        int64_t Exponent = 0;
+        bool HasExponent = false;
+        if (_First != Last && IsExp(*_First))
+        {
+            HasExponent = true;
+            bool NegativeExponent = false;
+            if (++_First != Last && IsSign(*_First))
+                NegativeExponent = (*_First++ == '-');
+
+            const char* ExponentFirst = _First;
+            for (; _First != Last && IsDigit(*_First); ++_First)
+            {
+                if (Exponent < 0x10000000)
+                    Exponent = Exponent * 10 + (*_First - '0');
+            }
+            if (ExponentFirst == _First)
+                return nullptr;
+            if (NegativeExponent)
+                Exponent = -Exponent;
+        }
+
+        // Integers stay exact as long as they fit into 64 bits
+        if (FractionFirst == FractionLast && !HasExponent && !Overflow)
+        {
+            if (!Negative && Integer <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max()))
+            {
+                OutNumber.Type = JsonNumberType::Int64;
+                OutNumber.Int64 = static_cast<int64_t>(Integer);
+                return _First;
+            }
+            if (!Negative)
+            {
+                OutNumber.Type = JsonNumberType::UInt64;
+                OutNumber.UInt64 = Integer;
+                return _First;
+            }
+            if (Integer <= uint64_t(1) << 63)
+            {
+                OutNumber.Type = JsonNumberType::Int64;
+                OutNumber.Int64 = static_cast<int64_t>(0 - Integer);
+                return _First;
+            }
+        }
+
+        Significand Value;
+        Value.Append(IntegralFirst, IntegralLast, false);
+        Value.Append(FractionFirst, FractionLast, true);
+        Value.Exponent10 += Exponent;
+        const double Result = ToDouble(Value, Negative, First, _First);
+
+        // Integers beyond 64 bits and decimals the double does not give back keep the lexeme
+        const bool Integral = FractionFirst == FractionLast && !HasExponent;
+        if (KeepText && (Integral || !ReadsBack(Value, Result)) && static_cast<size_t>(_First - First) <= std::numeric_limits<uint32_t>::max())
+        {
+            OutNumber.Type = JsonNumberType::Text;
+            OutNumber.Length = static_cast<uint32_t>(_First - First);
+            OutNumber.Text = First;
+            return _First;
+        }
+
+        OutNumber.Type = JsonNumberType::Double;
+        OutNumber.Double = Result;
+        return _First;
+    }
+}
+
+const char* NumberConverter::Parse(const char* First, const char* Last, JsonNumeric& OutNumber)
+{
+    return ParseNumber(First, Last, OutNumber, true);
+}
+
+double JsonNumeric::TextToDouble() const noexcept
+{
+    JsonNumeric Number;
+    ParseNumber(Text, Text + Length, Number, false);
+    return Number.Get<double>();
+}
+
+char* NumberConverter::Format(const JsonNumeric& Number, char* Buffer) noexcept
+{
+    switch (Number.Type)
+    {
+    case JsonNumberType::Int64:     return Format(Number.Int64, Buffer);
+    case JsonNumberType::UInt64:    return Format(Number.UInt64, Buffer);
+    case JsonNumberType::Text:      return Format(Number.TextToDouble(), Buffer);
+    default:                        return Format(Number.Double, Buffer);
+    }
+}
+
+char* NumberConverter::Format(int64_t Value, char* Buffer) noexcept
+{
+    uint64_t Magnitude = static_cast<uint64_t>(Value);
+    if (Value < 0)
+    {
+        *Buffer++ = '-';
+        Magnitude = 0 - Magnitude;
+    }
+    return FormatUnsigned(Magnitude, Buffer);
+}
+
+char* NumberConverter::Format(uint64_t Value, char* Buffer) noexcept
+{
+    return FormatUnsigned(Value, Buffer);
+}
+
+char* NumberConverter::Format(double Value, char* Buffer) noexcept
+{
+    if (Value != Value || Value - Value != 0.0)
+    {
+        std::memcpy(Buffer, "null", 4);
+        return Buffer + 4;
+    }
+
+    if (std::signbit(Value))
+    {
+        Value = -Value;
+        *Buffer++ = '-';
+    }
+
+    if (Value == 0.0)
+    {
+        std::memcpy(Buffer, "0.0", 3);
+        return Buffer + 3;
+    }
+
+    int32_t Length;
+    int32_t DecimalExponent;
+    if (!Grisu3(Buffer, Length, DecimalExponent, Value))
+    {
+        Grisu2(Buffer, Length, DecimalExponent, Value);
+        Shorten(Buffer, Length, DecimalExponent, Value);
+    }
+    return FormatDigits(Buffer, Length, DecimalExponent);
+}
+
+std::string NumberConverter::ToString(const JsonNumeric& Number)
+{
+    if (Number.Type == JsonNumberType::Text)
+        return std::string(Number.Text, Number.Length);
+    char Buffer[BufferSize];
+    return std::string(Buffer, Format(Number, Buffer));
+}
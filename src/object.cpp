@@ -0,0 +1,310 @@
+#include "object.h"
+#include "error.h"
+#include <algorithm>
+#include <atomic>
+
+using namespace JSONCPP_NAMESPACE;
+
+namespace {
+    std::atomic<JsonObjectLayout> DefaultLayout(JsonObjectLayout::Sorted);
+}
+
+JsonObjectLayout JsonObjectStorage::GetDefaultLayout() noexcept
+{
+    return DefaultLayout.load(std::memory_order_relaxed);
+}
+
+void JsonObjectStorage::SetDefaultLayout(JsonObjectLayout Layout) noexcept
+{
+    DefaultLayout.store(Layout, std::memory_order_relaxed);
+}
+
+void JsonObjectStorage::SetLayout(JsonObjectLayout Layout)
+{
+    m_Layout = Layout;
+    if (Layout == JsonObjectLayout::Sorted)
+    {
+        std::sort(m_Members.begin(), m_Members.end(), [](const value_type& Lhs, const value_type& Rhs) {
+            return Lhs.first < Rhs.first;
+        });
+    }
+    Reindex();
+}
+
+JsonObjectStorage::mapped_type& JsonObjectStorage::at(JsonStringRef Key)
+{
+    auto Found = find(Key);
+    JSON_ASSERT_MESSAGE(Found != end(), "Identifier \'%.*s\' - not found.", static_cast<int>(Key.Size()), Key.Data());
+    return Found->second;
+}
+
+const JsonObjectStorage::mapped_type& JsonObjectStorage::at(JsonStringRef Key) const
+{
+    auto Found = find(Key);
+    JSON_ASSERT_MESSAGE(Found != end(), "Identifier \'%.*s\' - not found.", static_cast<int>(Key.Size()), Key.Data());
+    return Found->second;
+}
+
+JsonObjectStorage::mapped_type& JsonObjectStorage::at(const JsonKey& Key)
+{
+    auto Found = find(Key);
+    JSON_ASSERT_MESSAGE(Found != end(), "Identifier \'%.*s\' - not found.", static_cast<int>(Key.Size()), Key.Data());
+    return Found->second;
+}
+
+const JsonObjectStorage::mapped_type& JsonObjectStorage::at(const JsonKey& Key) const
+{
+    auto Found = find(Key);
+    JSON_ASSERT_MESSAGE(Found != end(), "Identifier \'%.*s\' - not found.", static_cast<int>(Key.Size()), Key.Data());
+    return Found->second;
+}
+
+JsonObjectStorage::iterator JsonObjectStorage::Search(JsonStringRef Key, uint32_t Hash)
+{
+    bool Found;
+    auto Index = Locate(Key, Hash, Found);
+    return Found ? m_Members.begin() + Index : m_Members.end();
+}
+
+JsonObjectStorage::const_iterator JsonObjectStorage::Search(JsonStringRef Key, uint32_t Hash) const
+{
+    bool Found;
+    auto Index = Locate(Key, Hash, Found);
+    return Found ? m_Members.begin() + Index : m_Members.end();
+}
+
+JsonObjectStorage::mapped_type& JsonObjectStorage::operator[](const key_type& Key)
+{
+    bool Found;
+    auto Position = Locate(Key, Found);
+    if (Found)
+        return m_Members[Position].second;
+    return Emplace(key_type(Key), nullptr).first->second;
+}
+
+JsonObjectStorage::mapped_type& JsonObjectStorage::operator[](key_type&& Key)
+{
+    bool Found;
+    auto Position = Locate(Key, Found);
+    if (Found)
+        return m_Members[Position].second;
+    return Emplace(std::move(Key), nullptr).first->second;
+}
+
+JsonObjectStorage::iterator JsonObjectStorage::erase(const_iterator Where)
+{
+    const auto Position = static_cast<size_type>(Where - m_Members.cbegin());
+    const size_type Last = m_Members.size() - 1;
+    if (!m_Index.empty())
+        EraseSlot(FindSlot(Position));
+
+    if (m_Layout == JsonObjectLayout::Hashed && Position != Last)
+    {
+        // Order is not kept, the last member fills the hole and only its slot changes
+        if (!m_Index.empty())
+            m_Index[FindSlot(Last)].Position = static_cast<uint32_t>(Position + 1);
+        m_Members[Position] = std::move(m_Members.back());
+        m_Members.pop_back();
+    }
+    else
+    {
+        m_Members.erase(Where);
+        for (auto& Entry : m_Index)
+        {
+            if (Entry.Position > Position + 1)
+                --Entry.Position;
+        }
+    }
+
+    if (!m_Index.empty() && !NeedsIndex())
+        m_Index.clear();
+    return m_Members.begin() + Position;
+}
+
+JsonObjectStorage::size_type JsonObjectStorage::erase(JsonStringRef Key)
+{
+    bool Found;
+    auto Position = Locate(Key, Found);
+    if (!Found)
+        return 0;
+    erase(m_Members.cbegin() + Position);
+    return 1;
+}
+
+const JsonObjectStorage::key_type* JsonObjectStorage::Seal()
+{
+    if (m_Layout == JsonObjectLayout::Sorted)
+    {
+        auto Less = [](const value_type& Lhs, const value_type& Rhs) { return Lhs.first < Rhs.first; };
+        if (!std::is_sorted(m_Members.begin(), m_Members.end(), Less))
+            std::stable_sort(m_Members.begin(), m_Members.end(), Less);
+        auto Twice = std::adjacent_find(m_Members.begin(), m_Members.end(), [](const value_type& Lhs, const value_type& Rhs) {
+            return Lhs.first == Rhs.first;
+        });
+        return Twice != m_Members.end() ? &Twice->first : nullptr;
+    }
+
+    Reindex();
+    if (!m_Index.empty())
+    {
+        // Equal names land in one probe run, each member is compared with those before it there
+        const size_t Mask = m_Index.size() - 1;
+        for (size_type Position = 0; Position < m_Members.size(); ++Position)
+        {
+            const JsonStringRef Name(m_Members[Position].first);
+            const uint32_t Hash = Name.Hash();
+            for (size_t Index = Hash & Mask; m_Index[Index].Position != Position + 1; Index = (Index + 1) & Mask)
+            {
+                const Slot& Entry = m_Index[Index];
+                if (Entry.Hash == Hash && JsonStringRef(m_Members[Entry.Position - 1].first) == Name)
+                    return &m_Members[Position].first;
+            }
+        }
+        return nullptr;
+    }
+
+    for (size_type Position = 1; Position < m_Members.size(); ++Position)
+    {
+        for (size_type Other = 0; Other < Position; ++Other)
+        {
+            if (m_Members[Other].first == m_Members[Position].first)
+                return &m_Members[Position].first;
+        }
+    }
+    return nullptr;
+}
+
+bool JsonObjectStorage::operator==(const JsonObjectStorage& Rhs) const
+{
+    if (m_Members.size() != Rhs.m_Members.size())
+        return false;
+    if (m_Layout == JsonObjectLayout::Sorted && Rhs.m_Layout == JsonObjectLayout::Sorted)
+        return m_Members == Rhs.m_Members;
+
+    for (const auto& Member : m_Members)
+    {
+        auto Found = Rhs.find(Member.first);
+        if (Found == Rhs.end() || Found->second != Member.second)
+            return false;
+    }
+    return true;
+}
+
+std::pair<JsonObjectStorage::iterator, bool> JsonObjectStorage::Emplace(key_type&& Key, mapped_type&& Value)
+{
+    bool Found;
+    auto Position = Locate(Key, Found);
+    if (Found)
+        return std::make_pair(m_Members.begin() + Position, false);
+
+    m_Members.emplace(m_Members.begin() + Position, std::move(Key), std::move(Value));
+
+    // Only Sorted inserts in the middle, and it never keeps an index
+    if (!NeedsIndex())
+        return std::make_pair(m_Members.begin() + Position, true);
+    if (m_Index.empty() || m_Members.size() * 2 > m_Index.size())
+    {
+        Reindex();
+    }
+    else
+    {
+        const uint32_t Hash = JsonStringRef(m_Members[Position].first).Hash();
+        const size_t Mask = m_Index.size() - 1;
+        size_t Index = Hash & Mask;
+        while (m_Index[Index].Position != 0)
+            Index = (Index + 1) & Mask;
+        m_Index[Index] = Slot{ Hash, static_cast<uint32_t>(Position + 1) };
+    }
+    return std::make_pair(m_Members.begin() + Position, true);
+}
+
+JsonObjectStorage::size_type JsonObjectStorage::Locate(JsonStringRef Key, uint32_t Hash, bool& Found) const
+{
+    // Sorted - binary search, the position is the insertion point when missing
+    if (m_Layout == JsonObjectLayout::Sorted)
+    {
+        auto Position = std::lower_bound(m_Members.begin(), m_Members.end(), Key, [](const value_type& Member, JsonStringRef Name) {
+            return JsonStringRef(Member.first) < Name;
+        });
+        Found = Position != m_Members.end() && JsonStringRef(Position->first) == Key;
+        return static_cast<size_type>(Position - m_Members.begin());
+    }
+
+    Found = true;
+    if (!m_Index.empty())
+    {
+        const size_t Mask = m_Index.size() - 1;
+        for (size_t Index = Hash & Mask; m_Index[Index].Position != 0; Index = (Index + 1) & Mask)
+        {
+            const Slot& Entry = m_Index[Index];
+            if (Entry.Hash == Hash && JsonStringRef(m_Members[Entry.Position - 1].first) == Key)
+                return Entry.Position - 1;
+        }
+    }
+    else
+    {
+        for (size_type Position = 0; Position < m_Members.size(); ++Position)
+        {
+            if (JsonStringRef(m_Members[Position].first) == Key)
+                return Position;
+        }
+    }
+    Found = false;
+    return m_Members.size();
+}
+
+bool JsonObjectStorage::NeedsIndex() const noexcept
+{
+    return m_Layout == JsonObjectLayout::Hashed || (m_Layout == JsonObjectLayout::Ordered && m_Members.size() > LinearLimit);
+}
+
+size_t JsonObjectStorage::FindSlot(size_type Position) const
+{
+    const size_t Mask = m_Index.size() - 1;
+    size_t Index = JsonStringRef(m_Members[Position].first).Hash() & Mask;
+    while (m_Index[Index].Position != Position + 1)
+        Index = (Index + 1) & Mask;
+    return Index;
+}
+
+void JsonObjectStorage::EraseSlot(size_t Index) noexcept
+{
+    // Backward shift - later entries of the run move into the hole unless that would put
+    // them before their home slot
+    const size_t Mask = m_Index.size() - 1;
+    size_t Hole = Index;
+    for (size_t Next = (Hole + 1) & Mask; m_Index[Next].Position != 0; Next = (Next + 1) & Mask)
+    {
+        const size_t Home = m_Index[Next].Hash & Mask;
+        if (((Next - Home) & Mask) >= ((Next - Hole) & Mask))
+        {
+            m_Index[Hole] = m_Index[Next];
+            Hole = Next;
+        }
+    }
+    m_Index[Hole] = Slot{ 0, 0 };
+}
+
+void JsonObjectStorage::Reindex()
+{
+    if (!NeedsIndex())
+    {
+        m_Index.clear();
+        return;
+    }
+
+    size_t Capacity = 16;
+    while (Capacity < m_Members.size() * 2)
+        Capacity *= 2;
+    m_Index.assign(Capacity, Slot{ 0, 0 });
+
+    const size_t Mask = Capacity - 1;
+    for (size_type Position = 0; Position < m_Members.size(); ++Position)
+    {
+        const uint32_t Hash = JsonStringRef(m_Members[Position].first).Hash();
+        size_t Index = Hash & Mask;
+        while (m_Index[Index].Position != 0)
+            Index = (Index + 1) & Mask;
+        m_Index[Index] = Slot{ Hash, static_cast<uint32_t>(Position + 1) };
+    }
+}
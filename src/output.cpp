@@ -0,0 +1,319 @@
+#include "output.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <limits>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <sys/uio.h>
+    #include <unistd.h>
+#elif defined(_WIN32)
+    #include <io.h>
+#endif
+
+using namespace JSONCPP_NAMESPACE;
+
+namespace {
+    // Writes everything or returns the errno of the failure
+    int WriteAll(int Descriptor, const char* Data, size_t Length) noexcept
+    {
+        while (Length > 0)
+        {
+#if defined(_WIN32)
+            const unsigned int Chunk = static_cast<unsigned int>(std::min<size_t>(Length, std::numeric_limits<int>::max()));
+            const auto Written = ::_write(Descriptor, Data, Chunk);
+#else
+            const auto Written = ::write(Descriptor, Data, Length);
+#endif
+            if (Written < 0 && errno == EINTR)
+                continue;
+            if (Written <= 0)
+                return Written < 0 ? errno : EIO;
+            Data += Written;
+            Length -= static_cast<size_t>(Written);
+        }
+        return 0;
+    }
+
+    // Gathers up to Count blocks into one system call, continuing after short writes
+    template<class Block>
+    int WriteBlocks(int Descriptor, const Block* Blocks, size_t Count) noexcept
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        constexpr size_t MaxVectors = 64;
+        iovec Vectors[MaxVectors];
+        while (Count > 0)
+        {
+            const size_t Used = std::min(Count, MaxVectors);
+            for (size_t Index = 0; Index < Used; ++Index)
+            {
+                Vectors[Index].iov_base = Blocks[Index].Data;
+                Vectors[Index].iov_len = Blocks[Index].Length;
+            }
+
+            iovec* First = Vectors;
+            size_t Remaining = Used;
+            while (Remaining > 0)
+            {
+                const auto Written = ::writev(Descriptor, First, static_cast<int>(Remaining));
+                if (Written < 0 && errno == EINTR)
+                    continue;
+                if (Written <= 0)
+                    return Written < 0 ? errno : EIO;
+
+                size_t Done = static_cast<size_t>(Written);
+                while (Remaining > 0 && Done >= First->iov_len)
+                {
+                    Done -= First->iov_len;
+                    ++First;
+                    --Remaining;
+                }
+                if (Remaining > 0)
+                {
+                    First->iov_base = static_cast<char*>(First->iov_base) + Done;
+                    First->iov_len -= Done;
+                }
+            }
+            Blocks += Used;
+            Count -= Used;
+        }
+        return 0;
+#else
+        for (; Count > 0; ++Blocks, --Count)
+        {
+            if (const int Error = WriteAll(Descriptor, Blocks->Data, Blocks->Length))
+                return Error;
+        }
+        return 0;
+#endif
+    }
+}
+
+void JsonStreamSink::Write(const char* Data, size_t Length)
+{
+    m_Stream.write(Data, static_cast<std::streamsize>(Length));
+}
+
+void JsonFileSink::Write(const char* Data, size_t Length)
+{
+    JSON_ASSERT_MESSAGE(WriteAll(m_Descriptor, Data, Length) == 0, "Cannot write to file descriptor %d.", m_Descriptor);
+}
+
+constexpr size_t JsonAsyncFileSink::BlockAlignment;
+
+JsonAsyncFileSink::JsonAsyncFileSink(int Descriptor, size_t BlockSize, uint32_t BlockCount)
+    : m_Descriptor(Descriptor)
+{
+    BlockCount = std::max<uint32_t>(BlockCount, 2);
+    m_BlockSize = (std::max<size_t>(BlockSize, BlockAlignment) + BlockAlignment - 1) & ~(BlockAlignment - 1);
+    m_Storage.reset(new char[m_BlockSize * BlockCount + BlockAlignment]);
+
+    const auto Address = reinterpret_cast<uintptr_t>(m_Storage.get());
+    char* Block = m_Storage.get() + ((BlockAlignment - Address % BlockAlignment) % BlockAlignment);
+    for (uint32_t Index = 0; Index < BlockCount; ++Index, Block += m_BlockSize)
+        m_Free.push_back(Block);
+
+    m_Thread = std::thread(&JsonAsyncFileSink::Run, this);
+}
+
+JsonAsyncFileSink::~JsonAsyncFileSink()
+{
+    {
+        std::lock_guard<std::mutex> Lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_Queued.notify_one();
+    m_Thread.join();
+}
+
+void JsonAsyncFileSink::Write(const char* Data, size_t Length)
+{
+    // Bytes the caller keeps cannot wait in line, the queue goes first to keep the order
+    Sync();
+    const int Error = WriteAll(m_Descriptor, Data, Length);
+    JSON_ASSERT_MESSAGE(Error == 0, "Cannot write to file descriptor %d.", m_Descriptor);
+}
+
+char* JsonAsyncFileSink::Acquire(size_t& Capacity)
+{
+    std::unique_lock<std::mutex> Lock(m_Mutex);
+    return TakeFree(Lock, Capacity);
+}
+
+char* JsonAsyncFileSink::Submit(char* Data, size_t Length, size_t& Capacity)
+{
+    std::unique_lock<std::mutex> Lock(m_Mutex);
+    if (Length > 0 && m_Error == 0)
+    {
+        m_Pending.push_back({ Data, Length });
+        m_Queued.notify_one();
+    }
+    else
+    {
+        m_Free.push_back(Data);
+    }
+    return TakeFree(Lock, Capacity);
+}
+
+void JsonAsyncFileSink::Release(char* Block) noexcept
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    m_Free.push_back(Block);
+}
+
+void JsonAsyncFileSink::Sync()
+{
+    std::unique_lock<std::mutex> Lock(m_Mutex);
+    m_Written.wait(Lock, [this]() { return (m_Pending.empty() && !m_Writing) || m_Error != 0; });
+    JSON_ASSERT_MESSAGE(m_Error == 0, "Cannot write to file descriptor %d.", m_Descriptor);
+}
+
+char* JsonAsyncFileSink::TakeFree(std::unique_lock<std::mutex>& Lock, size_t& Capacity)
+{
+    m_Written.wait(Lock, [this]() { return !m_Free.empty() || m_Error != 0; });
+    JSON_ASSERT_MESSAGE(m_Error == 0, "Cannot write to file descriptor %d.", m_Descriptor);
+
+    char* Block = m_Free.back();
+    m_Free.pop_back();
+    Capacity = m_BlockSize;
+    return Block;
+}
+
+void JsonAsyncFileSink::Run()
+{
+    std::vector<Block> Batch;
+    std::unique_lock<std::mutex> Lock(m_Mutex);
+    for (;;)
+    {
+        m_Queued.wait(Lock, [this]() { return !m_Pending.empty() || m_Stop; });
+        if (m_Pending.empty())
+            return;
+
+        // Everything queued by now goes out in one call
+        Batch.assign(m_Pending.begin(), m_Pending.end());
+        m_Pending.clear();
+        m_Writing = true;
+        Lock.unlock();
+
+        const int Error = WriteBlocks(m_Descriptor, Batch.data(), Batch.size());
+
+        Lock.lock();
+        if (m_Error == 0)
+            m_Error = Error;
+        for (const auto& Written : Batch)
+            m_Free.push_back(Written.Data);
+        m_Writing = false;
+        m_Written.notify_all();
+    }
+}
+
+JsonOutputBuffer::JsonOutputBuffer(JsonOutputSink* Sink, size_t Capacity)
+    : m_Sink(Sink)
+{
+    Capacity = std::max<size_t>(Capacity, 64);
+    m_First = Sink != nullptr ? Sink->Acquire(Capacity) : nullptr;
+    if (m_First == nullptr)
+    {
+        m_Storage.reset(new char[Capacity]);
+        m_First = m_Storage.get();
+    }
+    m_Cursor = m_First;
+    m_Last = m_First + Capacity;
+}
+
+JsonOutputBuffer::~JsonOutputBuffer()
+{
+    if (!m_Storage)
+        m_Sink->Release(m_First);
+}
+
+void JsonOutputBuffer::Fill(char Char, size_t Count)
+{
+    while (Count > 0)
+    {
+        if (m_Cursor == m_Last)
+            Overflow(1);
+        const size_t Length = std::min(Count, static_cast<size_t>(m_Last - m_Cursor));
+        std::memset(m_Cursor, Char, Length);
+        m_Cursor += Length;
+        Count -= Length;
+    }
+}
+
+void JsonOutputBuffer::Flush()
+{
+    if (m_Sink != nullptr)
+    {
+        Drain(0);
+        m_Sink->Sync();
+    }
+}
+
+void JsonOutputBuffer::Drain(size_t Wanted)
+{
+    if (m_Sink == nullptr)
+        return;
+
+    if (m_Storage)
+    {
+        if (m_Cursor != m_First)
+            m_Sink->Write(m_First, Size());
+    }
+    else if (m_Cursor != m_First || Wanted > 0)
+    {
+        // The block belongs to the sink, it lends the next one in exchange
+        size_t Capacity = Wanted;
+        m_First = m_Sink->Submit(m_First, Size(), Capacity);
+        m_Last = m_First + Capacity;
+    }
+    m_Cursor = m_First;
+}
+
+void JsonOutputBuffer::Overflow(size_t Length)
+{
+    Drain(Length);
+    if (Length <= static_cast<size_t>(m_Last - m_Cursor))
+        return;
+
+    // No sink, or a single reservation larger than the buffer
+    const size_t Used = Size();
+    const size_t Grown = std::max(Capacity() * 2, Used + Length);
+    std::unique_ptr<char[]> Storage(new char[Grown]);
+    std::memcpy(Storage.get(), m_First, Used);
+    if (!m_Storage)
+        m_Sink->Release(m_First);
+    m_Storage = std::move(Storage);
+    m_First = m_Storage.get();
+    m_Cursor = m_First + Used;
+    m_Last = m_First + Grown;
+}
+
+void JsonOutputBuffer::PutLarge(const char* Data, size_t Length)
+{
+    if (m_Sink != nullptr && !m_Storage)
+    {
+        // A lent block stays in use, large data is copied through it block by block
+        while (Length > 0)
+        {
+            if (m_Cursor == m_Last)
+                Overflow(1);
+            const size_t Part = std::min(Length, static_cast<size_t>(m_Last - m_Cursor));
+            std::memcpy(m_Cursor, Data, Part);
+            m_Cursor += Part;
+            Data += Part;
+            Length -= Part;
+        }
+        return;
+    }
+
+    // Blocks larger than the buffer go to the sink directly
+    if (m_Sink != nullptr && Length >= Capacity())
+    {
+        Drain(0);
+        m_Sink->Write(Data, Length);
+        return;
+    }
+    Overflow(Length);
+    std::memcpy(m_Cursor, Data, Length);
+    m_Cursor += Length;
+}
@@ -0,0 +1,182 @@
+#include "parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <iterator>
+#include <limits>
+#include <thread>
+
+using namespace JSONCPP_NAMESPACE;
+
+bool JsonParallelReader::Deserialize(std::shared_ptr<JsonValue>& Root)
+{
+    const uint32_t Threads = ThreadCount();
+    std::vector<Slice> Slices;
+    if (Threads < 2 || !SplitElements(Slices, Threads * SlicesPerThread))
+        return JsonBufferReader::Deserialize(Root);
+
+    std::vector<std::shared_ptr<JsonValue>> Parts(Slices.size());
+    ParseSlices(Slices, Threads, [&](JsonParallelReader& Reader, size_t Index) {
+        JsonValueBuilder Builder;
+        Builder.StartArray();
+        Reader.ParseElements(Slices[Index].First, Slices[Index].Last, Builder);
+        Builder.EndArray();
+        Parts[Index] = Builder.GetRoot();
+    });
+
+    size_t Total = 0;
+    for (const auto& Part : Parts)
+        Total += Part->AsArray().size();
+
+    // Splice the sub-arrays, only the element pointers move
+    auto Array = std::make_shared<JsonArray>();
+    auto& Elements = Array->AsArray();
+    Elements.reserve(Total);
+    for (auto& Part : Parts)
+    {
+        auto& Source = Part->AsArray();
+        Elements.insert(Elements.end(), std::make_move_iterator(Source.begin()), std::make_move_iterator(Source.end()));
+    }
+    Root = std::move(Array);
+    return true;
+}
+
+bool JsonParallelReader::Deserialize(JsonDocument& Document)
+{
+    const uint32_t Threads = ThreadCount();
+    std::vector<Slice> Slices;
+    if (Threads < 2 || !SplitElements(Slices, Threads * SlicesPerThread))
+        return JsonBufferReader::Deserialize(Document);
+
+    // Every slice builds into a document of its own, no arena is shared between threads.
+    // Interned names live in the arena of their slice and are adopted with it.
+    std::vector<JsonDocument> Parts(Slices.size());
+    for (auto& Part : Parts)
+    {
+        Part.SetKeyInterning(Document.IsKeyInterning());
+        Part.SetSharedKeys(Document.GetSharedKeys());
+    }
+    ParseSlices(Slices, Threads, [&](JsonParallelReader& Reader, size_t Index) {
+        JsonDocumentBuilder Builder(Parts[Index]);
+        Builder.StartArray();
+        Reader.ParseElements(Slices[Index].First, Slices[Index].Last, Builder);
+        Builder.EndArray();
+    });
+
+    size_t Total = 0;
+    for (const auto& Part : Parts)
+        Total += Part.GetRoot().Size();
+    JSON_ASSERT_MESSAGE(Total <= std::numeric_limits<JsonNode::SizeType>::max(), "Array is too large.");
+
+    // Splice the element nodes, strings and nested containers stay in the adopted chunks
+    Document.Clear();
+    auto& Arena = Document.GetArena();
+    auto Elements = Total > 0 ? Arena.Allocate<JsonNode>(Total) : nullptr;
+    auto Out = Elements;
+    for (auto& Part : Parts)
+    {
+        const auto& Root = Part.GetRoot();
+        if (!Root.Empty())
+            std::memcpy(static_cast<void*>(Out), Root.Begin(), sizeof(JsonNode) * Root.Size());
+        Out += Root.Size();
+        Arena.Adopt(Part.GetArena());
+    }
+    Document.SetRoot(JsonNode::MakeArray(Elements, static_cast<JsonNode::SizeType>(Total)));
+    return true;
+}
+
+uint32_t JsonParallelReader::ThreadCount() const noexcept
+{
+    if (Size() < MinParallelSize)
+        return 1;
+    return m_Threads > 0 ? m_Threads : std::max(1U, std::thread::hardware_concurrency());
+}
+
+bool JsonParallelReader::SplitElements(std::vector<Slice>& Slices, uint32_t Count) const
+{
+    // The scanner already skips strings and escapes, brackets and commas it yields are structural
+    JsonStructuralScanner Scanner(m_First, m_Last);
+    auto Token = Scanner.Next();
+    if (Token == m_Last || *Token != '[')
+        return false;
+
+    const size_t Step = std::max<size_t>(Size() / Count, 1);
+    auto Begin = Token + 1;
+    auto Cut = Begin + Step;
+    bool Elements = false;
+    uint32_t Depth = 1;
+
+    for (Token = Scanner.Next(); Token != m_Last; Token = Scanner.Next())
+    {
+        switch (*Token)
+        {
+        case '[':  JSON_FALLTHROUGH;
+        case '{':
+            ++Depth;
+            break;
+        case ']':  JSON_FALLTHROUGH;
+        case '}':
+            if (--Depth == 0)
+            {
+                JSON_ASSERT_MESSAGE(*Token == ']', "Expected ']' to close the array.");
+                JSON_ASSERT_MESSAGE(Scanner.Next() == m_Last, "Unexpected data after the root array.");
+                if (Elements)
+                    Slices.push_back(Slice{ Begin, Token });
+                return true;
+            }
+            break;
+        case ',':
+            // Cut at the first top-level comma past the slice size
+            if (Depth == 1 && Token >= Cut)
+            {
+                Slices.push_back(Slice{ Begin, Token });
+                Begin = Token + 1;
+                Cut = Token + Step;
+            }
+            break;
+        default:
+            break;
+        }
+        Elements = true;
+    }
+    JSON_ASSERT_MESSAGE(false, "Expected ']' to close the array.");
+    return false;
+}
+
+void JsonParallelReader::ParseSlices(const std::vector<Slice>& Slices, uint32_t Threads, const SliceFunction& Function) const
+{
+    Threads = static_cast<uint32_t>(std::min<size_t>(Threads, Slices.size()));
+
+    std::atomic<size_t>             Next(0);
+    std::vector<std::exception_ptr> Errors(Threads);
+
+    // Slices are taken in order, a worker keeps its reader for every slice it parses
+    auto Worker = [&](uint32_t Thread) {
+        try
+        {
+            JsonParallelReader Reader(nullptr, 0, 1);
+            for (size_t Index = Next++; Index < Slices.size(); Index = Next++)
+                Function(Reader, Index);
+        }
+        catch (...)
+        {
+            Errors[Thread] = std::current_exception();
+            Next = Slices.size();
+        }
+    };
+
+    std::vector<std::thread> Pool;
+    Pool.reserve(Threads);
+    for (uint32_t Thread = 1; Thread < Threads; ++Thread)
+        Pool.emplace_back(Worker, Thread);
+    Worker(0);
+    for (auto& Thread : Pool)
+        Thread.join();
+
+    for (const auto& Error : Errors)
+    {
+        if (Error)
+            std::rethrow_exception(Error);
+    }
+}
@@ -1,45 +1,38 @@
 #include "reader.h"
+#include "document.h"
 #include "utils.h"
 #include "utf.h"
+#include "simd.h"
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #define JSON_MMAP_POSIX
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#elif defined(_WIN32)
+    #define JSON_MMAP_WINDOWS
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif // NOMINMAX
+    #include <windows.h>
+#endif
 
 using namespace JSONCPP_NAMESPACE;
 
-void JsonReader::Parse(const char* First, const char* Last, ParseState& OutState)
+void JsonReader::BeginParse()
 {
     // Json document starts with Object or Array
+    while (!m_ParseProcessState.empty())
+        m_ParseProcessState.pop();
+    m_PrevToken = 0;
     SetExpectedToken(JsonTokenType::ObjectBegin, JsonTokenType::ArrayBegin);
+}
 
-    while (First != Last)
-    {
-        // Skip Whitespace
-        First = SkipWhiteSpace(First, Last);
-
-        if (First == Last) break;
-
-        if (IsJsonNumber(*First))
-        {
-            First = ParseNumber(First, Last);
-        }
-        else
-        {
-            switch (*First)
-            {
-            case ',': First = ParseComma(First, Last); break;
-            case ':': First = ParseColon(First, Last); break;
-            case 'n': First = ParseNull(First, Last); break;
-            case 't': JSON_FALLTHROUGH;
-            case 'f': First = ParseBoolean(First, Last); break;
-            case '"': First = ParseString(First, Last); break;
-            case '[': JSON_FALLTHROUGH;
-            case ']': First = ParseArray(First, Last, OutState); break;
-            case '{': JSON_FALLTHROUGH;
-            case '}': First = ParseObject(First, Last, OutState); break;
-            default: JSON_ASSERT_MESSAGE(false, "Invalid json token.");
-            }
-        }
-    }
-
-    JSON_ASSERT(m_ParseProcessState.empty());
+void JsonReader::EndParse()
+{
+    JSON_ASSERT_MESSAGE(m_ParseProcessState.empty(), "Unexpected end of file.");
     JSON_ASSERT_MESSAGE(MatchExpectedToken(JsonTokenType::EndFile), "End of file expected.");
 }
 
@@ -51,13 +44,6 @@ bool JsonReader::MatchExpectedToken(JsonTokenType Token) const noexcept
     return (m_ExpectedToken == uint16_t(JsonTokenType::EndFile));
 }
 
-const char* JsonReader::SkipWhiteSpace(const char* First, const char* Last) const
-{
-    while (First != Last && IsWhiteSpace(*First))
-        ++First;
-    return First;
-}
-
 // Parse Colon token
 const char* JsonReader::ParseColon(const char* First, const char* Last)
 {
@@ -90,9 +76,6 @@ const char* JsonReader::ParseNull(const char* First, const char* Last)
     JSON_ASSERT_MESSAGE(MatchExpectedToken(JsonTokenType::Null), "Null value unexpected.");
     JSON_ASSERT_MESSAGE(IsJsonNull(First, Last), "Invalid null value.");
 
-    // Append Null
-    AppendJsonValue(std::make_shared<JsonNull>());
-
     // Update next expected token
     SetExpectedToken(JsonTokenType::Comma);
     if (IsProcessedType(JsonType::Object))
@@ -106,14 +89,12 @@ const char* JsonReader::ParseNull(const char* First, const char* Last)
 }
 
 // Parse Boolean token
-const char* JsonReader::ParseBoolean(const char* First, const char* Last)
+const char* JsonReader::ParseBoolean(const char* First, const char* Last, bool& OutBool)
 {
     JSON_ASSERT_MESSAGE(MatchExpectedToken(JsonTokenType::Boolean), "Boolean value unexpected.");
     JSON_ASSERT_MESSAGE(IsJsonBoolean(First, Last), "Invalid boolean value.");
 
-    // Append Boolean
-    bool IsTrue = (*First == 't');
-    AppendJsonValue(std::make_shared<JsonBoolean>(IsTrue));
+    OutBool = (*First == 't');
 
     // Update next expected token
     SetExpectedToken(JsonTokenType::Comma);
@@ -124,34 +105,17 @@ const char* JsonReader::ParseBoolean(const char* First, const char* Last)
     else
         SetExpectedToken(JsonTokenType::EndFile);
 
-    return First + (IsTrue ? 4 : 5);
+    return First + (OutBool ? 4 : 5);
 }
 
 // Parse Number token
-const char* JsonReader::ParseDigits(const char* First, const char* Last) const
-{
-    if (IsSign(*First)) ++First;
-    while (First != Last && IsDigit(*First)) ++First;
-    return First;
-}
-
-const char* JsonReader::ParseNumber(const char* First, const char* Last)
+const char* JsonReader::ParseNumber(const char* First, const char* Last, JsonNumeric& OutNumber)
 {
     JSON_ASSERT_MESSAGE(MatchExpectedToken(JsonTokenType::Number), "Number value unexpected.");
 
-    // Integral part
-    auto _Last = ParseDigits(First, Last);
-
-    // Fractional part
-    if (_Last != Last && *_Last == '.')
-        _Last = ParseDigits(++_Last, Last);
-
-    // Exponential part
-    if (_Last != Last && IsExp(*_Last))
-        _Last = ParseDigits(++_Last, Last);
-
-    // Append Number
-    AppendJsonValue(std::make_shared<JsonNumber>(std::string(First, _Last)));
+    // Convert once, the lexeme is only kept when no binary type holds the number
+    auto _Last = NumberConverter::Parse(First, Last, OutNumber);
+    JSON_ASSERT_MESSAGE(_Last != nullptr, "Invalid number value.");
 
     // Update next expected token
     SetExpectedToken(JsonTokenType::Comma);
@@ -166,7 +130,7 @@ const char* JsonReader::ParseNumber(const char* First, const char* Last)
 }
 
 // Parse String token
-const char* JsonReader::ParseUnicode(const char* First, const char* Last, uint32_t& CodePoint) const
+const char* JsonReader::ParseUnicode(const char* First, const char* Last, uint32_t& CodePoint)
 {
     JSON_ASSERT_MESSAGE((Last - First > 3) , "Invalid unicode sequence.");
 
@@ -182,66 +146,37 @@ const char* JsonReader::ParseUnicode(const char* First, const char* Last, uint32
     return First;
 }
 
-const char* JsonReader::ParseString(const char* First, const char* Last)
+const char* JsonReader::ParseString(const char* First, const char* Last, JsonStringRef& OutString, bool& OutIdentifier)
 {
     JSON_ASSERT_MESSAGE(MatchExpectedToken(JsonTokenType::String), "String value unexpected.");
 
     auto _First = ++First;  // Skip character " - string begin
-    std::string String;
-
-    // Find end String character
-    while (_First != Last)
+    auto Run = Simd::FindQuoteOrBackslash(_First, Last);
+    if (Run != Last && *Run == '\"')
     {
-        if (*_First == '\"')
-            break;
-
-        if (*_First == '\\')
-        {
-            ++_First;
-            if (_First == Last) break;
-            switch (*_First)
-            {
-            case '\"': JSON_FALLTHROUGH;
-            case '\\': JSON_FALLTHROUGH;
-            case '/': String += *_First; break;
-            case 'f': String += '\f'; break;
-            case 'r': String += '\r'; break;
-            case 'n': String += '\n'; break;
-            case 'b': String += '\b'; break;
-            case 't': String += '\t'; break;
-            case 'u':
-            {
-                uint32_t CodePoint;
-                _First = ParseUnicode(++_First, Last, CodePoint) - 1;
-                String += Utf8::Encode(CodePoint);
-                break;
-            }
-            default:
-                JSON_ASSERT_MESSAGE(false, "Invalid escape character in string.");
-            }
-        }
-        else
-        {
-            String += *_First;
-        }
-        ++_First;
+        // Nothing to unescape - refer to the input directly
+        OutString = JsonStringRef(_First, static_cast<size_t>(Run - _First));
+        _First = Run;
+    }
+    else
+    {
+        _First = UnescapeString(_First, Last, m_StringBuffer);
+        OutString = JsonStringRef(m_StringBuffer.data(), m_StringBuffer.size());
     }
 
     JSON_ASSERT_MESSAGE(_First != Last, "Unexpected end of string.");
 
-    // Append String or Identifier
-    if (m_PrevToken & static_cast<uint32_t>(JsonTokenType::Colon))
-        AppendJsonValue(std::make_shared<JsonString>(std::move(String)));
-    else
-        AppendJsonIdentifier(std::move(String));
+    // String or Identifier - only an object member name is not preceded by a colon
+    const bool IsIdentifier = IsProcessedType(JsonType::Object) && !(m_PrevToken & static_cast<uint32_t>(JsonTokenType::Colon));
+    OutIdentifier = IsIdentifier;
 
     // Update next expected token
     if (IsProcessedType(JsonType::Object))
     {
-        if (m_PrevToken & static_cast<uint32_t>(JsonTokenType::Colon))
-            SetExpectedToken(JsonTokenType::Comma, JsonTokenType::ObjectEnd);
-        else
+        if (IsIdentifier)
             SetExpectedToken(JsonTokenType::Colon);
+        else
+            SetExpectedToken(JsonTokenType::Comma, JsonTokenType::ObjectEnd);
     }
     else if (IsProcessedType(JsonType::Array))
         SetExpectedToken(JsonTokenType::Comma, JsonTokenType::ArrayEnd);
@@ -251,8 +186,65 @@ const char* JsonReader::ParseString(const char* First, const char* Last)
     return ++_First; // Skip character " - string end
 }
 
+const char* JsonReader::UnescapeString(const char* First, const char* Last, std::string& String)
+{
+    auto _First = First;
+    String.clear();
+
+    // Find end String character
+    while (true)
+    {
+        // Copy the whole run of unescaped characters at once
+        auto Run = Simd::FindQuoteOrBackslash(_First, Last);
+        String.append(_First, Run);
+        _First = Run;
+
+        if (_First == Last || *_First == '\"')
+            break;
+
+        // *_First == '\\'
+        if (++_First == Last) break;
+        switch (*_First)
+        {
+        case '\"': JSON_FALLTHROUGH;
+        case '\\': JSON_FALLTHROUGH;
+        case '/': String += *_First; break;
+        case 'f': String += '\f'; break;
+        case 'r': String += '\r'; break;
+        case 'n': String += '\n'; break;
+        case 'b': String += '\b'; break;
+        case 't': String += '\t'; break;
+        case 'u':
+        {
+            uint32_t CodePoint;
+            _First = ParseUnicode(++_First, Last, CodePoint);
+
+            // High surrogate followed by a low one encodes a single code point
+            if (CodePoint >= 0xD800U && CodePoint < 0xDC00U && Last - _First > 5 && _First[0] == '\\' && _First[1] == 'u')
+            {
+                uint32_t LowSurrogate;
+                auto _Next = ParseUnicode(_First + 2, Last, LowSurrogate);
+                if (LowSurrogate >= 0xDC00U && LowSurrogate < 0xE000U)
+                {
+                    CodePoint = 0x10000U + ((CodePoint - 0xD800U) << 10U) + (LowSurrogate - 0xDC00U);
+                    _First = _Next;
+                }
+            }
+
+            Utf8::Encode(CodePoint, std::back_inserter(String));
+            continue;
+        }
+        default:
+            JSON_ASSERT_MESSAGE(false, "Invalid escape character in string.");
+        }
+        ++_First;
+    }
+
+    return _First;
+}
+
 // Parse Array token
-const char* JsonReader::ParseArray(const char* First, const char* Last, ParseState& OutState)
+const char* JsonReader::ParseArray(const char* First, const char* Last)
 {
     auto _Last = First + 1;
     if (*First == '[')
@@ -260,7 +252,7 @@ const char* JsonReader::ParseArray(const char* First, const char* Last, ParseSta
         JSON_ASSERT_MESSAGE(MatchExpectedToken(JsonTokenType::ArrayBegin), "Array begin unexpected.");
 
         // Open Array
-        m_ParseProcessState.emplace(ParseState(JsonType::Array));
+        m_ParseProcessState.push(JsonType::Array);
 
         // Update next expected token
         SetExpectedToken(JsonTokenType::AnyValue, JsonTokenType::ArrayEnd);
@@ -270,12 +262,7 @@ const char* JsonReader::ParseArray(const char* First, const char* Last, ParseSta
         JSON_ASSERT_MESSAGE(MatchExpectedToken(JsonTokenType::ArrayEnd), "Array end unexpected.");
 
         // Close Array
-        auto State = m_ParseProcessState.top();
         m_ParseProcessState.pop();
-        if (m_ParseProcessState.empty())
-            OutState = State;
-        else
-            AppendJsonValue(State.Array);
 
         // Update next expected token
         SetExpectedToken(JsonTokenType::Comma);
@@ -291,7 +278,7 @@ const char* JsonReader::ParseArray(const char* First, const char* Last, ParseSta
 }
 
 // Parse Object token
-const char* JsonReader::ParseObject(const char* First, const char* Last, ParseState& OutState)
+const char* JsonReader::ParseObject(const char* First, const char* Last)
 {
     auto _Last = First + 1;
     if (*First == '{')
@@ -299,7 +286,7 @@ const char* JsonReader::ParseObject(const char* First, const char* Last, ParseSt
         JSON_ASSERT_MESSAGE(MatchExpectedToken(JsonTokenType::ObjectBegin), "Object begin unexpected.");
 
         // Open Object
-        m_ParseProcessState.emplace(ParseState(JsonType::Object));
+        m_ParseProcessState.push(JsonType::Object);
 
         // Update next expected token
         SetExpectedToken(JsonTokenType::String, JsonTokenType::ObjectEnd);
@@ -309,12 +296,7 @@ const char* JsonReader::ParseObject(const char* First, const char* Last, ParseSt
         JSON_ASSERT_MESSAGE(MatchExpectedToken(JsonTokenType::ObjectEnd), "Object end unexpected.");
 
         // Close Object
-        auto State = m_ParseProcessState.top();
         m_ParseProcessState.pop();
-        if (m_ParseProcessState.empty())
-            OutState = State;
-        else
-            AppendJsonValue(State.Object);
 
         // Update next expected token
         SetExpectedToken(JsonTokenType::Comma);
@@ -331,64 +313,233 @@ const char* JsonReader::ParseObject(const char* First, const char* Last, ParseSt
 
 bool JsonReader::IsProcessedType(JsonType Type) const
 {
-    return m_ParseProcessState.empty() ? false : m_ParseProcessState.top().Type == Type;
+    return m_ParseProcessState.empty() ? false : m_ParseProcessState.top() == Type;
 }
 
-void JsonReader::AppendJsonValue(std::shared_ptr<JsonValue> Value)
+void JsonValueBuilder::Key(JsonStringRef Value)
+{
+    JSON_ASSERT(!m_ParseProcessState.empty());
+    m_ParseProcessState.top().Identifier.assign(Value.Data(), Value.Size());
+}
+
+void JsonValueBuilder::AppendJsonValue(std::shared_ptr<JsonValue> Value)
 {
     JSON_ASSERT(!m_ParseProcessState.empty());
     ParseState& Current = m_ParseProcessState.top();
     if (Current.Type == JsonType::Object)
-    {
-        auto Found = Current.Object->Find(Current.Identifier);
-        JSON_ASSERT_MESSAGE(
-            Found == Current.Object->CEnd(),
-            "A member with the name '%s' already exists.", 
-            Current.Identifier.c_str()
-        );
-        Current.Object->Emplace(std::move(Current.Identifier), std::move(Value));
-    }
+        Current.Members->Append(std::move(Current.Identifier), std::move(Value));
     else
     {
         Current.Array->PushBack(std::move(Value));
     }
 }
 
-void JsonReader::AppendJsonIdentifier(std::string&& String)
+void JsonValueBuilder::CloseJsonValue()
 {
     JSON_ASSERT(!m_ParseProcessState.empty());
-    ParseState& Current = m_ParseProcessState.top();
-    Current.Identifier = std::move(String);
+    std::shared_ptr<JsonValue> Value;
+    if (m_ParseProcessState.top().Type == JsonType::Object)
+    {
+        // Names are checked once the object is complete, inserting each in order would be quadratic
+        auto Duplicate = m_ParseProcessState.top().Members->Seal();
+        JSON_ASSERT_MESSAGE(Duplicate == nullptr, "A member with the name '%s' already exists.", Duplicate->c_str());
+        Value = std::move(m_ParseProcessState.top().Object);
+    }
+    else
+        Value = std::move(m_ParseProcessState.top().Array);
+    m_ParseProcessState.pop();
+
+    if (m_ParseProcessState.empty())
+        m_Root = std::move(Value);
+    else
+        AppendJsonValue(std::move(Value));
+}
+
+bool JsonReader::ParseValue(const char* First, const char* Last, std::shared_ptr<JsonValue>& Root)
+{
+    JsonValueBuilder Builder;
+    Parse(First, Last, Builder);
+
+    auto Value = Builder.GetRoot();
+    if (Value == nullptr)
+        return false;
+    Root = std::move(Value);
+    return true;
+}
+
+bool JsonReader::ParseDocument(const char* First, const char* Last, JsonDocument& Document)
+{
+    Document.Clear();
+    JsonDocumentBuilder Builder(Document);
+    Parse(First, Last, Builder);
+    return !Document.Empty();
 }
 
 bool JsonStringReader::Deserialize(std::shared_ptr<JsonValue>& Root)
 {
-    ParseState OutState;
-    JsonReader::Parse(m_Content.c_str(), m_Content.c_str() + m_Content.size(), OutState);
+    return ParseValue(m_Content.data(), m_Content.data() + m_Content.size(), Root);
+}
 
-    switch (OutState.Type)
+bool JsonStringReader::Deserialize(JsonDocument& Document)
+{
+    return ParseDocument(m_Content.data(), m_Content.data() + m_Content.size(), Document);
+}
+
+void JsonPushReader::Feed(const char* Data, size_t Length)
+{
+    if (!m_Started)
     {
-    case JsonType::Object:
+        Reset();
+        BeginParse();
+        m_Started = true;
+    }
+
+    const char* First = Data;
+    const char* Last = Data + Length;
+    if (!m_Pending.empty())
     {
-        if (OutState.Object == nullptr) return false;
-        Root = std::move(OutState.Object);
-        break;
+        // A pending string cannot end before the next quote, skip rescanning it
+        const bool Unterminated = m_Pending[0] == '\"' && std::memchr(Data, '\"', Length) == nullptr;
+        m_Pending.append(Data, Length);
+        if (Unterminated)
+            return;
+        First = m_Pending.data();
+        Last = First + m_Pending.size();
     }
-    case JsonType::Array:
-        if (OutState.Array == nullptr) return false;
-        Root = std::move(OutState.Array);
-        break;
-    default:
+
+    auto Stop = ParseChunk(First, Last, m_Builder, false);
+    if (m_Pending.empty())
+        m_Pending.assign(Stop, Last);
+    else
+        m_Pending.erase(0, static_cast<size_t>(Stop - First));
+}
+
+void JsonPushReader::Finish()
+{
+    if (!m_Started)
+        BeginParse();
+    ParseChunk(m_Pending.data(), m_Pending.data() + m_Pending.size(), m_Builder, true);
+    EndParse();
+
+    m_Pending.clear();
+    m_Started = false;
+    m_Finished = true;
+}
+
+void JsonPushReader::Reset()
+{
+    m_Document.Clear();
+    m_Builder.Reset();
+    m_Pending.clear();
+    m_Started = false;
+    m_Finished = false;
+}
+
+bool JsonPushReader::Deserialize(std::shared_ptr<JsonValue>& Root)
+{
+    if (!m_Finished || m_Document.Empty())
         return false;
-    }
+    Root = m_Document.GetRoot().ToValue();
+    return Root != nullptr;
+}
+
+bool JsonPushReader::Deserialize(JsonDocument& Document)
+{
+    if (!m_Finished || m_Document.Empty())
+        return false;
+    Document = std::move(m_Document);
+    m_Document = JsonDocument();
+    m_Finished = false;
     return true;
 }
 
 JsonStreamReader::JsonStreamReader(std::basic_istream<char>& IStream)
 {
-    std::ostringstream Doc;
-    Doc << IStream.rdbuf();
-    m_Content = std::move(Doc.str());
+    // Append straight from the stream buffer, no intermediate ostringstream
+    auto Buffer = IStream.rdbuf();
+    if (Buffer == nullptr)
+        return;
+
+    char Chunk[64 * 1024];
+    std::streamsize Count;
+    while ((Count = Buffer->sgetn(Chunk, sizeof(Chunk))) > 0)
+        m_Content.append(Chunk, static_cast<size_t>(Count));
+}
+
+JsonMappedFileReader::JsonMappedFileReader(const std::string& Path, bool HugePages)
+    : JsonBufferReader(nullptr, 0)
+{
+#if defined(JSON_MMAP_POSIX)
+    const int File = ::open(Path.c_str(), O_RDONLY);
+    JSON_ASSERT_MESSAGE(File >= 0, "Cannot open file '%s'.", Path.c_str());
+
+    struct stat Status;
+    if (::fstat(File, &Status) == 0 && Status.st_size > 0)
+    {
+        m_Length = static_cast<size_t>(Status.st_size);
+        void* Mapping = ::mmap(nullptr, m_Length, PROT_READ, MAP_PRIVATE, File, 0);
+        if (Mapping != MAP_FAILED)
+        {
+            m_Mapping = Mapping;
+            ::madvise(m_Mapping, m_Length, MADV_SEQUENTIAL);
+    #ifdef MADV_HUGEPAGE
+            if (HugePages)
+                ::madvise(m_Mapping, m_Length, MADV_HUGEPAGE);
+    #endif // MADV_HUGEPAGE
+        }
+    }
+    ::close(File);
+#elif defined(JSON_MMAP_WINDOWS)
+    (void)HugePages;
+    HANDLE File = ::CreateFileA(Path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    JSON_ASSERT_MESSAGE(File != INVALID_HANDLE_VALUE, "Cannot open file '%s'.", Path.c_str());
+
+    LARGE_INTEGER FileSize;
+    if (::GetFileSizeEx(File, &FileSize) && FileSize.QuadPart > 0)
+    {
+        HANDLE Mapping = ::CreateFileMappingA(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (Mapping != nullptr)
+        {
+            m_Mapping = ::MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+            m_Length = m_Mapping ? static_cast<size_t>(FileSize.QuadPart) : 0;
+            ::CloseHandle(Mapping);
+        }
+    }
+    ::CloseHandle(File);
+#else
+    (void)HugePages;
+#endif
+
+    if (m_Mapping != nullptr)
+    {
+        m_First = static_cast<const char*>(m_Mapping);
+        m_Last = m_First + m_Length;
+        return;
+    }
+
+    // Mapping unavailable - a single read into memory
+    std::ifstream IStream(Path, std::ios::binary | std::ios::ate);
+    JSON_ASSERT_MESSAGE(IStream.is_open(), "Cannot open file '%s'.", Path.c_str());
+    const auto Length = static_cast<std::streamoff>(IStream.tellg());
+    if (Length > 0)
+    {
+        m_Fallback.resize(static_cast<size_t>(Length));
+        IStream.seekg(0);
+        IStream.read(m_Fallback.data(), Length);
+        m_First = m_Fallback.data();
+        m_Last = m_First + IStream.gcount();
+    }
+}
+
+JsonMappedFileReader::~JsonMappedFileReader()
+{
+    if (m_Mapping == nullptr)
+        return;
+#if defined(JSON_MMAP_POSIX)
+    ::munmap(m_Mapping, m_Length);
+#elif defined(JSON_MMAP_WINDOWS)
+    ::UnmapViewOfFile(m_Mapping);
+#endif
 }
 
 bool Deserializer::operator()(JsonReader& Reader, JsonValue& Root) const
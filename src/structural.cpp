@@ -0,0 +1,236 @@
+#include "structural.h"
+#include "simd.h"
+
+using namespace JSONCPP_NAMESPACE;
+
+namespace {
+#ifndef JSON_SIMD_SSE2
+    // Scalar kernel - portable fallback
+    void ClassifyScalar(const char* First, uint32_t Blocks, JsonStructuralScanner::BlockMasks* OutMasks)
+    {
+        for (uint32_t Block = 0; Block < Blocks; ++Block, First += JsonStructuralScanner::BlockSize)
+        {
+            JsonStructuralScanner::BlockMasks& Masks = OutMasks[Block];
+            Masks = JsonStructuralScanner::BlockMasks{ 0, 0, 0, 0 };
+            for (uint32_t Index = 0; Index < JsonStructuralScanner::BlockSize; ++Index)
+            {
+                const uint64_t Bit = uint64_t(1) << Index;
+                switch (First[Index])
+                {
+                case '"':  Masks.Quote |= Bit; break;
+                case '\\': Masks.Backslash |= Bit; break;
+                case ',':  JSON_FALLTHROUGH;
+                case ':':  JSON_FALLTHROUGH;
+                case '[':  JSON_FALLTHROUGH;
+                case ']':  JSON_FALLTHROUGH;
+                case '{':  JSON_FALLTHROUGH;
+                case '}':  Masks.Operator |= Bit; break;
+                case ' ':  JSON_FALLTHROUGH;
+                case '\t': JSON_FALLTHROUGH;
+                case '\n': JSON_FALLTHROUGH;
+                case '\r': Masks.WhiteSpace |= Bit; break;
+                default: break;
+                }
+            }
+        }
+    }
+#endif // JSON_SIMD_SSE2
+
+#ifdef JSON_SIMD_SSE2
+    // SSE2 kernel - four 16 byte lanes per block
+    void ClassifySSE2(const char* First, uint32_t Blocks, JsonStructuralScanner::BlockMasks* OutMasks)
+    {
+        const __m128i Quote     = _mm_set1_epi8('"');
+        const __m128i Backslash = _mm_set1_epi8('\\');
+        const __m128i Comma     = _mm_set1_epi8(',');
+        const __m128i Colon     = _mm_set1_epi8(':');
+        const __m128i Lower     = _mm_set1_epi8(0x20);
+        const __m128i BraceOpen = _mm_set1_epi8('{');   // '[' | 0x20
+        const __m128i BraceEnd  = _mm_set1_epi8('}');   // ']' | 0x20
+        const __m128i Space     = _mm_set1_epi8(' ');
+        const __m128i Tab       = _mm_set1_epi8('\t');
+        const __m128i NewLine   = _mm_set1_epi8('\n');
+        const __m128i Return    = _mm_set1_epi8('\r');
+
+        for (uint32_t Block = 0; Block < Blocks; ++Block, First += JsonStructuralScanner::BlockSize)
+        {
+            JsonStructuralScanner::BlockMasks& Masks = OutMasks[Block];
+            Masks = JsonStructuralScanner::BlockMasks{ 0, 0, 0, 0 };
+            for (uint32_t Lane = 0; Lane < 4; ++Lane)
+            {
+                const __m128i Chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(First + Lane * 16));
+                const __m128i Folded = _mm_or_si128(Chars, Lower);
+                const __m128i Operator = _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(Chars, Comma), _mm_cmpeq_epi8(Chars, Colon)),
+                    _mm_or_si128(_mm_cmpeq_epi8(Folded, BraceOpen), _mm_cmpeq_epi8(Folded, BraceEnd))
+                );
+                const __m128i WhiteSpace = _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(Chars, Space), _mm_cmpeq_epi8(Chars, Tab)),
+                    _mm_or_si128(_mm_cmpeq_epi8(Chars, NewLine), _mm_cmpeq_epi8(Chars, Return))
+                );
+                const uint32_t Shift = Lane * 16;
+                Masks.Quote      |= uint64_t(uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(Chars, Quote)))) << Shift;
+                Masks.Backslash  |= uint64_t(uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(Chars, Backslash)))) << Shift;
+                Masks.Operator   |= uint64_t(uint32_t(_mm_movemask_epi8(Operator))) << Shift;
+                Masks.WhiteSpace |= uint64_t(uint32_t(_mm_movemask_epi8(WhiteSpace))) << Shift;
+            }
+        }
+    }
+#endif // JSON_SIMD_SSE2
+
+#ifdef JSON_SIMD_AVX2
+    // AVX2 kernel - two 32 byte lanes per block
+    JSON_TARGET_AVX2 void ClassifyAVX2(const char* First, uint32_t Blocks, JsonStructuralScanner::BlockMasks* OutMasks)
+    {
+        const __m256i Quote     = _mm256_set1_epi8('"');
+        const __m256i Backslash = _mm256_set1_epi8('\\');
+        const __m256i Comma     = _mm256_set1_epi8(',');
+        const __m256i Colon     = _mm256_set1_epi8(':');
+        const __m256i Lower     = _mm256_set1_epi8(0x20);
+        const __m256i BraceOpen = _mm256_set1_epi8('{');
+        const __m256i BraceEnd  = _mm256_set1_epi8('}');
+        const __m256i Space     = _mm256_set1_epi8(' ');
+        const __m256i Tab       = _mm256_set1_epi8('\t');
+        const __m256i NewLine   = _mm256_set1_epi8('\n');
+        const __m256i Return    = _mm256_set1_epi8('\r');
+
+        for (uint32_t Block = 0; Block < Blocks; ++Block, First += JsonStructuralScanner::BlockSize)
+        {
+            JsonStructuralScanner::BlockMasks& Masks = OutMasks[Block];
+            Masks = JsonStructuralScanner::BlockMasks{ 0, 0, 0, 0 };
+            for (uint32_t Lane = 0; Lane < 2; ++Lane)
+            {
+                const __m256i Chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(First + Lane * 32));
+                const __m256i Folded = _mm256_or_si256(Chars, Lower);
+                const __m256i Operator = _mm256_or_si256(
+                    _mm256_or_si256(_mm256_cmpeq_epi8(Chars, Comma), _mm256_cmpeq_epi8(Chars, Colon)),
+                    _mm256_or_si256(_mm256_cmpeq_epi8(Folded, BraceOpen), _mm256_cmpeq_epi8(Folded, BraceEnd))
+                );
+                const __m256i WhiteSpace = _mm256_or_si256(
+                    _mm256_or_si256(_mm256_cmpeq_epi8(Chars, Space), _mm256_cmpeq_epi8(Chars, Tab)),
+                    _mm256_or_si256(_mm256_cmpeq_epi8(Chars, NewLine), _mm256_cmpeq_epi8(Chars, Return))
+                );
+                const uint32_t Shift = Lane * 32;
+                Masks.Quote      |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(Chars, Quote)))) << Shift;
+                Masks.Backslash  |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(Chars, Backslash)))) << Shift;
+                Masks.Operator   |= uint64_t(uint32_t(_mm256_movemask_epi8(Operator))) << Shift;
+                Masks.WhiteSpace |= uint64_t(uint32_t(_mm256_movemask_epi8(WhiteSpace))) << Shift;
+            }
+        }
+    }
+#endif // JSON_SIMD_AVX2
+
+    struct Kernel
+    {
+        JsonStructuralScanner::ClassifyFunction Classify;
+        const char*                             Name;
+    };
+
+    const Kernel& SelectKernel()
+    {
+        static const Kernel Selected = []() -> Kernel {
+#ifdef JSON_SIMD_AVX2
+            if (Simd::CpuSupportsAvx2())
+                return Kernel{ &ClassifyAVX2, "avx2" };
+#endif // JSON_SIMD_AVX2
+#ifdef JSON_SIMD_SSE2
+            return Kernel{ &ClassifySSE2, "sse2" };
+#else
+            return Kernel{ &ClassifyScalar, "scalar" };
+#endif // JSON_SIMD_SSE2
+        }();
+        return Selected;
+    }
+}
+
+void JsonStructuralScanner::Reset(const char* First, const char* Last) noexcept
+{
+    m_Base          = First;
+    m_Cursor        = First;
+    m_Last          = Last;
+    m_Index         = 0;
+    m_Count         = 0;
+    m_PrevEscaped   = 0;
+    m_PrevInString  = 0;
+    m_PrevScalar    = 0;
+}
+
+const char* JsonStructuralScanner::KernelName() noexcept
+{
+    return SelectKernel().Name;
+}
+
+void JsonStructuralScanner::Refill()
+{
+    BlockMasks Masks[BatchSize];
+
+    m_Base  = m_Cursor;
+    m_Index = 0;
+    m_Count = 0;
+
+    auto Available = static_cast<size_t>(m_Last - m_Cursor);
+    auto Blocks = static_cast<uint32_t>(Available / BlockSize < BatchSize ? Available / BlockSize : BatchSize);
+    if (Blocks > 0)
+    {
+        SelectKernel().Classify(m_Cursor, Blocks, Masks);
+        m_Cursor += Blocks * BlockSize;
+    }
+    else
+    {
+        // Tail shorter than a block - classify a copy padded with white space
+        char Padded[BlockSize];
+        std::memset(Padded, ' ', BlockSize);
+        std::memcpy(Padded, m_Cursor, Available);
+        SelectKernel().Classify(Padded, 1, Masks);
+        m_Cursor = m_Last;
+        Blocks = 1;
+    }
+
+    for (uint32_t Block = 0; Block < Blocks; ++Block)
+        IndexBlock(Masks[Block], Block * BlockSize);
+}
+
+void JsonStructuralScanner::IndexBlock(const BlockMasks& Masks, uint32_t Offset) noexcept
+{
+    // Quotes which are not escaped open or close a string
+    const uint64_t Quote = Masks.Quote & ~FindEscaped(Masks.Backslash);
+    const uint64_t InString = Simd::PrefixXor(Quote) ^ m_PrevInString;
+    m_PrevInString = static_cast<uint64_t>(static_cast<int64_t>(InString) >> 63);
+
+    // A scalar starts at every non-operator, non-whitespace byte not preceded by another one
+    const uint64_t Scalar = ~(Masks.Operator | Masks.WhiteSpace);
+    const uint64_t NonQuoteScalar = Scalar & ~Quote;
+    const uint64_t FollowsNonQuoteScalar = (NonQuoteScalar << 1) | m_PrevScalar;
+    m_PrevScalar = NonQuoteScalar >> 63;
+
+    // Drop everything inside strings, including the closing quote
+    uint64_t Structural = (Masks.Operator | (Scalar & ~FollowsNonQuoteScalar)) & ~(InString ^ Quote);
+    while (Structural)
+    {
+        m_Offsets[m_Count++] = Offset + Simd::CountTrailingZeros(Structural);
+        Structural &= Structural - 1;
+    }
+}
+
+uint64_t JsonStructuralScanner::FindEscaped(uint64_t Backslash) noexcept
+{
+    if (!Backslash)
+    {
+        const uint64_t Escaped = m_PrevEscaped;
+        m_PrevEscaped = 0;
+        return Escaped;
+    }
+
+    // A backslash escaped by the previous block does not start a new sequence
+    Backslash &= ~m_PrevEscaped;
+    const uint64_t FollowsEscape = (Backslash << 1) | m_PrevEscaped;
+
+    // Sequences of backslashes of odd length escape the following character
+    const uint64_t EvenBits = 0x5555555555555555ULL;
+    const uint64_t OddSequenceStarts = Backslash & ~EvenBits & ~FollowsEscape;
+    uint64_t SequencesStartingOnEvenBits;
+    m_PrevEscaped = Simd::AddOverflow(OddSequenceStarts, Backslash, SequencesStartingOnEvenBits) ? 1 : 0;
+    const uint64_t InvertMask = SequencesStartingOnEvenBits << 1;
+
+    return (EvenBits ^ InvertMask) & FollowsEscape;
+}
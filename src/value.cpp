@@ -1,11 +1,12 @@
 #include "value.h"
+#include <cstring>
 
 using namespace JSONCPP_NAMESPACE;
 
 // Json Value
 const std::array<std::string, JsonValue::NumTypes> JsonValue::JsonTypeString = { "Unknown", "Null", "Boolean", "Number", "String", "Array", "Object" };
 
-bool JsonValue::Equal(const JsonValue& Lhs, const JsonValue& Rhs) noexcept
+bool JsonValue::Equal(const JsonValue& Lhs, const JsonValue& Rhs)
 {
     if (Lhs.GetType() != Rhs.GetType())
         return false;
@@ -18,7 +19,7 @@ bool JsonValue::Equal(const JsonValue& Lhs, const JsonValue& Rhs) noexcept
     case JsonType::Boolean:
         return Lhs.AsBool() == Rhs.AsBool();
     case JsonType::Number:
-        return Lhs.AsNumber() == Rhs.AsNumber();
+        return static_cast<const JsonNumber&>(Lhs) == static_cast<const JsonNumber&>(Rhs);
     case JsonType::String:
         return Lhs.AsString() == Rhs.AsString();
     case JsonType::Array:
@@ -132,27 +133,55 @@ JsonBoolean::JsonBoolean(ValueType Value)
 
 // Json Number
 JsonNumber::JsonNumber(const ValueType& Value)
-    : m_Number(Value), JsonValue(JsonType::Number)
+    : JsonValue(JsonType::Number)
 {
+    *this = Value;
 }
 
-JsonNumber::JsonNumber(ValueType&& Value) noexcept
-    : m_Number(std::move(Value)), JsonValue(JsonType::Number)
+JsonNumber& JsonNumber::operator=(const JsonNumber& Rhs)
 {
+    if (this != &Rhs)
+    {
+        JsonValue::operator=(Rhs);
+        ReleaseText();
+        m_Number = Rhs.m_Number;
+        StoreText();
+    }
+    return *this;
 }
 
 JsonNumber& JsonNumber::operator=(const ValueType& Value)
 {
-    if (&m_Number != &Value)
-        m_Number = Value;
+    JsonNumeric Number;
+    auto Last = NumberConverter::Parse(Value.data(), Value.data() + Value.size(), Number);
+    JSON_ASSERT_MESSAGE(Last == Value.data() + Value.size(), "Invalid number value '%s'.", Value.c_str());
+    Invalidate();
+    ReleaseText();
+    m_Number = Number;
+    StoreText();
     return *this;
 }
 
-JsonNumber& JsonNumber::operator=(ValueType&& Value) noexcept
+void JsonNumber::StoreText()
 {
-    if (&m_Number != &Value)
-        m_Number = std::move(Value);
-    return *this;
+    if (m_Number.Type != JsonNumberType::Text)
+        return;
+
+    // Nothing is owned should the copy fail
+    const uint32_t Length = m_Number.Length;
+    const char* View = m_Number.Text;
+    m_Number = JsonNumeric();
+    char* Text = new char[Length];
+    std::memcpy(Text, View, Length);
+    m_Number.Type = JsonNumberType::Text;
+    m_Number.Length = Length;
+    m_Number.Text = Text;
+}
+
+bool JsonNumber::GetString(StringType& OutString) const
+{
+    OutString = NumberConverter::ToString(m_Number);
+    return true;
 }
 
 // Json String
@@ -183,6 +212,7 @@ JsonString::JsonString(ValueType&& Value) noexcept
 
 JsonString& JsonString::operator=(const ValueType& Value)
 {
+    Invalidate();
     if (&m_String != &Value)
         m_String = Value;
     return *this;
@@ -190,6 +220,7 @@ JsonString& JsonString::operator=(const ValueType& Value)
 
 JsonString& JsonString::operator=(ValueType&& Value) noexcept
 {
+    Invalidate();
     if (&m_String != &Value)
         m_String = std::move(Value);
     return *this;
@@ -218,8 +249,25 @@ JsonArray::JsonArray(ContainerType&& Array) noexcept
 {
 }
 
+// Copies of a lazy array are eager, the tape stays with the source
+JsonArray::JsonArray(const JsonArray& Other)
+    : JsonValue(Other)
+{
+    Other.Materialize();
+    m_Array = Other.m_Array;
+}
+
+JsonArray::JsonArray(JsonArray&& Other)
+    : JsonValue(Other)
+{
+    Other.Materialize();
+    m_Array = std::move(Other.m_Array);
+}
+
 JsonArray& JsonArray::operator=(const ContainerType& Array)
 {
+    Detach();
+    Invalidate();
     if (&m_Array != &Array)
         m_Array = Array;
     return *this;
@@ -227,6 +275,8 @@ JsonArray& JsonArray::operator=(const ContainerType& Array)
 
 JsonArray& JsonArray::operator=(ContainerType&& Array) noexcept
 {
+    Detach();
+    Invalidate();
     if (&m_Array != &Array)
         m_Array = std::move(Array);
     return *this;
@@ -234,24 +284,29 @@ JsonArray& JsonArray::operator=(ContainerType&& Array) noexcept
 
 bool JsonArray::GetArray(PointerArray& OutArray)
 {
+    Materialize();
+    Invalidate();
     OutArray = &m_Array;
     return true;
 }
 
 bool JsonArray::GetArray(CPointerArray& OutArray) const
 {
+    Materialize();
     OutArray = &m_Array;
     return true;
 }
 
 JsonArray::ValueType& JsonArray::At(uint32_t Index)
 {
+    Materialize();
     JSON_ASSERT_MESSAGE(Index < m_Array.size(), "Array index out of bounds.");
     return m_Array[Index];
 }
 
 const JsonArray::ValueType& JsonArray::At(uint32_t Index) const
 {
+    Materialize();
     JSON_ASSERT_MESSAGE(Index < m_Array.size(), "Array index out of bounds.");
     return m_Array[Index];
 }
@@ -267,8 +322,24 @@ JsonObject::JsonObject(ContainerType&& Values) noexcept
 {
 }
 
+JsonObject::JsonObject(const JsonObject& Other)
+    : JsonValue(Other)
+{
+    Other.Materialize();
+    m_Values = Other.m_Values;
+}
+
+JsonObject::JsonObject(JsonObject&& Other)
+    : JsonValue(Other)
+{
+    Other.Materialize();
+    m_Values = std::move(Other.m_Values);
+}
+
 JsonObject& JsonObject::operator=(const ContainerType& Values)
 {
+    Detach();
+    Invalidate();
     if (&m_Values != &Values)
         m_Values = Values;
     return *this;
@@ -276,54 +347,96 @@ JsonObject& JsonObject::operator=(const ContainerType& Values)
 
 JsonObject& JsonObject::operator=(ContainerType&& Values) noexcept
 {
+    Detach();
+    Invalidate();
     if (&m_Values != &Values)
         m_Values = std::move(Values);
     return *this;
 }
 
-JsonObject::MappedType& JsonObject::At(const KeyType& Identifier)
+JsonObject::MappedType& JsonObject::At(JsonStringRef Identifier)
 {
-    auto Found = m_Values.find(Identifier);
-    JSON_ASSERT_MESSAGE(Found != m_Values.end(), "Identifier \'%s\' - not found.", Identifier.c_str());
-    return Found->second;
+    auto Value = Lookup(Identifier);
+    JSON_ASSERT_MESSAGE(Value != nullptr, "Identifier \'%.*s\' - not found.", static_cast<int>(Identifier.Size()), Identifier.Data());
+    return *Value;
 }
 
-const JsonObject::MappedType& JsonObject::At(const KeyType& Identifier) const
+const JsonObject::MappedType& JsonObject::At(JsonStringRef Identifier) const
 {
-    auto Found = m_Values.find(Identifier);
-    JSON_ASSERT_MESSAGE(Found != m_Values.end(), "Identifier \'%s\' - not found.", Identifier.c_str());
-    return Found->second;
+    auto Value = Lookup(Identifier);
+    JSON_ASSERT_MESSAGE(Value != nullptr, "Identifier \'%.*s\' - not found.", static_cast<int>(Identifier.Size()), Identifier.Data());
+    return *Value;
+}
+
+JsonObject::MappedType& JsonObject::At(const JsonKey& Identifier)
+{
+    auto Value = Lookup(Identifier);
+    JSON_ASSERT_MESSAGE(Value != nullptr, "Identifier \'%.*s\' - not found.", static_cast<int>(Identifier.Size()), Identifier.Data());
+    return *Value;
 }
 
-bool JsonObject::Has(const KeyType& Identifier) const
+const JsonObject::MappedType& JsonObject::At(const JsonKey& Identifier) const
 {
-    return m_Values.find(Identifier) != m_Values.end();
+    auto Value = Lookup(Identifier);
+    JSON_ASSERT_MESSAGE(Value != nullptr, "Identifier \'%.*s\' - not found.", static_cast<int>(Identifier.Size()), Identifier.Data());
+    return *Value;
+}
+
+JsonObject::MappedType& JsonObject::operator[](const KeyType& Identifier)
+{
+    // Only a member created here changes the object
+    Materialize();
+    const auto Size = m_Values.size();
+    auto& Value = m_Values[Identifier];
+    if (m_Values.size() != Size)
+        Invalidate();
+    return Value;
+}
+
+JsonObject::MappedType& JsonObject::operator[](KeyType&& Identifier)
+{
+    Materialize();
+    const auto Size = m_Values.size();
+    auto& Value = m_Values[std::move(Identifier)];
+    if (m_Values.size() != Size)
+        Invalidate();
+    return Value;
 }
 
 bool JsonObject::Insert(const KeyType& Identifier, MappedType Value)
 {
+    Materialize();
+    Invalidate();
     return m_Values.insert(std::make_pair(Identifier, Value)).second;
 }
 
 bool JsonObject::Insert(KeyType&& Identifier, MappedType Value)
 {
+    Materialize();
+    Invalidate();
     return m_Values.insert(std::make_pair(std::move(Identifier), Value)).second;
 }
 
 bool JsonObject::Emplace(KeyType&& Identifier, MappedType Value)
 {
+    Materialize();
+    Invalidate();
     return m_Values.emplace(std::move(Identifier), Value).second;
 }
 
-void JsonObject::Erase(const KeyType& Identifier)
+void JsonObject::Erase(JsonStringRef Identifier)
 {
+    Materialize();
+    Invalidate();
     auto Found = m_Values.find(Identifier);
     if (Found != m_Values.end())
         m_Values.erase(Found);
 }
 
-JsonObject::MappedType JsonObject::Extract(const KeyType& Identifier)
+JsonObject::MappedType JsonObject::Extract(JsonStringRef Identifier)
 {
+    Materialize();
+    Invalidate();
     auto Found = m_Values.find(Identifier);
     if (Found != m_Values.end())
     {
@@ -336,6 +449,7 @@ JsonObject::MappedType JsonObject::Extract(const KeyType& Identifier)
 
 JsonObject::MappedType JsonObject::Extract(ConstIterator Where)
 {
+    Invalidate();
     if (Where != m_Values.cend())
     {
         auto Value = Where->second;
@@ -345,8 +459,9 @@ JsonObject::MappedType JsonObject::Extract(ConstIterator Where)
     return nullptr;
 }
 
-uint32_t JsonObject::Count(JsonType Type) const noexcept
+uint32_t JsonObject::Count(JsonType Type) const
 {
+    Materialize();
     uint32_t Count = 0;
     for (const auto& Value : m_Values)
     {
@@ -356,8 +471,9 @@ uint32_t JsonObject::Count(JsonType Type) const noexcept
     return Count;
 }
 
-bool JsonObject::Contains(JsonType Type) const noexcept
+bool JsonObject::Contains(JsonType Type) const
 {
+    Materialize();
     for (const auto& Value : m_Values)
     {
         if (Value.second->GetType() == Type)
@@ -368,12 +484,15 @@ bool JsonObject::Contains(JsonType Type) const noexcept
 
 bool JsonObject::GetMap(PointerMap& OutMap)
 {
+    Materialize();
+    Invalidate();
     OutMap = &m_Values;
     return true;
 }
 
 bool JsonObject::GetMap(CPointerMap& OutMap) const
 {
+    Materialize();
     OutMap = &m_Values;
     return true;
 }
@@ -1,132 +1,856 @@
 #include "writer.h"
-#include "utf.h"
-#include <iomanip>
+#include "simd.h"
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
 
 using namespace JSONCPP_NAMESPACE;
 
-void JsonWriter::Write(OStream& Stream, const JsonValue* Root, uint32_t Level) const
+namespace {
+	// Code point of the UTF-8 sequence started by Lead, First is moved past its continuation
+	// bytes. Malformed sequences yield U+FFFD and only their lead byte is consumed
+	uint32_t DecodeSequence(uint8_t Lead, const char*& First, const char* Last) noexcept
+	{
+		uint32_t CodePoint, Length, Minimum;
+		if (Lead >= 0xC2U && Lead <= 0xDFU)
+		{
+			CodePoint = Lead & 0x1FU; Length = 1; Minimum = 0x80U;
+		}
+		else if (Lead >= 0xE0U && Lead <= 0xEFU)
+		{
+			CodePoint = Lead & 0x0FU; Length = 2; Minimum = 0x800U;
+		}
+		else if (Lead >= 0xF0U && Lead <= 0xF4U)
+		{
+			CodePoint = Lead & 0x07U; Length = 3; Minimum = 0x10000U;
+		}
+		else
+			return 0xFFFDU;
+
+		if (static_cast<uint32_t>(Last - First) < Length)
+			return 0xFFFDU;
+		for (uint32_t Index = 0; Index < Length; ++Index)
+		{
+			const auto Byte = static_cast<uint8_t>(First[Index]);
+			if ((Byte & 0xC0U) != 0x80U)
+				return 0xFFFDU;
+			CodePoint = (CodePoint << 6) | (Byte & 0x3FU);
+		}
+		if (CodePoint < Minimum || CodePoint > 0x10FFFFU || (CodePoint >= 0xD800U && CodePoint <= 0xDFFFU))
+			return 0xFFFDU;
+
+		First += Length;
+		return CodePoint;
+	}
+
+	// Both tree kinds seen as containers of children, for the parallel path
+	bool IsObject(const JsonValue* Root) noexcept		{ return Root->GetType() == JsonType::Object; }
+	bool IsContainer(const JsonValue* Root) noexcept	{ return IsObject(Root) || Root->GetType() == JsonType::Array; }
+	bool IsObject(const JsonNode& Root) noexcept		{ return Root.GetType() == JsonType::Object; }
+
+	size_t ContainerSize(const JsonValue* Root)
+	{
+		switch (Root->GetType())
+		{
+		case JsonType::Object:	return Root->AsObject().size();
+		case JsonType::Array:	return Root->AsArray().size();
+		default:				return 0;
+		}
+	}
+
+	size_t ContainerSize(const JsonNode& Root) noexcept
+	{
+		return Root.GetType() == JsonType::Object || Root.GetType() == JsonType::Array ? Root.Size() : 0;
+	}
+
+	const JsonValue* ChildAt(const JsonValue* Root, size_t Index)
+	{
+		return IsObject(Root) ? (Root->AsObject().cbegin() + Index)->second.get() : Root->AsArray()[Index].get();
+	}
+
+	const JsonNode& ChildAt(const JsonNode& Root, size_t Index) noexcept
+	{
+		return IsObject(Root) ? Root.MemberBegin()[Index].Value : Root.Begin()[Index];
+	}
+
+	JsonStringRef ChildName(const JsonValue* Root, size_t Index)	{ return (Root->AsObject().cbegin() + Index)->first; }
+	JsonStringRef ChildName(const JsonNode& Root, size_t Index)		{ return Root.MemberBegin()[Index].Key; }
+
+	// Length of the number as written, the bound spares the shortest digits conversion of doubles
+	template<bool Bound>
+	size_t MeasureNumber(const JsonNumeric& Number) noexcept
+	{
+		if (Number.Type == JsonNumberType::Text)
+			return Number.Length;
+		if (Bound && Number.Type == JsonNumberType::Double)
+			return NumberConverter::MaxDoubleLength;
+		char Buffer[NumberConverter::BufferSize];
+		return static_cast<size_t>(NumberConverter::Format(Number, Buffer) - Buffer);
+	}
+
+	// Lends the buffer the string's own storage, the output is written in place. The string is
+	// sized to Reserve bytes up front, doubles should they run out and is cut to the written
+	// length when the buffer gives its block back
+	class StringStorageSink : public JsonOutputSink
+	{
+	public:
+		StringStorageSink(std::string& OutString, size_t Reserve) noexcept : m_OutString(OutString), m_Written(OutString.size()), m_Reserve(Reserve) {}
+
+		void Write(const char* Data, size_t Length) override
+		{
+			m_OutString.resize(m_Written);
+			m_OutString.append(Data, Length);
+			m_Written += Length;
+		}
+
+		char* Acquire(size_t& Capacity) override
+		{
+			m_OutString.resize(m_Written + std::max<size_t>(m_Reserve, 64));
+			return Lend(Capacity);
+		}
+
+		char* Submit(char* Data, size_t Length, size_t& Capacity) override
+		{
+			(void)Data;
+			m_Written += Length;
+			if (m_OutString.size() - m_Written < Capacity)
+				m_OutString.resize(std::max(m_OutString.size() * 2, m_Written + Capacity));
+			return Lend(Capacity);
+		}
+
+		void Release(char* Block) noexcept override
+		{
+			(void)Block;
+			m_OutString.resize(m_Written);
+		}
+
+	private:
+		char* Lend(size_t& Capacity)
+		{
+			Capacity = m_OutString.size() - m_Written;
+			return &m_OutString[m_Written];
+		}
+
+		std::string&	m_OutString;
+		size_t			m_Written;
+		size_t			m_Reserve;
+	};
+
+	// The fragment with its spliced children in place
+	void WriteFragment(JsonOutputBuffer& Out, const JsonFragment& Fragment)
+	{
+		size_t Offset = 0;
+		for (const auto& Splice : Fragment.Splices)
+		{
+			Out.Put(Fragment.Bytes.data() + Offset, Splice.Offset - Offset);
+			WriteFragment(Out, *Splice.Fragment);
+			Offset = Splice.Offset;
+		}
+		Out.Put(Fragment.Bytes.data() + Offset, Fragment.Bytes.size() - Offset);
+	}
+
+	// Root itself when it is large enough to split, otherwise the way down to its largest
+	// child container. Path receives the child indexes, false if no container qualifies
+	template<class Node>
+	bool FindSplit(const Node& Root, std::vector<size_t>& Path)
+	{
+		const size_t Size = ContainerSize(Root);
+		if (Size >= JsonFormatter::MinParallelElements)
+			return true;
+
+		size_t Largest = 0, Split = 0;
+		for (size_t Index = 0; Index < Size; ++Index)
+		{
+			const size_t ChildSize = ContainerSize(ChildAt(Root, Index));
+			if (ChildSize > Largest)
+			{
+				Largest = ChildSize;
+				Split = Index;
+			}
+		}
+		if (Largest == 0)
+			return false;
+		Path.push_back(Split);
+		return FindSplit(ChildAt(Root, Split), Path);
+	}
+}
+
+void JsonFormatter::Write(JsonOutputBuffer& Out, const JsonValue* Root, uint32_t Level) const
+{
+	JSON_ASSERT(Root != nullptr);
+	if (m_FragmentCache && IsContainer(Root))
+		return WriteFragment(Out, *CachedFragment(Root, Level));
+	if (m_Threads != 1 && WriteParallel(Out, Root, Level))
+		return;
+	m_Compact ? WriteValue<JsonCompactFormat>(Out, Root, Level) : WriteValue<JsonPrettyFormat>(Out, Root, Level);
+}
+
+void JsonFormatter::Write(JsonOutputBuffer& Out, const JsonNode& Root, uint32_t Level) const
+{
+	if (m_Threads != 1 && WriteParallel(Out, Root, Level))
+		return;
+	m_Compact ? WriteValue<JsonCompactFormat>(Out, Root, Level) : WriteValue<JsonPrettyFormat>(Out, Root, Level);
+}
+
+template<class Format>
+void JsonFormatter::WriteValue(JsonOutputBuffer& Out, const JsonValue* Root, uint32_t Level) const
 {
 	JSON_ASSERT(Root != nullptr);
 	switch (Root->GetType())
 	{
-	case JsonType::Object:	WriteObject(Stream, Root, Level); break;
-	case JsonType::Array:	WriteArray(Stream, Root, Level); break;
-	case JsonType::Null:	Stream << "null"; break;
-	case JsonType::Boolean: JSON_FALLTHROUGH;
-	case JsonType::Number:	Stream << Root->AsString().c_str(); break;
-	case JsonType::String:	WriteString(Stream, Root->AsString()); break;
-	default: JSON_ASSERT_MESSAGE(true, "Invalid serialization JSON type.");
+	case JsonType::Object:	WriteObject<Format>(Out, Root, Level); break;
+	case JsonType::Array:	WriteArray<Format>(Out, Root, Level); break;
+	case JsonType::Null:	Out.Put("null", 4); break;
+	case JsonType::Boolean: Root->AsBool() ? Out.Put("true", 4) : Out.Put("false", 5); break;
+	case JsonType::Number:	WriteNumber(Out, static_cast<const JsonNumber*>(Root)->GetNumeric()); break;
+	case JsonType::String:	WriteString(Out, static_cast<const JsonString*>(Root)->GetString()); break;
+	default: JSON_ASSERT_MESSAGE(false, "Invalid serialization JSON type.");
 	}
 }
 
-void JsonWriter::WriteHex(OStream& Stream, uint32_t CodePoint) const
+template<class Format>
+void JsonFormatter::WriteValue(JsonOutputBuffer& Out, const JsonNode& Root, uint32_t Level) const
 {
-	Stream << "\\u" << std::hex << std::setfill('0') << std::setw(4) << (CodePoint & 0xFFFFU);
+	switch (Root.GetType())
+	{
+	case JsonType::Object:	WriteObject<Format>(Out, Root, Level); break;
+	case JsonType::Array:	WriteArray<Format>(Out, Root, Level); break;
+	case JsonType::Null:	Out.Put("null", 4); break;
+	case JsonType::Boolean: Root.GetBoolean() ? Out.Put("true", 4) : Out.Put("false", 5); break;
+	case JsonType::Number:	WriteNumber(Out, Root.GetNumeric()); break;
+	case JsonType::String:	WriteString(Out, Root.GetString()); break;
+	default: JSON_ASSERT_MESSAGE(false, "Invalid serialization JSON type.");
+	}
+}
+
+void JsonFormatter::WriteHex(JsonOutputBuffer& Out, uint32_t CodePoint) const
+{
+	static const char Digits[] = "0123456789abcdef";
+	auto Put = [](char* Cursor, uint32_t Unit) {
+		Cursor[0] = '\\';
+		Cursor[1] = 'u';
+		Cursor[2] = Digits[(Unit >> 12) & 0xFU];
+		Cursor[3] = Digits[(Unit >> 8) & 0xFU];
+		Cursor[4] = Digits[(Unit >> 4) & 0xFU];
+		Cursor[5] = Digits[Unit & 0xFU];
+	};
+
+	auto Cursor = Out.Reserve(12);
+	if (CodePoint < 0x10000U)
+	{
+		Put(Cursor, CodePoint);
+		return Out.Commit(Cursor + 6);
+	}
+	CodePoint -= 0x10000U;
+	Put(Cursor, 0xD800U + (CodePoint >> 10));
+	Put(Cursor + 6, 0xDC00U + (CodePoint & 0x3FFU));
+	Out.Commit(Cursor + 12);
+}
+
+void JsonFormatter::WriteNumber(JsonOutputBuffer& Out, const JsonNumeric& Number) const
+{
+	if (Number.Type == JsonNumberType::Text)
+		return Out.Put(Number.Text, Number.Length);
+	auto Cursor = Out.Reserve(NumberConverter::BufferSize);
+	Out.Commit(NumberConverter::Format(Number, Cursor));
+}
+
+void JsonFormatter::WriteString(JsonOutputBuffer& Out, JsonStringRef String) const
+{
+	m_EnsureAscii ? WriteEscaped<true>(Out, String) : WriteEscaped<false>(Out, String);
 }
 
-void JsonWriter::WriteString(OStream& Stream, const std::string& String) const
+template<bool EnsureAscii>
+void JsonFormatter::WriteEscaped(JsonOutputBuffer& Out, JsonStringRef String) const
 {
-	auto First = String.cbegin();
-	auto Last = String.cend();
+	auto First = String.Begin();
+	auto Last = String.End();
 
-	Stream << '"';
-	for (; First != Last; ++First)
+	Out.Put('"');
+	for (;;)
 	{
-		auto Char = *First;
-		switch (Char)
+		// Copy the run that needs no escaping in one go
+		auto Run = Simd::FindStringEscape<EnsureAscii>(First, Last);
+		Out.Put(First, static_cast<size_t>(Run - First));
+		if (Run == Last)
+			break;
+
+		First = Run;
+		const auto Byte = static_cast<uint8_t>(*First++);
+		switch (Byte)
 		{
-		case '\"': Stream << "\\\""; break;
-		case '\\': Stream << "\\\\"; break;
-		case '\n': Stream << "\\n"; break;
-		case '\t': Stream << "\\t"; break;
-		case '\b': Stream << "\\b"; break;
-		case '\f': Stream << "\\f"; break;
-		case '\r': Stream << "\\r"; break;
+		case '\"': Out.Put("\\\"", 2); break;
+		case '\\': Out.Put("\\\\", 2); break;
+		case '\n': Out.Put("\\n", 2); break;
+		case '\t': Out.Put("\\t", 2); break;
+		case '\b': Out.Put("\\b", 2); break;
+		case '\f': Out.Put("\\f", 2); break;
+		case '\r': Out.Put("\\r", 2); break;
 		default:
-		{
-			if (Char >= static_cast<char>(0x20U))
-				Stream << Char;
-			else
-			{
-				uint32_t CodePoint;
-				First = Utf8::Decode(First, Last, CodePoint) - 1;
-				for (; CodePoint > 0; CodePoint >>= 16)
-					WriteHex(Stream, CodePoint);
-			}
+			WriteHex(Out, Byte < 0x80U ? Byte : DecodeSequence(Byte, First, Last));
 			break;
 		}
+	}
+	Out.Put('"');
+}
+
+size_t JsonFormatter::Measure(const JsonValue* Root) const
+{
+	JSON_ASSERT(Root != nullptr);
+	return m_Compact ? MeasureValue<JsonCompactFormat, false>(Root, 1) : MeasureValue<JsonPrettyFormat, false>(Root, 1);
+}
+
+size_t JsonFormatter::Measure(const JsonNode& Root) const
+{
+	return m_Compact ? MeasureValue<JsonCompactFormat, false>(Root, 1) : MeasureValue<JsonPrettyFormat, false>(Root, 1);
+}
+
+size_t JsonFormatter::MeasureCapacity(const JsonValue* Root) const
+{
+	JSON_ASSERT(Root != nullptr);
+	if (m_FragmentCache && IsContainer(Root))
+		return CachedFragment(Root, 1)->Size;
+	return m_Compact ? MeasureValue<JsonCompactFormat, true>(Root, 1) : MeasureValue<JsonPrettyFormat, true>(Root, 1);
+}
+
+size_t JsonFormatter::MeasureCapacity(const JsonNode& Root) const
+{
+	return m_Compact ? MeasureValue<JsonCompactFormat, true>(Root, 1) : MeasureValue<JsonPrettyFormat, true>(Root, 1);
+}
+
+template<class Format, bool Bound>
+size_t JsonFormatter::MeasureValue(const JsonValue* Root, uint32_t Level) const
+{
+	JSON_ASSERT(Root != nullptr);
+	switch (Root->GetType())
+	{
+	case JsonType::Object:
+	{
+		const auto& Object = Root->AsObject();
+		size_t Length = 1 + MeasureObjectEnd<Format>(Object.size(), Level), Index = 0;
+		for (auto First = Object.cbegin(); First != Object.cend(); ++First, ++Index)
+			Length += MeasureMember<Format>(First->first, Index, Level) + MeasureValue<Format, Bound>(First->second.get(), Level + 1);
+		return Length;
+	}
+	case JsonType::Array:
+	{
+		const auto& Array = Root->AsArray();
+		size_t Length = 2 + (Array.empty() ? 0 : (Array.size() - 1) * (Format::Compact ? 1 : 2));
+		for (auto First = Array.cbegin(); First != Array.cend(); ++First)
+			Length += MeasureValue<Format, Bound>(First->get(), Level + 1);
+		return Length;
+	}
+	case JsonType::Null:	return 4;
+	case JsonType::Boolean: return Root->AsBool() ? 4 : 5;
+	case JsonType::Number:	return MeasureNumber<Bound>(static_cast<const JsonNumber*>(Root)->GetNumeric());
+	case JsonType::String:	return MeasureString(static_cast<const JsonString*>(Root)->GetString());
+	default:				return 0;
+	}
+}
+
+template<class Format, bool Bound>
+size_t JsonFormatter::MeasureValue(const JsonNode& Root, uint32_t Level) const
+{
+	switch (Root.GetType())
+	{
+	case JsonType::Object:
+	{
+		size_t Length = 1 + MeasureObjectEnd<Format>(Root.Size(), Level), Index = 0;
+		for (auto First = Root.MemberBegin(); First != Root.MemberEnd(); ++First, ++Index)
+			Length += MeasureMember<Format>(First->Key, Index, Level) + MeasureValue<Format, Bound>(First->Value, Level + 1);
+		return Length;
+	}
+	case JsonType::Array:
+	{
+		size_t Length = 2 + (Root.Empty() ? 0 : (Root.Size() - 1) * (Format::Compact ? 1 : 2));
+		for (auto First = Root.Begin(); First != Root.End(); ++First)
+			Length += MeasureValue<Format, Bound>(*First, Level + 1);
+		return Length;
+	}
+	case JsonType::Null:	return 4;
+	case JsonType::Boolean: return Root.GetBoolean() ? 4 : 5;
+	case JsonType::Number:	return MeasureNumber<Bound>(Root.GetNumeric());
+	case JsonType::String:	return MeasureString(Root.GetString());
+	default:				return 0;
+	}
+}
+
+template<class Format>
+size_t JsonFormatter::MeasureMember(JsonStringRef Name, size_t Index, uint32_t Level) const
+{
+	// Separator, line break with indent, name and colon as WriteMemberName puts them
+	const size_t Layout = Format::Compact ? 1 : 3 + static_cast<size_t>(m_Indent) * Level;
+	return (Index > 0 ? 1 : 0) + Layout + MeasureString(Name);
+}
+
+template<class Format>
+size_t JsonFormatter::MeasureObjectEnd(size_t Size, uint32_t Level) const
+{
+	return 1 + (!Format::Compact && Size > 0 ? 1 + static_cast<size_t>(m_Indent) * (Level - 1) : 0);
+}
+
+size_t JsonFormatter::MeasureString(JsonStringRef String) const
+{
+	return m_EnsureAscii ? MeasureEscaped<true>(String) : MeasureEscaped<false>(String);
+}
+
+template<bool EnsureAscii>
+size_t JsonFormatter::MeasureEscaped(JsonStringRef String) const
+{
+	auto First = String.Begin();
+	auto Last = String.End();
+
+	size_t Length = 2;
+	for (;;)
+	{
+		auto Run = Simd::FindStringEscape<EnsureAscii>(First, Last);
+		Length += static_cast<size_t>(Run - First);
+		if (Run == Last)
+			return Length;
+
+		First = Run;
+		const auto Byte = static_cast<uint8_t>(*First++);
+		switch (Byte)
+		{
+		case '\"': JSON_FALLTHROUGH;
+		case '\\': JSON_FALLTHROUGH;
+		case '\n': JSON_FALLTHROUGH;
+		case '\t': JSON_FALLTHROUGH;
+		case '\b': JSON_FALLTHROUGH;
+		case '\f': JSON_FALLTHROUGH;
+		case '\r': Length += 2; break;
+		default:
+			// \uXXXX, a surrogate pair above the BMP
+			Length += (Byte < 0x80U || DecodeSequence(Byte, First, Last) < 0x10000U) ? 6 : 12;
+			break;
 		}
 	}
-	Stream << '"';
 }
 
-void JsonWriter::WriteIndent(OStream& Stream, uint32_t Level) const
+void JsonFormatter::WriteIndent(JsonOutputBuffer& Out, uint32_t Level) const
 {
 	if (m_Indent > 0)
+		Out.Fill(' ', m_Indent * Level);
+}
+
+template<class Format>
+void JsonFormatter::WriteObject(JsonOutputBuffer& Out, const JsonValue* Root, uint32_t Level) const
+{
+	const size_t Size = Root->AsObject().size();
+
+	Out.Put('{');
+	WriteMembers<Format>(Out, Root, 0, Size, Level);
+	WriteObjectEnd<Format>(Out, Size, Level);
+}
+
+template<class Format>
+void JsonFormatter::WriteArray(JsonOutputBuffer& Out, const JsonValue* Root, uint32_t Level) const
+{
+	Out.Put('[');
+	WriteElements<Format>(Out, Root, 0, Root->AsArray().size(), Level);
+	Out.Put(']');
+}
+
+template<class Format>
+void JsonFormatter::WriteObject(JsonOutputBuffer& Out, const JsonNode& Root, uint32_t Level) const
+{
+	Out.Put('{');
+	WriteMembers<Format>(Out, Root, 0, Root.Size(), Level);
+	WriteObjectEnd<Format>(Out, Root.Size(), Level);
+}
+
+template<class Format>
+void JsonFormatter::WriteArray(JsonOutputBuffer& Out, const JsonNode& Root, uint32_t Level) const
+{
+	Out.Put('[');
+	WriteElements<Format>(Out, Root, 0, Root.Size(), Level);
+	Out.Put(']');
+}
+
+template<class Format>
+void JsonFormatter::WriteMembers(JsonOutputBuffer& Out, const JsonValue* Root, size_t First, size_t Last, uint32_t Level) const
+{
+	auto Member = Root->AsObject().cbegin() + First;
+	for (size_t Index = First; Index < Last; ++Index, ++Member)
 	{
-		auto Offset = m_Indent * Level;
-		Stream << std::string(Offset, ' ');
+		WriteMemberName<Format>(Out, Member->first, Index, Level);
+		WriteValue<Format>(Out, Member->second.get(), Level + 1);
 	}
 }
 
-void JsonWriter::WriteObject(OStream& Stream, const JsonValue* Root, uint32_t Level) const
+template<class Format>
+void JsonFormatter::WriteMembers(JsonOutputBuffer& Out, const JsonNode& Root, size_t First, size_t Last, uint32_t Level) const
 {
-	auto Object = Root->AsObject();
+	auto Member = Root.MemberBegin() + First;
+	for (size_t Index = First; Index < Last; ++Index, ++Member)
+	{
+		WriteMemberName<Format>(Out, Member->Key, Index, Level);
+		WriteValue<Format>(Out, Member->Value, Level + 1);
+	}
+}
+
+template<class Format>
+void JsonFormatter::WriteElements(JsonOutputBuffer& Out, const JsonValue* Root, size_t First, size_t Last, uint32_t Level) const
+{
+	auto Element = Root->AsArray().cbegin() + First;
+	for (size_t Index = First; Index < Last; ++Index, ++Element)
+	{
+		WriteElementSeparator<Format>(Out, Index);
+		WriteValue<Format>(Out, Element->get(), Level + 1);
+	}
+}
+
+template<class Format>
+void JsonFormatter::WriteElements(JsonOutputBuffer& Out, const JsonNode& Root, size_t First, size_t Last, uint32_t Level) const
+{
+	auto Element = Root.Begin() + First;
+	for (size_t Index = First; Index < Last; ++Index, ++Element)
+	{
+		WriteElementSeparator<Format>(Out, Index);
+		WriteValue<Format>(Out, *Element, Level + 1);
+	}
+}
 
-	Stream << '{';
-	if (!Object.empty())
+template<class Format>
+void JsonFormatter::WriteMemberName(JsonOutputBuffer& Out, JsonStringRef Name, size_t Index, uint32_t Level) const
+{
+	if (Index > 0)
+		Out.Put(',');
+	if (!Format::Compact)
 	{
-		Stream << '\n';
-		auto First = Object.cbegin();
-		auto Last = --Object.cend();
-		for (; First != Object.end(); ++First)
+		Out.Put('\n');
+		WriteIndent(Out, Level);
+	}
+	WriteString(Out, Name);
+	Format::Compact ? Out.Put(':') : Out.Put(": ", 2);
+}
+
+template<class Format>
+void JsonFormatter::WriteElementSeparator(JsonOutputBuffer& Out, size_t Index) const
+{
+	if (Index > 0)
+		Format::Compact ? Out.Put(',') : Out.Put(", ", 2);
+}
+
+template<class Format>
+void JsonFormatter::WriteObjectEnd(JsonOutputBuffer& Out, size_t Size, uint32_t Level) const
+{
+	if (!Format::Compact && Size > 0)
+	{
+		Out.Put('\n');
+		WriteIndent(Out, Level - 1);
+	}
+	Out.Put('}');
+}
+
+std::shared_ptr<const JsonFragment> JsonFormatter::CachedFragment(const JsonValue* Root, uint32_t Level) const
+{
+	const JsonFragmentTable::Scope Locked;
+	JsonOutputBuffer Scratch(nullptr, 4096);
+	return m_Compact ? CacheFragment<JsonCompactFormat>(Locked, Scratch, Root, Level) : CacheFragment<JsonPrettyFormat>(Locked, Scratch, Root, Level);
+}
+
+template<class Format>
+std::shared_ptr<const JsonFragment> JsonFormatter::CacheFragment(const JsonFragmentTable::Scope& Locked, JsonOutputBuffer& Scratch, const JsonValue* Root, uint32_t Level) const
+{
+	// Compact bytes are the same at every level, a subtree moved elsewhere keeps them
+	const uint32_t Indent = Format::Compact ? 0 : m_Indent;
+	const uint32_t Depth = Format::Compact ? 0 : Level;
+	const auto Node = JsonFragmentTable::Own(Locked, Root);
+	if (Node->Fragment && Node->Fragment->Matches(Indent, Depth, Format::Compact, m_EnsureAscii))
+		return Node->Fragment;
+
+	auto Fragment = std::make_shared<JsonFragment>();
+	const size_t Start = Scratch.Size();
+	size_t Spliced = 0, Index = 0;
+	if (IsObject(Root))
+	{
+		const auto& Object = Root->AsObject();
+		Scratch.Put('{');
+		for (auto Member = Object.cbegin(); Member != Object.cend(); ++Member, ++Index)
 		{
-			WriteIndent(Stream, Level);
-			// Write Identifier
-			WriteString(Stream, First->first);
-			Stream << ':' << ' ';
-			// Write Json value
-			Write(Stream, First->second.get(), Level + 1);
-			if (First != Last)
-				Stream << ',';
-			Stream << '\n';
+			WriteMemberName<Format>(Scratch, Member->first, Index, Level);
+			Spliced += CacheChild<Format>(Locked, Scratch, *Fragment, Start, Node, Member->second.get(), Level + 1);
 		}
-		WriteIndent(Stream, Level - 1);
+		WriteObjectEnd<Format>(Scratch, Object.size(), Level);
+	}
+	else
+	{
+		const auto& Array = Root->AsArray();
+		Scratch.Put('[');
+		for (auto Element = Array.cbegin(); Element != Array.cend(); ++Element, ++Index)
+		{
+			WriteElementSeparator<Format>(Scratch, Index);
+			Spliced += CacheChild<Format>(Locked, Scratch, *Fragment, Start, Node, Element->get(), Level + 1);
+		}
+		Scratch.Put(']');
+	}
+
+	Fragment->Bytes.assign(Scratch.Data() + Start, Scratch.Size() - Start);
+	Fragment->Size = Fragment->Bytes.size() + Spliced;
+	Fragment->Indent = Indent;
+	Fragment->Level = Depth;
+	Fragment->Compact = Format::Compact;
+	Fragment->EnsureAscii = m_EnsureAscii;
+	Scratch.Truncate(Start);
+
+	Node->Fragment = Fragment;
+	return Node->Fragment;
+}
+
+template<class Format>
+size_t JsonFormatter::CacheChild(const JsonFragmentTable::Scope& Locked, JsonOutputBuffer& Scratch, JsonFragment& Fragment, size_t Start, const std::shared_ptr<JsonFragmentCache>& Node, const JsonValue* Child, uint32_t Level) const
+{
+	JSON_ASSERT(Child != nullptr);
+	const bool Container = IsContainer(Child);
+	JsonFragmentTable::Attach(Locked, Child, Node, Container);
+	if (!Container)
+	{
+		WriteValue<Format>(Scratch, Child, Level);
+		return 0;
 	}
-	Stream << '}';
+
+	// Below the splice size the child cannot hold splices of its own, its bytes are copied
+	auto Cached = CacheFragment<Format>(Locked, Scratch, Child, Level);
+	if (Cached->Size < JsonFragment::MinSplicedSize)
+	{
+		Scratch.Put(Cached->Bytes.data(), Cached->Bytes.size());
+		return 0;
+	}
+	const size_t Size = Cached->Size;
+	Fragment.Splices.push_back({ Scratch.Size() - Start, std::move(Cached) });
+	return Size;
+}
+
+constexpr size_t JsonFormatter::MinParallelElements;
+
+uint32_t JsonFormatter::ThreadCount() const noexcept
+{
+	return m_Threads > 0 ? m_Threads : std::max(1U, std::thread::hardware_concurrency());
 }
 
-void JsonWriter::WriteArray(OStream& Stream, const JsonValue* Root, uint32_t Level) const
+template<class Node>
+bool JsonFormatter::WriteParallel(JsonOutputBuffer& Out, const Node& Root, uint32_t Level) const
 {
-	auto Array = Root->AsArray();
+	const uint32_t Threads = ThreadCount();
+	std::vector<size_t> Path;
+	if (Threads < 2 || !FindSplit(Root, Path))
+		return false;
 
-	Stream << '[';
-	if (!Array.empty())
+	m_Compact ? WriteSplit<JsonCompactFormat>(Out, Root, Level, Path, 0, Threads) : WriteSplit<JsonPrettyFormat>(Out, Root, Level, Path, 0, Threads);
+	return true;
+}
+
+template<class Format, class Node>
+void JsonFormatter::WriteSplit(JsonOutputBuffer& Out, const Node& Root, uint32_t Level, const std::vector<size_t>& Path, size_t Depth, uint32_t Threads) const
+{
+	const bool Object = IsObject(Root);
+	const size_t Size = ContainerSize(Root);
+
+	Out.Put(Object ? '{' : '[');
+	if (Depth == Path.size())
 	{
-		auto Length = Array.size();
-		auto Last = Length - 1;
-		for (uint32_t Index = 0; Index < Length; ++Index)
+		WriteRanges(Out, Size, Threads, [&](JsonOutputBuffer& Chunk, size_t First, size_t Last) {
+			Object ? WriteMembers<Format>(Chunk, Root, First, Last, Level) : WriteElements<Format>(Chunk, Root, First, Last, Level);
+		});
+	}
+	else
+	{
+		// Serial around the child on the path
+		const size_t Split = Path[Depth];
+		Object ? WriteMembers<Format>(Out, Root, 0, Split, Level) : WriteElements<Format>(Out, Root, 0, Split, Level);
+		Object ? WriteMemberName<Format>(Out, ChildName(Root, Split), Split, Level) : WriteElementSeparator<Format>(Out, Split);
+		WriteSplit<Format>(Out, ChildAt(Root, Split), Level + 1, Path, Depth + 1, Threads);
+		Object ? WriteMembers<Format>(Out, Root, Split + 1, Size, Level) : WriteElements<Format>(Out, Root, Split + 1, Size, Level);
+	}
+	Object ? WriteObjectEnd<Format>(Out, Size, Level) : Out.Put(']');
+}
+
+void JsonFormatter::WriteRanges(JsonOutputBuffer& Out, size_t Size, uint32_t Threads, const RangeFunction& Function) const
+{
+	// Ranges are small enough to bound the output held in memory and many enough to balance
+	// uneven elements. Workers run at most Window ranges ahead of the one being written out
+	const size_t Step = std::min<size_t>(std::max<size_t>(Size / (Threads * 8), 256), 16384);
+	const size_t Count = (Size + Step - 1) / Step;
+	const size_t Window = Threads * 2;
+
+	std::unique_ptr<JsonOutputBuffer[]> Chunks(new JsonOutputBuffer[Window]);
+	std::vector<uint8_t>	Ready(Window, 0);
+	std::mutex				Mutex;
+	std::condition_variable	Wake;
+	size_t					Next = 0;
+	size_t					Written = 0;
+	bool					Stopped = false;
+	std::exception_ptr		Error;
+
+	auto Worker = [&]() {
+		while (true)
+		{
+			size_t Index;
+			{
+				std::unique_lock<std::mutex> Lock(Mutex);
+				Wake.wait(Lock, [&]() { return Stopped || Next >= Count || Next < Written + Window; });
+				if (Stopped || Next >= Count)
+					return;
+				Index = Next++;
+			}
+
+			try
+			{
+				Function(Chunks[Index % Window], Index * Step, std::min(Size, (Index + 1) * Step));
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> Lock(Mutex);
+				if (!Error)
+					Error = std::current_exception();
+				Stopped = true;
+				Wake.notify_all();
+				return;
+			}
+
+			{
+				std::lock_guard<std::mutex> Lock(Mutex);
+				Ready[Index % Window] = 1;
+			}
+			Wake.notify_all();
+		}
+	};
+
+	{
+		std::vector<std::thread> Pool;
+		Pool.reserve(Threads);
+
+		// Workers are stopped and joined on every exit path, including a failing sink or a
+		// thread that cannot be started
+		struct PoolGuard
+		{
+			~PoolGuard()
+			{
+				{
+					std::lock_guard<std::mutex> Lock(Mutex);
+					Stopped = true;
+				}
+				Wake.notify_all();
+				for (auto& Thread : Pool)
+					Thread.join();
+			}
+
+			std::mutex&					Mutex;
+			std::condition_variable&	Wake;
+			bool&						Stopped;
+			std::vector<std::thread>&	Pool;
+		} Guard{ Mutex, Wake, Stopped, Pool };
+
+		for (uint32_t Thread = 0; Thread < Threads; ++Thread)
+			Pool.emplace_back(Worker);
+
+		// Chunks go out in element order, each already carries its leading separator
+		for (size_t Index = 0; Index < Count; ++Index)
 		{
-			Write(Stream, Array[Index].get(), Level + 1);
-			if (Index != Last)
-				Stream << ',' << ' ';
+			auto& Chunk = Chunks[Index % Window];
+			{
+				std::unique_lock<std::mutex> Lock(Mutex);
+				Wake.wait(Lock, [&]() { return Stopped || Ready[Index % Window]; });
+				if (Stopped)
+					break;
+			}
+
+			Out.Put(Chunk.Data(), Chunk.Size());
+			Chunk.Clear();
+
+			{
+				std::lock_guard<std::mutex> Lock(Mutex);
+				Ready[Index % Window] = 0;
+				++Written;
+			}
+			Wake.notify_all();
 		}
 	}
-	Stream << ']';
+
+	if (Error)
+		std::rethrow_exception(Error);
 }
 
 void JsonStreamWriter::Serialize(const JsonValue* Root) const
 {
-	JSON_ASSERT(m_Stream); 
-	JsonWriter::Write(*m_Stream, Root);
+	JSON_ASSERT(m_Stream);
+	JsonStreamSink Sink(*m_Stream);
+	JsonOutputBuffer Out(&Sink);
+	JsonWriter::Write(Out, Root);
+	Out.Flush();
+}
+
+void JsonStreamWriter::Serialize(const JsonNode& Root) const
+{
+	JSON_ASSERT(m_Stream);
+	JsonStreamSink Sink(*m_Stream);
+	JsonOutputBuffer Out(&Sink);
+	JsonWriter::Write(Out, Root);
+	Out.Flush();
 }
 
 void JsonStringWriter::Serialize(const JsonValue* Root) const
 {
 	JSON_ASSERT(m_OutString);
-	std::ostringstream OStream;
-	JsonWriter::Write(OStream, Root);
-	*m_OutString = OStream.str();
+	m_OutString->clear();
+	if (m_Presize)
+	{
+		StringStorageSink Sink(*m_OutString, MeasureCapacity(Root));
+		JsonOutputBuffer Out(&Sink);
+		JsonWriter::Write(Out, Root);
+		Out.Flush();
+		return;
+	}
+
+	JsonStringSink Sink(*m_OutString);
+	JsonOutputBuffer Out(&Sink);
+	JsonWriter::Write(Out, Root);
+	Out.Flush();
+}
+
+void JsonStringWriter::Serialize(const JsonNode& Root) const
+{
+	JSON_ASSERT(m_OutString);
+	m_OutString->clear();
+	if (m_Presize)
+	{
+		StringStorageSink Sink(*m_OutString, MeasureCapacity(Root));
+		JsonOutputBuffer Out(&Sink);
+		JsonWriter::Write(Out, Root);
+		Out.Flush();
+		return;
+	}
+
+	JsonStringSink Sink(*m_OutString);
+	JsonOutputBuffer Out(&Sink);
+	JsonWriter::Write(Out, Root);
+	Out.Flush();
+}
+
+void JsonFileWriter::Serialize(const JsonValue* Root) const
+{
+	const auto Sink = CreateSink();
+	JsonOutputBuffer Out(Sink.get(), m_BufferSize);
+	JsonWriter::Write(Out, Root);
+	Out.Flush();
+}
+
+void JsonFileWriter::Serialize(const JsonNode& Root) const
+{
+	const auto Sink = CreateSink();
+	JsonOutputBuffer Out(Sink.get(), m_BufferSize);
+	JsonWriter::Write(Out, Root);
+	Out.Flush();
+}
+
+std::unique_ptr<JsonOutputSink> JsonFileWriter::CreateSink() const
+{
+	if (m_Background)
+		return std::unique_ptr<JsonOutputSink>(new JsonAsyncFileSink(m_Descriptor, m_BufferSize));
+	return std::unique_ptr<JsonOutputSink>(new JsonFileSink(m_Descriptor));
 }
 
 bool Serializer::operator()(const JsonValue& Root, JsonWriter& Writer) const
@@ -147,9 +871,28 @@ bool Serializer::operator()(const std::shared_ptr<JsonValue>& Root, JsonWriter&
 	return this->operator()(*Root, Writer);
 }
 
+bool Serializer::operator()(const JsonDocument& Document, JsonWriter& Writer) const
+{
+	const auto& Root = Document.GetRoot();
+	switch (Root.GetType())
+	{
+	case JsonType::Array: JSON_FALLTHROUGH;
+	case JsonType::Object: Writer.Serialize(Root); break;
+	default: return false;
+	}
+	return true;
+}
+
 std::ostream& JSONCpp::operator<<(std::ostream& Out, const JsonValue& Root)
 {
 	auto Writer = JsonWriterFactory::Create(&Out);
 	JSON_ASSERT_MESSAGE(Serializer()(Root, *Writer), "Invalid serialize JSON.");
 	return Out;
+}
+
+std::ostream& JSONCpp::operator<<(std::ostream& Out, const JsonDocument& Document)
+{
+	auto Writer = JsonWriterFactory::Create(&Out);
+	JSON_ASSERT_MESSAGE(Serializer()(Document, *Writer), "Invalid serialize JSON.");
+	return Out;
 }
\ No newline at end of file